@@ -9,6 +9,22 @@
 // Hardware Pin Configuration
 #define LED_PIN 14
 #define BRIGHTNESS_LIMIT 60  // Safety limit to prevent overheating
+#define POWER_BUDGET_MA 400  // LED current budget per frame (lib/MatrixUtil/MatrixPower.h, USB-powered board)
+
+// LED output backend:
+//   MU_BACKEND_LIB - the sketch's LED library (FastLED / Adafruit_NeoPixel) bit-bangs show()
+//   MU_BACKEND_RMT - RMT peripheral transmits in the background (lib/MatrixUtil/MatrixOutput.h,
+//                    needs arduino-esp32 3.x)
+#define LED_BACKEND MU_BACKEND_LIB
+
+// QMI8658 IMU (lib/MatrixUtil/MatrixQMI.h). Set IMU_INT_PIN to the GPIO wired to the sensor's
+// INT1/INT2 (IMU_INT_LINE) to wake the sensor task on the FIFO watermark (or on motion in the
+// MU_IMU_WAKE profile); -1 = timed polling. IMU_DEBUG 1 prints the register dump and every batch.
+#define IMU_SDA_PIN  11
+#define IMU_SCL_PIN  12
+#define IMU_INT_PIN  -1
+#define IMU_INT_LINE 2
+#define IMU_DEBUG    0
 
 // Panel geometry
 #define MATRIX_WIDTH 8
@@ -32,58 +48,29 @@
 // Rotation in degrees (0, 90, 180, 270)
 #define PANEL_ROTATION 0
 
+// Chained panels (lib/MatrixUtil/MatrixCanvas.h): set MATRIX_WIDTH/HEIGHT to the whole wall and
+// list each panel as MU_TILE(x, y, w, h, rotation, flipX, flipY, serpentine, chain); the PANEL_*
+// settings above are then ignored. Chains are separate data pins, driven in parallel. A 32x8 strip
+// of four 8x8 panels on two pins:
+//   #define MATRIX_TILES { MU_TILE(0, 0, 8, 8, 0, 0, 0, 0, 0), MU_TILE(8, 0, 8, 8, 0, 0, 0, 0, 0), MU_TILE(16, 0, 8, 8, 0, 0, 0, 0, 1), MU_TILE(24, 0, 8, 8, 0, 0, 0, 0, 1) }
+//   #define MATRIX_CHAIN_PINS { 14, 15 }
+
 // Debug/Calibration mode
 #define PANEL_CALIBRATION 0
 
 // Frame rate for serial visualization (5-20 FPS recommended)
 #define FRAME_RATE_MS 100  // 10 FPS
 
-// XY coordinate mapping function for serpentine wiring
-// This maps logical (x,y) coordinates to physical LED index
-inline uint16_t XY(uint8_t x, uint8_t y) {
-  // Bounds checking
-  if (x >= MATRIX_WIDTH) x = MATRIX_WIDTH - 1;
-  if (y >= MATRIX_HEIGHT) y = MATRIX_HEIGHT - 1;
-  
-  uint16_t index;
-  
-  #if PANEL_FLIP_Y
-    y = (MATRIX_HEIGHT - 1) - y;
-  #endif
-  
-  #if PANEL_FLIP_X
-    x = (MATRIX_WIDTH - 1) - x;
-  #endif
-  
-  #if PANEL_WIRING_SERPENTINE
-    // Serpentine wiring: odd rows are reversed
-    if (y & 0x01) {
-      // Odd row: right to left
-      index = (y * MATRIX_WIDTH) + (MATRIX_WIDTH - 1 - x);
-    } else {
-      // Even row: left to right
-      index = (y * MATRIX_WIDTH) + x;
-    }
-  #else
-    // Progressive wiring: simple row-major
-    index = (y * MATRIX_WIDTH) + x;
-  #endif
-  
-  return index;
-}
+// Section profiler (lib/MatrixUtil/MatrixProfile.h): 1 = time MU_PROFILE_SCOPE blocks with the CPU
+// cycle counter and print a PROFILE: line every second; 0 compiles the scopes out
+#define PROFILE_SECTIONS 0
 
-// Helper function to send frame data for visualization
-inline void sendFrameData(CRGB* leds) {
-  Serial.print("FRAME:");
-  for (int y = 0; y < MATRIX_HEIGHT; y++) {
-    for (int x = 0; x < MATRIX_WIDTH; x++) {
-      CRGB color = leds[XY(x, y)];
-      char buf[8];
-      sprintf(buf, "%02X%02X%02X,", color.r, color.g, color.b);
-      Serial.print(buf);
-    }
-  }
-}
+// Idle light sleep (lib/MatrixUtil/MatrixIdle.h): 1 = sketches left idle light-sleep with the last
+// frame latched on the LEDs. 0 on this USB-powered board: the USB serial link drops while asleep.
+#define IDLE_SLEEP 0
+
+// XY mapping (XY()/MU_XY()) and frame dumps live in lib/MatrixUtil/MatrixUtil.h,
+// built as a compile-time lookup table from the PANEL_* settings above.
 
 // Standard color definitions for consistency
 namespace MatrixColors {
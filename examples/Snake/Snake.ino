@@ -1,86 +1,136 @@
-#include "WS_QMI8658.h"
 #include "WS_Matrix.h"
+#include "config/BoardConfig.h"
+#define MU_FRAME_FORMAT MU_FMT_DELTA  // frame stream for tools/led_matrix_viz.py: changed pixels only
+#include "lib/MatrixUtil/MatrixUtil.h"
+#include "lib/MatrixUtil/MatrixTelemetry.h"
+#include "lib/MatrixUtil/MatrixRender.h"
+#include "lib/MatrixUtil/MatrixSched.h"
+#include "lib/MatrixUtil/MatrixTilt.h"
+#include "lib/MatrixUtil/MatrixQMI.h"
+#include "lib/MatrixUtil/MatrixFx.h"
+#include "lib/MatrixUtil/MatrixBoot.h"
 
 // English: Please note that the brightness of the lamp bead should not be too high, which can easily cause the temperature of the board to rise rapidly, thus damaging the board !!!
 // Chinese: 请注意，灯珠亮度不要太高，容易导致板子温度急速上升，从而损坏板子!!! 
 
-extern IMUdata Accel;
+#define TICK_MS     10            // fixed game step: IMU read + input
+#define RENDER_MS   20            // display refresh (the render task does the LED output)
+#define GAMEOVER_MS 2000          // pause before a new game starts (the flash plays during it)
+#define STREAM_FRAMES 1           // send each presented frame to the serial visualizer
+#define RECORD_SESSION 0          // 1: record frames + tilt input to LittleFS (MatrixRecord.h)
+#define IMU_BOOT_MS 500           // first move waits this long for the IMU, then the game runs without tilt
+#if RECORD_SESSION
+#include "lib/MatrixUtil/MatrixRecord.h"   // 8 KB of write pages, only when recording
+#endif
+unsigned long gameTime = 0;       // advanced by TICK_MS per step, so game timing ignores stalls
 unsigned long lastMoveTime = 0;
 unsigned long moveInterval = 300; // Snake speed in milliseconds
+extern bool gameOver;             // set by MoveSnake on collision, cleared by Snake_Init
+unsigned long restartTime = 0;
+int8_t imuStage = -1;             // MatrixBoot stage bringing up the QMI8658
+
+void GameTick();
+void Render();
+void PresentFrame();
+
+// ~10 deg engages a direction, below 6 deg releases it; 20 ms hold filters bumps
+MU_TiltConfig tiltConfig()
+{
+  MU_TiltConfig c;
+  c.onCd = 1000;
+  c.offCd = 600;
+  c.holdUs = 20000;
+  return c;
+}
+
+bool startImu()
+{
+  return MU_ImuBegin(MU_IMU_GAME);  // tilt fusion wants the gyro at full rate
+}
 
 void setup()
 {
   Serial.begin(115200);
-  QMI8658_Init();
+  MU_TelemetryBegin();  // score/status prints are queued so they never stall the move tick
+#if STREAM_FRAMES
+  MU_PrintMeta();
+#endif
+  // The board goes up first; the IMU comes up on its own task meanwhile
   Matrix_Init();
   Snake_Init();
-  Serial.println("Snake Game Started!");
-  Serial.println("Tilt the board to control the snake");
+  Render();
+  PresentFrame();
+  MU_BootFrame();
+  MU_TiltBegin(tiltConfig());  // before MU_ImuBegin starts the sensor task
+  imuStage = MU_BootStart("imu", startImu, IMU_BOOT_MS);
+  MU_BootDefer(MU_ImuDump, imuStage);  // register dump (IMU_DEBUG) after BOOT: and the IMU stage
+#if RECORD_SESSION
+  if (!MU_RecordBegin()) MU_Log("LittleFS unavailable, not recording\n");
+#endif
+  MU_Log("Snake Game Started!\n");
+  MU_Log("Tilt the board to control the snake\n");
+  MU_SchedBegin(TICK_MS * 1000UL, GameTick, RENDER_MS * 1000UL, Render, PresentFrame);
 }
 
 // Direction tracking
 uint8_t currentDirection = 1; // 0=up, 1=right, 2=down, 3=left
-uint8_t Time_X_A = 0, Time_X_B = 0, Time_Y_A = 0, Time_Y_B = 0;
 
 void loop()
 {
-  unsigned long currentTime = millis();
+  MU_SchedRun();  // sleeps until the next tick or frame is due
+}
+
+void Render()
+{
+  if (MU_FxRender()) return;       // game-over flash plays on its own clock
+  if (!gameOver) UpdateDisplay();  // keep the game-over screen up during the pause
+}
+
+// Present step: the dirty cells UpdateDisplay() marked drive both the LEDs and the delta stream
+void PresentFrame()
+{
+  MU_Present();
+#if STREAM_FRAMES
+  MU_SendFrameDelta(MU_BackBuffer(), MU_PresentedDirty());
+#endif
+#if RECORD_SESSION
+  MU_RecordFrame(MU_BackBuffer(), MU_PresentedDirty());
+#endif
+}
+
+void GameTick()
+{
+  MU_BootPoll();
+  if (!MU_BootSettled(imuStage)) return;  // no moves before the IMU is up or given up on
+  gameTime += TICK_MS;
+  unsigned long currentTime = gameTime;
+
+  if (gameOver) {
+    if (currentTime < restartTime || MU_FxActive()) return;
+    // Reset game
+    Snake_Init();
+    currentDirection = 1;
+    MU_TiltEvent stale;
+    while (MU_TiltPoll(stale)) {}  // drop tilts made during the pause
+    lastMoveTime = currentTime;
+    MU_Log("New Game Started!\n");
+    return;
+  }
   
-  // Read IMU continuously
-  QMI8658_Loop();
+  // Read IMU every tick
+  MU_ImuLoop();
+#if RECORD_SESSION
+  MU_RecordImu(MU_ImuAccel.x, MU_ImuAccel.y, MU_ImuAccel.z);
+#endif
   
-  // Use the original game's IMU processing logic
-  if(Accel.x > 0.15 || Accel.x < 0 || Accel.y > 0.15 || Accel.y < 0){
-    // Process X-axis (controls up/down movement)
-    if(Accel.x > 0.15){
-      Time_X_A = Time_X_A + Accel.x * 10;
-      Time_X_B = 0;
-    }
-    else if(Accel.x < 0){
-      Time_X_B = Time_X_B + abs(Accel.x) * 10;
-      Time_X_A = 0;
-    }
-    else{
-      Time_X_A = 0;
-      Time_X_B = 0;
-    }
-    
-    // Process Y-axis (controls left/right movement)
-    if(Accel.y > 0.15){
-      Time_Y_A = Time_Y_A + Accel.y * 10;
-      Time_Y_B = 0;
-    }
-    else if(Accel.y < 0){
-      Time_Y_B = Time_Y_B + abs(Accel.y) * 10;
-      Time_Y_A = 0;
-    }
-    else{
-      Time_Y_A = 0;
-      Time_Y_B = 0;
-    }
-    
-    // Determine direction based on accumulated time
-    uint8_t newDirection = currentDirection;
-    
-    if(Time_X_A >= 10){
-      newDirection = 2; // Tilt forward (positive X) = move down
-      Time_X_A = 0;
-      Time_X_B = 0;
-    }
-    if(Time_X_B >= 10){
-      newDirection = 0; // Tilt backward (negative X) = move up
-      Time_X_A = 0;
-      Time_X_B = 0;
-    }
-    if(Time_Y_A >= 10){
-      newDirection = 3; // Tilt left (positive Y) = move left
-      Time_Y_A = 0;
-      Time_Y_B = 0;
-    }
-    if(Time_Y_B >= 10){
-      newDirection = 1; // Tilt right (negative Y) = move right
-      Time_Y_A = 0;
-      Time_Y_B = 0;
+  // Direction events from the tilt filter (fused at the full IMU rate in the sensor task)
+  MU_TiltEvent ev;
+  while (MU_TiltPoll(ev)) {
+    uint8_t newDirection;
+    if (ev.axis == MU_TILT_X) {
+      newDirection = ev.dir > 0 ? 2 : 0; // Tilt forward (positive X) = move down, backward = up
+    } else {
+      newDirection = ev.dir > 0 ? 3 : 1; // Tilt left (positive Y) = move left, right = right
     }
     
     // Prevent 180-degree turns (can't go back into yourself)
@@ -100,34 +150,23 @@ void loop()
   
   // Move snake at regular intervals
   if (currentTime - lastMoveTime >= moveInterval) {
+#if AUTO_PLAY
+    currentDirection = AutoPlayDirection();  // soak test / demo: ignore the tilt
+#endif
     uint8_t gameStatus = MoveSnake(currentDirection);
     
     if (gameStatus == 0) {
       // Game over
-      Serial.print("Game Over! Score: ");
-      Serial.println(GetSnakeLength() - 3);
-      delay(2000);
-      
-      // Reset game
-      Snake_Init();
-      currentDirection = 1;
-      Time_X_A = 0;
-      Time_X_B = 0;
-      Time_Y_A = 0;
-      Time_Y_B = 0;
-      Serial.println("New Game Started!");
+      MU_Logf("Game Over! Score: %d\n", GetSnakeLength() - 3);
+      restartTime = currentTime + GAMEOVER_MS;
     } else if (gameStatus == 2) {
       // Food eaten, increase speed slightly
-      Serial.print("Score: ");
-      Serial.println(GetSnakeLength() - 3);
+      MU_Logf("Score: %d\n", GetSnakeLength() - 3);
       
       // Speed up as snake grows (minimum 100ms)
       moveInterval = max(100, 300 - (GetSnakeLength() - 3) * 10);
     }
     
-    UpdateDisplay();
     lastMoveTime = currentTime;
   }
-  
-  delay(10);
 }
\ No newline at end of file
@@ -0,0 +1,161 @@
+#ifndef _SNAKE_AI_H_
+#define _SNAKE_AI_H_
+// Auto-player for the SnakeCore rules, hardware-free like the core (host bench + AUTO_PLAY demo).
+// Works with either core variant: it only uses head()/tail()/food()/length()/isOccupied().
+//  - SNAKE_AI_BFS: shortest path to the food around the body; with no path it takes the free
+//    neighbour with the most reachable cells. Fast apples, dies once the board gets crowded.
+//  - SNAKE_AI_HAMILTON: follows a fixed Hamiltonian cycle of the board (never dies, clears the
+//    board) and takes shortcuts along it towards the food while the snake is short. Needs an even
+//    row or column count; other boards fall back to BFS.
+// Search buffers are sized by the board, so the player is ~6 bytes per cell.
+
+#include <stdint.h>
+#include "SnakeCore.h"
+
+#define SNAKE_AI_BFS      0
+#define SNAKE_AI_HAMILTON 1
+
+template <int R, int C>
+class SnakeAutoPlayer {
+ public:
+  static constexpr int kCells = R * C;
+
+  explicit SnakeAutoPlayer(uint8_t mode = SNAKE_AI_HAMILTON) : mode_(mode) { hasCycle_ = buildCycle(); }
+
+  uint8_t mode() const { return hasCycle_ ? mode_ : SNAKE_AI_BFS; }
+
+  template <class Core>
+  uint8_t nextMove(const Core& g) {
+    if (mode() == SNAKE_AI_HAMILTON) return cycleMove(g);
+    return bfsMove(g);
+  }
+
+  // Direction of the next cycle cell after p (the pure cycle-follower)
+  uint8_t cycleDirection(Point p) const { return cycleDir_[cell(p)]; }
+
+ private:
+  static uint16_t cell(Point p) { return (uint16_t)p.x * C + p.y; }
+  static Point point(uint16_t c) { return { (int8_t)(c / C), (int8_t)(c % C) }; }
+
+  // Serpentine over all columns but the first, back up the first column (or the transpose)
+  bool buildCycle() {
+    if (R < 2 || C < 2 || (R % 2 && C % 2)) return false;
+    uint16_t n = 0;
+    uint16_t seq[kCells];
+    if (R % 2 == 0) {
+      for (int x = 0; x < R; x++)
+        for (int i = 1; i < C; i++) seq[n++] = cell({ (int8_t)x, (int8_t)(x % 2 ? C - i : i) });
+      for (int x = R - 1; x >= 0; x--) seq[n++] = cell({ (int8_t)x, 0 });
+    } else {
+      for (int y = 0; y < C; y++)
+        for (int i = 1; i < R; i++) seq[n++] = cell({ (int8_t)(y % 2 ? R - i : i), (int8_t)y });
+      for (int y = C - 1; y >= 0; y--) seq[n++] = cell({ 0, (int8_t)y });
+    }
+    for (uint16_t i = 0; i < kCells; i++) {
+      order_[seq[i]] = i;
+      Point a = point(seq[i]), b = point(seq[(i + 1) % kCells]);
+      for (uint8_t d = 0; d < 4; d++) {
+        Point s = SnakeStepPoint<R, C>(a, d);
+        if (s.x == b.x && s.y == b.y) cycleDir_[seq[i]] = d;
+      }
+    }
+    return true;
+  }
+
+  // Body cells always cover the cycle stretch (tail, head], so every cell strictly between the head
+  // and the tail going forward is free: a shortcut may jump ahead as long as it lands before the
+  // tail (with slack for growth) and not past the food.
+  template <class Core>
+  uint8_t cycleMove(const Core& g) {
+    Point head = g.head();
+    uint16_t h = order_[cell(head)];
+    uint8_t best = cycleDir_[cell(head)];
+    if (g.length() > kCells / 2 || g.food().x < 0) return best;
+    auto ahead = [&](Point p) { return (uint16_t)((order_[cell(p)] + kCells - h) % kCells); };
+    uint16_t toTail = ahead(g.tail());
+    uint16_t toFood = ahead(g.food());
+    uint16_t bestDist = 1;
+    for (uint8_t d = 0; d < 4; d++) {
+      Point n = SnakeStepPoint<R, C>(head, d);
+      if (g.isOccupied(n)) continue;
+      uint16_t dn = ahead(n);
+      if (dn > bestDist && dn <= toFood && dn + 4 < toTail) {
+        best = d;
+        bestDist = dn;
+      }
+    }
+    return best;
+  }
+
+  template <class Core>
+  uint8_t bfsMove(const Core& g) {
+    Point head = g.head();
+    uint16_t start = cell(head);
+    Point food = g.food();
+    if (food.x >= 0) {
+      // prev_ holds the first move out of the head for every reached cell
+      for (uint16_t i = 0; i < kCells; i++) prev_[i] = 0xFF;
+      uint16_t qHead = 0, qTail = 0;
+      for (uint8_t d = 0; d < 4; d++) {
+        Point n = SnakeStepPoint<R, C>(head, d);
+        uint16_t c = cell(n);
+        if (g.isOccupied(n) || prev_[c] != 0xFF) continue;
+        prev_[c] = d;
+        queue_[qTail++] = c;
+      }
+      uint16_t target = cell(food);
+      while (qHead < qTail) {
+        uint16_t c = queue_[qHead++];
+        if (c == target) return prev_[c];
+        for (uint8_t d = 0; d < 4; d++) {
+          Point n = SnakeStepPoint<R, C>(point(c), d);
+          uint16_t nc = cell(n);
+          if (nc == start || prev_[nc] != 0xFF || g.isOccupied(n)) continue;
+          prev_[nc] = prev_[c];
+          queue_[qTail++] = nc;
+        }
+      }
+    }
+    // No path: stay alive in the largest open region
+    uint8_t best = 1;
+    uint16_t bestArea = 0;
+    for (uint8_t d = 0; d < 4; d++) {
+      Point n = SnakeStepPoint<R, C>(head, d);
+      if (g.isOccupied(n)) continue;
+      uint16_t area = reachable(g, n, start);
+      if (area > bestArea) {
+        best = d;
+        bestArea = area;
+      }
+    }
+    return best;
+  }
+
+  template <class Core>
+  uint16_t reachable(const Core& g, Point from, uint16_t head) {
+    for (uint16_t i = 0; i < kCells; i++) prev_[i] = 0xFF;
+    uint16_t qHead = 0, qTail = 0;
+    prev_[cell(from)] = 0;
+    queue_[qTail++] = cell(from);
+    while (qHead < qTail) {
+      uint16_t c = queue_[qHead++];
+      for (uint8_t d = 0; d < 4; d++) {
+        Point n = SnakeStepPoint<R, C>(point(c), d);
+        uint16_t nc = cell(n);
+        if (nc == head || prev_[nc] != 0xFF || g.isOccupied(n)) continue;
+        prev_[nc] = 0;
+        queue_[qTail++] = nc;
+      }
+    }
+    return qTail;
+  }
+
+  uint8_t mode_;
+  bool hasCycle_ = false;
+  uint16_t order_[kCells];     // position of each cell along the cycle
+  uint8_t cycleDir_[kCells];   // move to the next cycle cell
+  uint8_t prev_[kCells];       // BFS: first move per cell, 0xFF = unseen
+  uint16_t queue_[kCells];
+};
+
+#endif
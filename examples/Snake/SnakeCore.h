@@ -0,0 +1,253 @@
+#ifndef _SNAKE_CORE_H_
+#define _SNAKE_CORE_H_
+// Hardware-free Snake rules: no LEDs, no delay(), no Arduino headers, so the same code runs in
+// WS_Matrix.cpp on the board and in host tools (tools/bench/snake_bench.cpp).
+// Rules (unchanged from the original game): the board wraps at the edges, reversing into the neck
+// is ignored, running into any body cell (the tail included) ends the game, food grows the snake
+// by one. All randomness comes from a seeded xorshift32, so a seed plus a move list replays exactly.
+//  - SnakeCore<R, C>: ring-buffer body + occupancy bitmap (O(1) move and collision, bounded food).
+//  - SnakeCoreArray<R, C>: the original shifting-array version, kept for the benchmark.
+// Coordinates follow WS_Matrix: x is the row (0 = top), y the column; directions 0=up 1=right
+// 2=down 3=left.
+
+#include <stdint.h>
+#include <string.h>
+
+struct Point {
+  int8_t x;
+  int8_t y;
+};
+
+#define SNAKE_DEAD  0
+#define SNAKE_MOVED 1
+#define SNAKE_ATE   2
+
+struct SnakeRng {
+  uint32_t state = 1;
+  void seed(uint32_t s) { state = s ? s : 1; }
+  uint32_t next() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+  uint32_t below(uint32_t n) { return n ? next() % n : 0; }
+};
+
+// Head position after one step in `direction`, wrapping at the edges
+template <int R, int C>
+static inline Point SnakeStepPoint(Point p, uint8_t direction) {
+  switch (direction) {
+    case 0: p.x--; break;  // Up (decrease row)
+    case 1: p.y++; break;  // Right (increase column)
+    case 2: p.x++; break;  // Down (increase row)
+    case 3: p.y--; break;  // Left (decrease column)
+  }
+  if (p.x < 0) p.x = R - 1;
+  if (p.x >= R) p.x = 0;
+  if (p.y < 0) p.y = C - 1;
+  if (p.y >= C) p.y = 0;
+  return p;
+}
+
+template <int R, int C>
+class SnakeCore {
+ public:
+  static constexpr int kCells = R * C;
+  static constexpr int kWords = (kCells + 63) / 64;
+  static constexpr int kMaxChanged = 8;
+
+  void reset(uint32_t seed) {
+    rng_.seed(seed);
+    memset(occupied_, 0, sizeof(occupied_));
+    // Middle of the board, moving right
+    length_ = 3;
+    head_ = 2;
+    segment(0) = { (int8_t)(R / 2), (int8_t)(C / 2) };      // Head
+    segment(1) = { (int8_t)(R / 2 - 1), (int8_t)(C / 2) };  // Body
+    segment(2) = { (int8_t)(R / 2 - 2), (int8_t)(C / 2) };  // Tail
+    for (uint16_t i = 0; i < length_; i++) setOccupied(segment(i));
+    placeFood();
+    gameOver_ = false;
+    changedCount_ = 0;
+    fullRedraw_ = true;
+  }
+
+  // SNAKE_DEAD, SNAKE_MOVED or SNAKE_ATE
+  uint8_t step(uint8_t direction) {
+    if (gameOver_) return SNAKE_DEAD;
+    Point newHead = SnakeStepPoint<R, C>(segment(0), direction);
+
+    // Trying to go backwards into the neck: ignore the move
+    if (length_ > 1 && same(segment(1), newHead)) return SNAKE_MOVED;
+
+    // Self collision (the tail still counts: it has not moved yet)
+    if (isOccupied(newHead)) {
+      gameOver_ = true;
+      return SNAKE_DEAD;
+    }
+
+    bool foodEaten = same(newHead, food_);
+    bool grow = foodEaten && length_ < kCells;
+
+    // Old head turns into body, the new head appears, the tail cell empties unless growing
+    markChanged(segment(0));
+    markChanged(newHead);
+    if (!grow) {
+      clearOccupied(segment(length_ - 1));
+      markChanged(segment(length_ - 1));
+    } else {
+      length_++;
+    }
+    head_ = (uint16_t)((head_ + 1) % kCells);
+    segment(0) = newHead;
+    setOccupied(newHead);
+    if (grow) {
+      placeFood();
+      if (food_.x >= 0) markChanged(food_);
+    }
+    return foodEaten ? SNAKE_ATE : SNAKE_MOVED;
+  }
+
+  // Segment i counted from the head (0 = head)
+  Point& segment(uint16_t i) { return body_[(head_ + kCells - i) % kCells]; }
+  Point segment(uint16_t i) const { return body_[(head_ + kCells - i) % kCells]; }
+  Point head() const { return segment(0); }
+  Point tail() const { return segment(length_ - 1); }
+  Point food() const { return food_; }  // x < 0: board full, no food
+  uint16_t length() const { return length_; }
+  bool gameOver() const { return gameOver_; }
+
+  bool isOccupied(Point p) const {
+    uint16_t c = cell(p);
+    return (occupied_[c >> 6] >> (c & 63)) & 1;
+  }
+
+  // Cells changed since the last takeChanged(); false = too many, redraw everything
+  bool takeChanged(const Point** cells, uint8_t* count) {
+    bool full = fullRedraw_;
+    *cells = changed_;
+    *count = changedCount_;
+    changedCount_ = 0;
+    fullRedraw_ = false;
+    return !full;
+  }
+
+ private:
+  static uint16_t cell(Point p) { return (uint16_t)p.x * C + p.y; }
+  static bool same(Point a, Point b) { return a.x == b.x && a.y == b.y; }
+  void setOccupied(Point p) { uint16_t c = cell(p); occupied_[c >> 6] |= 1ULL << (c & 63); }
+  void clearOccupied(Point p) { uint16_t c = cell(p); occupied_[c >> 6] &= ~(1ULL << (c & 63)); }
+
+  void markChanged(Point p) {
+    if (changedCount_ < kMaxChanged) changed_[changedCount_++] = p;
+    else fullRedraw_ = true;
+  }
+
+  // The k-th free cell for a uniform random k: popcount per word, then drop k low bits
+  void placeFood() {
+    uint16_t freeCells = 0;
+    for (int w = 0; w < kWords; w++) freeCells += __builtin_popcountll(~occupied_[w]);
+    freeCells -= kWords * 64 - kCells;  // padding bits past the last cell read as free
+    if (freeCells == 0) {
+      food_ = { -1, -1 };
+      return;
+    }
+    uint16_t k = (uint16_t)rng_.below(freeCells);
+    for (int w = 0; w < kWords; w++) {
+      uint64_t freeBits = ~occupied_[w];
+      if (w == kWords - 1 && kCells % 64) freeBits &= (1ULL << (kCells % 64)) - 1;
+      uint8_t n = (uint8_t)__builtin_popcountll(freeBits);
+      if (k >= n) {
+        k -= n;
+        continue;
+      }
+      while (k--) freeBits &= freeBits - 1;
+      uint16_t c = (uint16_t)(w * 64 + __builtin_ctzll(freeBits));
+      food_ = { (int8_t)(c / C), (int8_t)(c % C) };
+      return;
+    }
+  }
+
+  Point body_[kCells];
+  uint64_t occupied_[kWords];
+  uint16_t head_ = 0;
+  uint16_t length_ = 0;
+  Point food_ = { -1, -1 };
+  bool gameOver_ = true;
+  SnakeRng rng_;
+  Point changed_[kMaxChanged];
+  uint8_t changedCount_ = 0;
+  bool fullRedraw_ = true;
+};
+
+// The original implementation: body shifted one slot per move, linear self-collision scan, food
+// retried at random until it misses the body
+template <int R, int C>
+class SnakeCoreArray {
+ public:
+  static constexpr int kCells = R * C;
+
+  void reset(uint32_t seed) {
+    rng_.seed(seed);
+    length_ = 3;
+    body_[0] = { (int8_t)(R / 2), (int8_t)(C / 2) };
+    body_[1] = { (int8_t)(R / 2 - 1), (int8_t)(C / 2) };
+    body_[2] = { (int8_t)(R / 2 - 2), (int8_t)(C / 2) };
+    placeFood();
+    gameOver_ = false;
+  }
+
+  uint8_t step(uint8_t direction) {
+    if (gameOver_) return SNAKE_DEAD;
+    Point newHead = SnakeStepPoint<R, C>(body_[0], direction);
+    if (length_ > 1 && body_[1].x == newHead.x && body_[1].y == newHead.y) return SNAKE_MOVED;
+    for (uint16_t i = 2; i < length_; i++) {
+      if (body_[i].x == newHead.x && body_[i].y == newHead.y) {
+        gameOver_ = true;
+        return SNAKE_DEAD;
+      }
+    }
+    bool foodEaten = newHead.x == food_.x && newHead.y == food_.y;
+    bool grow = foodEaten && length_ < kCells;
+    for (int i = grow ? length_ : length_ - 1; i > 0; i--) body_[i] = body_[i - 1];
+    body_[0] = newHead;
+    if (grow) {
+      length_++;
+      placeFood();
+    }
+    return foodEaten ? SNAKE_ATE : SNAKE_MOVED;
+  }
+
+  Point head() const { return body_[0]; }
+  Point tail() const { return body_[length_ - 1]; }
+  Point food() const { return food_; }
+  uint16_t length() const { return length_; }
+  bool gameOver() const { return gameOver_; }
+
+  bool isOccupied(Point p) const {
+    for (uint16_t i = 0; i < length_; i++) {
+      if (body_[i].x == p.x && body_[i].y == p.y) return true;
+    }
+    return false;
+  }
+
+ private:
+  void placeFood() {
+    if (length_ >= kCells) {
+      food_ = { -1, -1 };  // the original loop would spin forever here
+      return;
+    }
+    do {
+      food_ = { (int8_t)rng_.below(R), (int8_t)rng_.below(C) };
+    } while (isOccupied(food_));
+  }
+
+  Point body_[kCells];
+  uint16_t length_ = 0;
+  Point food_ = { -1, -1 };
+  bool gameOver_ = true;
+  SnakeRng rng_;
+};
+
+#endif
@@ -1,5 +1,14 @@
 #include "WS_Matrix.h"
 #include <Arduino.h>
+#include "config/BoardConfig.h"
+#include "lib/MatrixUtil/MatrixUtil.h"
+#include "lib/MatrixUtil/MatrixRender.h"
+#include "lib/MatrixUtil/MatrixFx.h"
+#include "lib/MatrixUtil/MatrixPower.h"
+#include "lib/MatrixUtil/MatrixIMU.h"
+#include "lib/MatrixUtil/MatrixTelemetry.h"
+#include "SnakeCore.h"
+#include "SnakeAI.h"
 
 // English: Please note that the brightness of the lamp bead should not be too high, which can easily cause the temperature of the board to rise rapidly, thus damaging the board !!!
 // Chinese: 请注意，灯珠亮度不要太高，容易导致板子温度急速上升，从而损坏板子!!! 
@@ -7,17 +16,14 @@
 // LED strip object
 Adafruit_NeoPixel pixels(RGB_COUNT, RGB_Control_PIN, NEO_RGB + NEO_KHZ800);
 
-// Snake game data structures
-struct Point {
-  int8_t x;
-  int8_t y;
-};
-
-Point snake[MAX_SNAKE_LENGTH];  // Snake body positions
-uint8_t snakeLength = 3;        // Current snake length
-Point food;                      // Food position
+// Game rules, body and food live in the hardware-free core (SnakeCore.h); this file only draws it
+SnakeCore<Matrix_Row, Matrix_Col> game;
 bool gameOver = false;
 
+#if AUTO_PLAY
+SnakeAutoPlayer<Matrix_Row, Matrix_Col> autoPlayer(SNAKE_AI_HAMILTON);
+#endif
+
 // Color definitions (keep brightness low to prevent overheating)
 uint8_t headColor[3] = {0, 50, 0};   // Bright green for head
 uint8_t bodyColor[3] = {0, 25, 0};   // Dimmer green for body  
@@ -25,7 +31,6 @@ uint8_t foodColor[3] = {40, 0, 0};   // Red for food
 
 // Forward declaration
 void GameOverAnimation();
-void GenerateFood();
 
 // Initialize the LED matrix
 void Matrix_Init() {
@@ -35,153 +40,75 @@ void Matrix_Init() {
   pixels.setBrightness(50);  // Keep brightness low
   pixels.clear();
   pixels.show();
+  // Frames are drawn into MU_BackBuffer() and pushed by the output task on the other core
+  // POWER_BUDGET_MA current limit (MatrixPower.h), ahead of MU_RenderBegin
+  MU_PowerConfig power;
+  power.brightness = pixels.getBrightness();
+  power.temperatureC = MU_ImuTemperatureC;
+  MU_PowerBegin(power);
+  MU_RenderBegin(MU_ShowNeoPixel<Adafruit_NeoPixel, pixels>);
 }
 
-// Initialize snake game
+// Initialize snake game: middle of the board, moving right, fresh food
 void Snake_Init() {
-  // Place snake in middle of board, moving right
-  snakeLength = 3;
-  snake[0] = {4, 4};  // Head
-  snake[1] = {3, 4};  // Body
-  snake[2] = {2, 4};  // Tail
-  
-  // Place initial food
-  GenerateFood();
-  
+  uint32_t seed = (uint32_t)random(1, 0x7FFFFFFF);
+  game.reset(seed);  // seeded once per game, so a seed replays the whole game
+  MU_Logf("Game seed: %lu\n", (unsigned long)seed);
   gameOver = false;
 }
 
-// Generate new food position
-void GenerateFood() {
-  bool validPosition = false;
-  
-  while (!validPosition) {
-    food.x = random(0, Matrix_Row);  // x is row
-    food.y = random(0, Matrix_Col);  // y is column
-    
-    // Check if food overlaps with snake
-    validPosition = true;
-    for (uint8_t i = 0; i < snakeLength; i++) {
-      if (snake[i].x == food.x && snake[i].y == food.y) {
-        validPosition = false;
-        break;
-      }
-    }
-  }
-}
-
 // Get current snake length
 uint8_t GetSnakeLength() {
-  return snakeLength;
+  return game.length();
 }
 
 // Move snake in given direction
 // Returns: 0 = game over, 1 = normal move, 2 = food eaten
 uint8_t MoveSnake(uint8_t direction) {
+  MU_PROFILE_SCOPE("move");
   if (gameOver) return 0;
-  
-  // Calculate new head position
-  Point newHead = snake[0];
-  
-  // In the matrix: x is row (0-7 top to bottom), y is column (0-7 left to right)
-  switch(direction) {
-    case 0: // Up (decrease row)
-      newHead.x--;
-      break;
-    case 1: // Right (increase column)
-      newHead.y++;
-      break;
-    case 2: // Down (increase row)
-      newHead.x++;
-      break;
-    case 3: // Left (decrease column)
-      newHead.y--;
-      break;
-  }
-  
-  // Check wall collision (wrap around edges for now)
-  if (newHead.x < 0) newHead.x = Matrix_Row - 1;
-  if (newHead.x >= Matrix_Row) newHead.x = 0;
-  if (newHead.y < 0) newHead.y = Matrix_Col - 1;
-  if (newHead.y >= Matrix_Col) newHead.y = 0;
-  
-  // Check if trying to move backwards into immediate body segment
-  if (snakeLength > 1 && snake[1].x == newHead.x && snake[1].y == newHead.y) {
-    // Trying to go backwards - just ignore this move and continue forward
-    return 1;  // Return normal move but don't actually update position
-  }
-  
-  // Check self collision with rest of body
-  for (uint8_t i = 2; i < snakeLength; i++) {  // Start from i=2 to skip immediate body segment
-    if (snake[i].x == newHead.x && snake[i].y == newHead.y) {
-      gameOver = true;
-      GameOverAnimation();
-      return 0;  // Game over
-    }
-  }
-  
-  // Check if food is eaten
-  bool foodEaten = (newHead.x == food.x && newHead.y == food.y);
-  
-  // Move snake body
-  if (!foodEaten) {
-    // Shift body segments (remove tail)
-    for (int8_t i = snakeLength - 1; i > 0; i--) {
-      snake[i] = snake[i - 1];
-    }
-  } else {
-    // Grow snake (keep tail, shift everything else)
-    if (snakeLength < MAX_SNAKE_LENGTH) {
-      for (int8_t i = snakeLength; i > 0; i--) {
-        snake[i] = snake[i - 1];
-      }
-      snakeLength++;
-      GenerateFood();
-    }
+  uint8_t status = game.step(direction);
+  if (status == SNAKE_DEAD) {
+    gameOver = true;
+    GameOverAnimation();
   }
-  
-  // Place new head
-  snake[0] = newHead;
-  
-  return foodEaten ? 2 : 1;
+  return status;
+}
+
+#if AUTO_PLAY
+// Direction the auto-player would move next
+uint8_t AutoPlayDirection() {
+  return autoPlayer.nextMove(game);
 }
+#endif
 
-// Update LED display
+// What a board cell (x = row, y = column) shows
+static CRGB CellColor(Point p) {
+  Point head = game.head(), food = game.food();
+  if (p.x == head.x && p.y == head.y) return CRGB(headColor[0], headColor[1], headColor[2]);  // Head (brighter)
+  if (game.isOccupied(p)) return CRGB(bodyColor[0], bodyColor[1], bodyColor[2]);
+  if (p.x == food.x && p.y == food.y) return CRGB(foodColor[0], foodColor[1], foodColor[2]);
+  return CRGB::Black;
+}
+
+// Draw the game into the back buffer (the caller presents it). Only the cells the last moves
+// changed are redrawn; MU_SetPixel marks them dirty, so a tick without a move presents nothing.
+// x is row, y is column, so the board XY is (y, x)
 void UpdateDisplay() {
-  pixels.clear();
-  
-  // Draw snake body (draw body first so head appears on top)
-  // Using the original indexing: row*8+col where x=row, y=col
-  for (uint8_t i = 1; i < snakeLength; i++) {
-    uint8_t pixelIndex = snake[i].x * Matrix_Col + snake[i].y;
-    pixels.setPixelColor(pixelIndex, pixels.Color(bodyColor[0], bodyColor[1], bodyColor[2]));
+  MU_PROFILE_SCOPE("draw");
+  const Point* changed;
+  uint8_t changedCount;
+  if (!game.takeChanged(&changed, &changedCount)) {
+    for (int8_t x = 0; x < Matrix_Row; x++) {
+      for (int8_t y = 0; y < Matrix_Col; y++) MU_SetPixel(y, x, CellColor({x, y}));
+    }
+  } else {
+    for (uint8_t i = 0; i < changedCount; i++) MU_SetPixel(changed[i].y, changed[i].x, CellColor(changed[i]));
   }
-  
-  // Draw snake head (brighter)
-  uint8_t headIndex = snake[0].x * Matrix_Col + snake[0].y;
-  pixels.setPixelColor(headIndex, pixels.Color(headColor[0], headColor[1], headColor[2]));
-  
-  // Draw food
-  uint8_t foodIndex = food.x * Matrix_Col + food.y;
-  pixels.setPixelColor(foodIndex, pixels.Color(foodColor[0], foodColor[1], foodColor[2]));
-  
-  pixels.show();
 }
 
-// Game over animation
+// Game over animation: flash red 3 times. Played by the effects engine from the render step,
+// so the game tick (and the IMU task, telemetry) keep running meanwhile.
 void GameOverAnimation() {
-  // Flash red 3 times
-  for (uint8_t flash = 0; flash < 3; flash++) {
-    // All red
-    for (uint8_t i = 0; i < RGB_COUNT; i++) {
-      pixels.setPixelColor(i, pixels.Color(30, 0, 0));
-    }
-    pixels.show();
-    delay(200);
-    
-    // Clear
-    pixels.clear();
-    pixels.show();
-    delay(200);
-  }
-}
\ No newline at end of file
+  MU_FxFlash(CRGB(30, 0, 0), 3, 200, 200);
+}
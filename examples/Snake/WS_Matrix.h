@@ -6,7 +6,10 @@
 #define Matrix_Row        8     
 #define Matrix_Col        8       
 #define RGB_COUNT         64
-#define MAX_SNAKE_LENGTH  64    // Maximum possible snake length (entire board)
+
+#ifndef AUTO_PLAY
+#define AUTO_PLAY 0             // 1: the Hamiltonian auto-player steers instead of the tilt
+#endif
 
 // Function declarations
 void RGB_Matrix();
@@ -15,5 +18,8 @@ void Snake_Init();
 uint8_t MoveSnake(uint8_t direction);
 void UpdateDisplay();
 uint8_t GetSnakeLength();
+#if AUTO_PLAY
+uint8_t AutoPlayDirection();
+#endif
 
 #endif
@@ -1,69 +1,64 @@
-#include "WS_QMI8658.h"
 #include "WS_Matrix.h"
+#include "config/BoardConfig.h"
+#include "lib/MatrixUtil/MatrixUtil.h"
+#include "lib/MatrixUtil/MatrixTilt.h"
+#include "lib/MatrixUtil/MatrixQMI.h"
+#include "lib/MatrixUtil/MatrixRender.h"
+#include "lib/MatrixUtil/MatrixIdle.h"
+#include "lib/MatrixUtil/MatrixBoot.h"
 
 // English: Please note that the brightness of the lamp bead should not be too high, which can easily cause the temperature of the board to rise rapidly, thus damaging the board !!!
 // Chinese: 请注意，灯珠亮度不要太高，容易导致板子温度急速上升，从而损坏板子!!! 
-extern IMUdata Accel; 
 IMUdata game;
+
+#define IMU_BOOT_MS 500  // BOOT: reports the IMU late after this; the dot just doesn't move without it
+
+// ~10 deg to start moving, 80 ms per step while held (the old loop stepped roughly every 100 ms)
+MU_TiltConfig tiltConfig()
+{
+  MU_TiltConfig c;
+  c.onCd = 1000;
+  c.offCd = 600;
+  c.holdUs = 20000;
+  c.repeatUs = 80000;
+  c.tauUs = 40000;     // accelerometer only (MU_IMU_TILT): no gyro to bridge a long time constant
+  return c;
+}
+
+bool startImu()
+{
+  return MU_ImuBegin(MU_IMU_TILT);  // accelerometer at low-power 128 Hz, gyro off
+}
+
 void setup()
 {
-  QMI8658_Init();
   Matrix_Init();
+  Game(0, 0);  // first frame: the dot where it starts
+  MU_BootFrame();
+  MU_TiltBegin(tiltConfig());  // before MU_ImuBegin starts the sensor task
+  int8_t imu = MU_BootStart("imu", startImu, IMU_BOOT_MS);
+  MU_BootDefer(MU_ImuDump, imu);  // register dump (IMU_DEBUG) after BOOT: and the IMU stage
+  // Left untouched for 3 s: IMU on wake-on-motion, light sleep with the dot latched on the LEDs
+  MU_IdleConfig idle;
+  idle.enter = MU_ImuSleep;
+  idle.leave = MU_ImuResume;
+  idle.poll = MU_ImuMotionPoll;
+  idle.wakePin = MU_ImuWakePin;
+  idle.ready = MU_RenderIdle;
+  MU_IdleBegin(idle);
 }
 
 
-uint8_t X_EN = 0, Y_EN = 0, Time_X_A = 0, Time_X_B = 0, Time_Y_A = 0, Time_Y_B = 0;
 void loop()
 {
-  QMI8658_Loop();
-  if(Accel.x > 0.15 || Accel.x < 0  || Accel.y > 0.15 || Accel.y < 0  || Accel.z > -0.9 || Accel.z < -1.1  ){
-    if(Accel.x > 0.15){
-      Time_X_A = Time_X_A + Accel.x * 10;
-      Time_X_B = 0;
-    }
-    else if(Accel.x < 0){
-      Time_X_B = Time_X_B + std::abs(Accel.x) * 10;
-      Time_X_A = 0;
-    }
-    else{
-      Time_X_A = 0;
-      Time_X_B = 0;
-    }
-    if(Accel.y > 0.15){
-      Time_Y_A = Time_Y_A + Accel.y * 10;
-      Time_Y_B = 0;
-    }
-    else if(Accel.y < 0){
-      Time_Y_B = Time_Y_B + std::abs(Accel.y) * 10;
-      Time_Y_A = 0;
-    }
-    else{
-      Time_Y_A = 0;
-      Time_Y_B = 0;
-    }
-    if(Time_X_A >= 10){
-      X_EN = 1;
-      Time_X_A = 0;
-      Time_X_B = 0;
-    }
-    if(Time_X_B >= 10){
-      X_EN = 2;
-      Time_X_A = 0;
-      Time_X_B = 0;
-    }
-    if(Time_Y_A >= 10){
-      Y_EN = 2;
-      Time_Y_A = 0;
-      Time_Y_B = 0;
-    }
-    if(Time_Y_B >= 10){
-      Y_EN = 1;
-      Time_Y_A = 0;
-      Time_Y_B = 0;
-    }
-    Game(X_EN,Y_EN);
-    X_EN = 0;
-    Y_EN = 0;
+  MU_BootPoll();
+  MU_ImuLoop();
+  // One step per debounced tilt event; holding the tilt repeats it (see tiltConfig)
+  MU_TiltEvent ev;
+  while (MU_TiltPoll(ev)) {
+    MU_IdleActivity();
+    if (ev.axis == MU_TILT_X) Game(ev.dir > 0 ? 1 : 2, 0);
+    else Game(0, ev.dir > 0 ? 2 : 1);
   }
-  delay(10);
+  if (!MU_IdleSleep()) MU_ImuWait(10);  // idle until the next IMU batch instead of spinning
 }
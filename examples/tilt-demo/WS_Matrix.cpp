@@ -1,33 +1,28 @@
 #include "WS_Matrix.h"
+#include "config/BoardConfig.h"
+#include "lib/MatrixUtil/MatrixUtil.h"
+#include "lib/MatrixUtil/MatrixRender.h"
+#include "lib/MatrixUtil/MatrixBits.h"
+#include "lib/MatrixUtil/MatrixPower.h"
+#include "lib/MatrixUtil/MatrixIMU.h"
 // English: Please note that the brightness of the lamp bead should not be too high, which can easily cause the temperature of the board to rise rapidly, thus damaging the board !!!
 // Chinese: 请注意，灯珠亮度不要太高，容易导致板子温度急速上升，从而损坏板子!!! 
 uint8_t RGB_Data[3] = {30,30,30}; 
-uint8_t Matrix_Data[8][8];  
+MU_Bitmap Matrix_Bits;  // lit cells, 1 bit each; Game() keeps WS_Matrix's x = row, y = column
 Adafruit_NeoPixel pixels(RGB_COUNT, RGB_Control_PIN, NEO_RGB + NEO_KHZ800); 
 
+// Redraw the grid in one pass over the bitmap: clear cells off, lit cells in RGB_Data
 void RGB_Matrix() {
-  for (int row = 0; row < Matrix_Row; row++) {
-    for (int col = 0; col < Matrix_Col; col++) {
-    // int hue = ((i * 256 / RGB_COUNT) % 256)*2;
-    // pixels.setPixelColor(i, pixels.ColorHSV(hue, 255, 10)); 
-      if(Matrix_Data[row][col] == 1)      
-      {
-        pixels.setPixelColor(row*8+col, pixels.Color(RGB_Data[0], RGB_Data[1], RGB_Data[2]));   
-      }
-      else
-      {
-        pixels.setPixelColor(row*8+col, pixels.Color(0, 0, 0)); 
-      }
-    }
-  }
-  pixels.show();
+  const CRGB palette[2] = { CRGB(0, 0, 0), CRGB(RGB_Data[0], RGB_Data[1], RGB_Data[2]) };
+  MU_BitsExpand(MU_BackBuffer(), Matrix_Bits, palette);
+  MU_Present();  // LED output runs on the other core
 }
 
 
 uint8_t x=4,y=4;
 void Game(uint8_t X_EN,uint8_t Y_EN) 
 {
-  Matrix_Data[x][y] = 0;
+  Matrix_Bits.clear(y, x);
   if(X_EN && Y_EN){
     if(X_EN == 1)
       x=x+1;
@@ -56,8 +51,7 @@ void Game(uint8_t X_EN,uint8_t Y_EN)
   if(y < 0) y = 0;
   if(y == 8) y = 7;
   if(y > 8) y = 0;
-  printf("%d\r\n",y);
-  Matrix_Data[x][y]=1;
+  Matrix_Bits.set(y, x);
   RGB_Matrix();
 }
 void Matrix_Init() {
@@ -65,5 +59,11 @@ void Matrix_Init() {
   // English: Please note that the brightness of the lamp bead should not be too high, which can easily cause the temperature of the board to rise rapidly, thus damaging the board !!!
   // Chinese: 请注意，灯珠亮度不要太高，容易导致板子温度急速上升，从而损坏板子!!! 
   pixels.setBrightness(60);                       // set brightness  
-  memset(Matrix_Data, 0, sizeof(Matrix_Data)); 
+  Matrix_Bits.clearAll();
+  // Brightness limiter with thermal derate; must precede MU_RenderBegin
+  MU_PowerConfig power;
+  power.brightness = pixels.getBrightness();
+  power.temperatureC = MU_ImuTemperatureC;
+  MU_PowerBegin(power);
+  MU_RenderBegin(MU_ShowNeoPixel<Adafruit_NeoPixel, pixels>);
 }
\ No newline at end of file
@@ -1,12 +1,21 @@
 #include <WiFi.h>
 #include <FastLED.h>
+#include "config/BoardConfig.h"
+#include "lib/MatrixUtil/MatrixUtil.h"
+#include "lib/MatrixUtil/MatrixTelemetry.h"
+#include "lib/MatrixUtil/MatrixRender.h"
+#include "lib/MatrixUtil/MatrixSched.h"
+#include "lib/MatrixUtil/MatrixFx.h"
+#include "lib/MatrixUtil/MatrixPower.h"
+#include "lib/MatrixUtil/MatrixIMU.h"
+#include "lib/MatrixUtil/MatrixSniff.h"
+#include "lib/MatrixUtil/MatrixMedian.h"
+#include "lib/MatrixUtil/MatrixNav.h"
+#include "lib/MatrixUtil/MatrixQMI.h"
+#include "lib/MatrixUtil/MatrixIdle.h"
+#include "lib/MatrixUtil/MatrixBoot.h"
 
-// LED Matrix Configuration
-#define LED_PIN     14      // Data pin for WS2812B matrix (GPIO 14 for Waveshare ESP32-S3-Matrix)
-#define NUM_LEDS    64      // 8x8 matrix
-#define MATRIX_WIDTH 8
-#define MATRIX_HEIGHT 8
-#define BRIGHTNESS  60      // Global brightness (0-255)
+// LED matrix geometry, pin, color order and brightness come from config/BoardConfig.h
 
 // WiFi Configuration
 const char* TARGET_SSID = "HIDER";
@@ -17,8 +26,39 @@ const char* TARGET_SSID = "HIDER";
 #define EMA_ALPHA   0.1    // Exponential moving average alpha (0-1) - lower = more smoothing
 
 // Timing
-#define SCAN_INTERVAL_MS  100    // Delay between scans
+#define SCAN_INTERVAL_MS  100    // Update step: one scan / state machine pass
 #define STATUS_BLINK_MS   500    // Blink interval for status colors
+#define DISCOVERY_RETRY_MS 1000  // First backoff after a failed full sweep (doubles up to the max)
+#define DISCOVERY_RETRY_MAX_MS 8000
+#define SCAN_DWELL_MS     120    // Active scan time per channel (async discovery scans)
+#define LOST_FLASH_MS     200    // Gray flash when the signal is lost
+
+// Idle (lib/MatrixUtil/MatrixIdle.h): locked, not moved and the RSSI within IDLE_RSSI_DB for
+// IDLE_AFTER_MS -> slower update steps, IMU on wake-on-motion and, with IDLE_SLEEP in the board
+// profile, automatic light sleep between steps
+#define IDLE_AFTER_MS     10000
+#define IDLE_RSSI_DB      3
+#define IDLE_STEP_MS      1000   // Update step while idle
+
+// Startup (lib/MatrixUtil/MatrixBoot.h): the blue frame shows at once while serial, the IMU and
+// the radio come up side by side; past these the tracker runs without them (BOOT: says which)
+#define IMU_BOOT_MS       500    // the thermometer display stands in until the IMU is up
+#define WIFI_BOOT_MS      1000   // tracking starts when the radio is up, whenever that is
+#define WIFI_RETRY_MS     5000   // failed radio bring-up: red blink, retried this often
+
+// RSSI sampling: 1 = sniff the locked AP's frames in promiscuous mode (tens to hundreds of
+// samples/s), 0 = one single-channel scan per update step (<3 Hz). Scanning is also the
+// fallback when promiscuous mode cannot be enabled.
+#define USE_SNIFFER       1
+
+// Display: 0 = whole matrix shows the current RSSI color (thermometer), 1 = heatmap of RSSI by
+// walked position (steps + heading from the QMI8658) while locked; without a working QMI8658 the
+// heatmap would be one cell, so it falls back to the thermometer
+#define HEATMAP_MODE      1
+#define HEAT_GRID         16     // world cells remembered (rolling, one cell per step), power of two
+#define HEAT_CELL_ALPHA   0.3    // EMA weight of a new reading in a cell
+#define HEAT_EDGE         2      // scroll the view when the position gets this close to its edge
+#define MARKER_BLINK_MS   250    // current position blinks white
 
 // State Machine
 enum SystemState {
@@ -31,143 +71,371 @@ enum SystemState {
 // Global Variables
 CRGB leds[NUM_LEDS];
 SystemState currentState = STATE_DISCOVERY;
-uint8_t targetBSSID[6] = {0};
-uint8_t targetChannel = 0;
-bool hasTarget = false;
-float rssiEMA = RSSI_MIN;
-bool firstReading = true;
-unsigned long lastBlinkTime = 0;
-bool blinkState = false;
-int lostCounter = 0;
-
-// Median filter for RSSI (to remove spikes)
-#define MEDIAN_SAMPLES 5
-int rssiBuffer[MEDIAN_SAMPLES];
-int bufferIndex = 0;
-bool bufferFull = false;
-
-// Function to convert XY to LED index for serpentine wiring
-uint16_t XY(uint8_t x, uint8_t y) {
-  if (y & 0x01) {
-    // Odd rows run backwards
-    return (y * MATRIX_WIDTH) + (MATRIX_WIDTH - 1 - x);
+unsigned long nextDiscoveryTime = 0;
+unsigned long discoveryBackoff = DISCOVERY_RETRY_MS;
+unsigned long lostTime = 0;
+CRGB displayColor = CRGB(0, 0, 0);  // drawn by Render() at FRAME_RATE_MS
+
+// Median filter for RSSI (to remove spikes). The sniffer delivers far more samples than the
+// scan fallback, so it gets a wider window against multipath spikes at the same latency.
+#define MEDIAN_SAMPLES       5    // scan fallback
+#define SNIFF_MEDIAN_SAMPLES 31   // promiscuous sampling
+
+// Tracked APs: every HIDER BSSID seen by a scan or the sniffer keeps its own filter state, so
+// moving on to another AP when the current one goes quiet needs no rediscovery scan
+#define MAX_APS          6
+#define AP_LOST_MS       1500   // Shown AP silent this long = hand off (beacons are ~100 ms)
+#define AP_FORGET_MS     30000  // Entries not heard from this long are no handoff candidates
+#define HANDOFF_DB       6      // A live AP on the same channel must be this much stronger to take over
+
+struct TrackedAp {
+  bool used;
+  uint8_t bssid[6];
+  uint8_t channel;
+  MU_RunningMedian<int, MEDIAN_SAMPLES> scanMedian;
+  MU_RunningMedian<int, SNIFF_MEDIAN_SAMPLES> sniffMedian;
+  float ema;
+  bool primed;              // ema holds a value
+  int lastRSSI;
+  int median;               // newest median, folded into ema by commitSamples()
+  uint16_t pending;         // samples since the last commitSamples()
+  unsigned long lastSeen;
+  bool silent;              // handed off for going quiet; cleared when heard again
+};
+
+TrackedAp aps[MAX_APS];
+int activeAp = -1;              // AP whose RSSI drives the display
+unsigned long activeSince = 0;  // grace period start after a (re)lock or retune
+
+// Discovery scans run asynchronously, one channel at a time: channels where HIDER APs were seen
+// before go first (prior hits, last shown channel first, then its neighbours), then one full
+// sweep; a failed sweep backs off exponentially before the plan starts again.
+#define MAX_CHANNEL 13
+uint8_t channelHits[MAX_CHANNEL + 1];  // HIDER APs discovered per channel so far
+uint8_t scanPlan[MAX_CHANNEL + 1];     // channels to dwell on, then 0 = full sweep
+uint8_t scanPlanLen = 0;
+uint8_t scanPlanPos = 0;
+bool scanRunning = false;
+uint8_t scanChannel = 0;               // channel of the running scan, 0 = all
+unsigned long scanStartTime = 0;
+
+// Heatmap: cell (wx, wy) lives at heat[wx % HEAT_GRID][wy % HEAT_GRID]; the stored coordinates
+// tell a remembered cell from one recycled by walking more than HEAT_GRID steps away
+struct HeatCell {
+  int16_t wx, wy;
+  float rssi;
+  bool valid;
+};
+
+HeatCell heat[HEAT_GRID][HEAT_GRID];
+uint8_t heatBSSID[6];             // AP the map was measured against
+int16_t posX = 0, posY = 0;       // current world cell
+int16_t viewX = 0, viewY = 0;     // world cell shown at matrix (0, 0)
+
+// What the back buffer holds, so Render() only redraws what changed
+enum Drawn { DRAWN_NONE, DRAWN_SOLID, DRAWN_HEAT, DRAWN_FX };
+Drawn drawn = DRAWN_NONE;
+#define HEAT_DIRTY_MAX 8
+int16_t heatDirty[HEAT_DIRTY_MAX][2];  // world cells to redraw on the next frame
+uint8_t heatDirtyCount = 0;
+bool heatFullRedraw = true;
+
+bool sniffing = false;          // RSSI comes from MU_SniffPoll() instead of channel scans
+uint8_t sniffChannel = 0;
+
+// Set the color the whole matrix shows from the next frame on
+void fillMatrix(uint8_t r, uint8_t g, uint8_t b) {
+  displayColor = CRGB(r, g, b);
+}
+
+void rssiToColor(float rssi, uint8_t* r, uint8_t* g, uint8_t* b);
+
+HeatCell& heatCell(int16_t wx, int16_t wy) {
+  return heat[wx & (HEAT_GRID - 1)][wy & (HEAT_GRID - 1)];
+}
+
+void markHeatDirty(int16_t wx, int16_t wy) {
+  if (heatDirtyCount == HEAT_DIRTY_MAX) {
+    heatFullRedraw = true;
+    return;
+  }
+  heatDirty[heatDirtyCount][0] = wx;
+  heatDirty[heatDirtyCount][1] = wy;
+  heatDirtyCount++;
+}
+
+// Fold a filtered reading into the cell under the current position
+void addHeatSample(const uint8_t* bssid, float rssi) {
+  if (memcmp(bssid, heatBSSID, 6) != 0) {
+    // Another AP's RSSI is not comparable: start a new map
+    memcpy(heatBSSID, bssid, 6);
+    memset(heat, 0, sizeof(heat));
+    heatFullRedraw = true;
+  }
+  HeatCell& c = heatCell(posX, posY);
+  if (!c.valid || c.wx != posX || c.wy != posY) {
+    c.wx = posX;
+    c.wy = posY;
+    c.rssi = rssi;
+    c.valid = true;
   } else {
-    // Even rows run forwards
-    return (y * MATRIX_WIDTH) + x;
+    c.rssi = HEAT_CELL_ALPHA * rssi + (1 - HEAT_CELL_ALPHA) * c.rssi;
   }
+  markHeatDirty(posX, posY);
 }
 
-// Fill entire matrix with single color
-void fillMatrix(uint8_t r, uint8_t g, uint8_t b) {
-  CRGB color = CRGB(r, g, b);
-  for (int i = 0; i < NUM_LEDS; i++) {
-    leds[i] = color;
+// Follow the dead-reckoned position; the view scrolls only near its edges
+void updatePosition() {
+  MU_NavState nav;
+  if (!MU_NavRead(nav)) return;
+  int16_t x = (int16_t)lroundf(nav.x), y = (int16_t)lroundf(nav.y);
+  if (x == posX && y == posY) return;
+  MU_IdleActivity();
+  markHeatDirty(posX, posY);  // old marker becomes a plain cell
+  posX = x;
+  posY = y;
+  markHeatDirty(posX, posY);
+  if (posX - viewX < HEAT_EDGE || posX - viewX > MATRIX_WIDTH - 1 - HEAT_EDGE ||
+      posY - viewY < HEAT_EDGE || posY - viewY > MATRIX_HEIGHT - 1 - HEAT_EDGE) {
+    viewX = posX - MATRIX_WIDTH / 2;
+    viewY = posY - MATRIX_HEIGHT / 2;
+    heatFullRedraw = true;
+  }
+  MU_Logf("Step %lu: heading %ld.%02ld deg, cell (%d, %d)\n", (unsigned long)nav.steps,
+                (long)(nav.headingCd / 100), (long)(nav.headingCd % 100), posX, posY);
+}
+
+void drawHeatCell(CRGB* frame, int16_t wx, int16_t wy, bool marker) {
+  int16_t x = wx - viewX, y = wy - viewY;
+  if (x < 0 || y < 0 || x >= MATRIX_WIDTH || y >= MATRIX_HEIGHT) return;
+  CRGB color = CRGB(0, 0, 0);
+  const HeatCell& c = heatCell(wx, wy);
+  if (c.valid && c.wx == wx && c.wy == wy) {
+    uint8_t r, g, b;
+    rssiToColor(c.rssi, &r, &g, &b);
+    color = CRGB(r, g, b);
   }
-  FastLED.show();
+  if (marker) color = CRGB(60, 60, 60);
+  frame[MU_XY(x, y)] = color;
 }
 
-// Convert RSSI to RGB color using full rainbow spectrum
+// Heatmap frame: a full redraw after scrolling or a mode change, otherwise only the dirty cells
+// and the blinking marker
+void renderHeatmap() {
+  CRGB* frame = MU_BackBuffer();
+  bool marker = MU_Idle.idle || ((millis() / MARKER_BLINK_MS) & 1);  // steady while idle: nothing to send
+  if (drawn != DRAWN_HEAT || heatFullRedraw) {
+    for (int16_t y = 0; y < MATRIX_HEIGHT; y++) {
+      for (int16_t x = 0; x < MATRIX_WIDTH; x++) {
+        drawHeatCell(frame, viewX + x, viewY + y, false);
+      }
+    }
+  } else {
+    for (uint8_t i = 0; i < heatDirtyCount; i++) {
+      drawHeatCell(frame, heatDirty[i][0], heatDirty[i][1], false);
+    }
+  }
+  drawHeatCell(frame, posX, posY, marker);
+  heatDirtyCount = 0;
+  heatFullRedraw = false;
+  drawn = DRAWN_HEAT;
+}
+
+// Render step: fill the back buffer; the scheduler presents it (LED output runs on the other core).
+// The back buffer already holds the last frame, so an unchanged color costs nothing here and
+// MU_Present() drops the identical frame instead of retransmitting it.
+void Render() {
+  if (MU_FxRender()) {  // status blink
+    drawn = DRAWN_FX;
+    return;
+  }
+#if HEATMAP_MODE
+  if (currentState == STATE_LOCKED && MU_ImuReady()) {
+    renderHeatmap();
+    return;
+  }
+#endif
+  static CRGB rendered = CRGB(0, 0, 0);
+  if (drawn == DRAWN_SOLID && displayColor == rendered) return;
+  fill_solid(MU_BackBuffer(), NUM_LEDS, displayColor);
+  rendered = displayColor;
+  drawn = DRAWN_SOLID;
+}
+
+// RSSI gradient, built at compile time: entry i is the blue (weak) -> red (strong) HSV hue sweep
+// (240 deg down to 0 deg, full saturation and value) at t = i / 255 of the RSSI range
+struct RssiGradient {
+  uint8_t rgb[256][3];
+};
+
+constexpr RssiGradient makeRssiGradient() {
+  RssiGradient lut{};
+  for (int i = 0; i < 256; i++) {
+    double h = (1.0 - i / 255.0) * 240.0 / 60.0;  // Reverse so strong signal = red
+    int hi = int(h) % 6;
+    double f = h - int(h);
+    uint8_t v = 255;
+    uint8_t p = 0;
+    uint8_t q = uint8_t(255 * (1 - f));
+    uint8_t u = uint8_t(255 * f);
+    uint8_t* c = lut.rgb[i];
+    switch (hi) {
+      case 0: c[0] = v; c[1] = u; c[2] = p; break;  // Red to Yellow
+      case 1: c[0] = q; c[1] = v; c[2] = p; break;  // Yellow to Green
+      case 2: c[0] = p; c[1] = v; c[2] = u; break;  // Green to Cyan
+      case 3: c[0] = p; c[1] = q; c[2] = v; break;  // Cyan to Blue
+      case 4: c[0] = u; c[1] = p; c[2] = v; break;  // Blue to Magenta
+      case 5: c[0] = v; c[1] = p; c[2] = q; break;  // Magenta to Red
+    }
+  }
+  return lut;
+}
+
+constexpr RssiGradient RSSI_GRADIENT = makeRssiGradient();
+static_assert(RSSI_GRADIENT.rgb[0][2] == 255 && RSSI_GRADIENT.rgb[0][0] == 0, "weakest RSSI must map to blue");
+static_assert(RSSI_GRADIENT.rgb[255][0] == 255 && RSSI_GRADIENT.rgb[255][2] == 0, "strongest RSSI must map to red");
+
+// Convert RSSI to RGB color: quantize to 256 steps over RSSI_MIN..RSSI_MAX, then look up
 void rssiToColor(float rssi, uint8_t* r, uint8_t* g, uint8_t* b) {
-  // Normalize RSSI to 0-1 range
-  float t = (rssi - RSSI_MIN) / float(RSSI_MAX - RSSI_MIN);
-  if (t < 0) t = 0;
-  if (t > 1) t = 1;
-  
-  // Map to hue (0-240 degrees for blue to red through green/yellow/orange)
-  // Blue (weak) = 240°, Cyan = 180°, Green = 120°, Yellow = 60°, Red (strong) = 0°
-  float hue = (1.0 - t) * 240.0;  // Reverse so strong signal = red
-  
-  // Convert HSV to RGB (simplified for full saturation and value)
-  float h = hue / 60.0;
-  int hi = int(h) % 6;
-  float f = h - int(h);
-  
-  uint8_t v = 255;
-  uint8_t p = 0;
-  uint8_t q = uint8_t(255 * (1 - f));
-  uint8_t u = uint8_t(255 * f);
-  
-  switch(hi) {
-    case 0: *r = v; *g = u; *b = p; break;  // Red to Yellow
-    case 1: *r = q; *g = v; *b = p; break;  // Yellow to Green  
-    case 2: *r = p; *g = v; *b = u; break;  // Green to Cyan
-    case 3: *r = p; *g = q; *b = v; break;  // Cyan to Blue
-    case 4: *r = u; *g = p; *b = v; break;  // Blue to Magenta
-    case 5: *r = v; *g = p; *b = q; break;  // Magenta to Red
+  int i = int((rssi - RSSI_MIN) * (255.0f / (RSSI_MAX - RSSI_MIN)) + 0.5f);
+  if (i < 0) i = 0;
+  if (i > 255) i = 255;
+  const uint8_t* c = RSSI_GRADIENT.rgb[i];
+  *r = c[0];
+  *g = c[1];
+  *b = c[2];
+}
+
+int findAp(const uint8_t* bssid) {
+  for (int i = 0; i < MAX_APS; i++) {
+    if (aps[i].used && memcmp(aps[i].bssid, bssid, 6) == 0) return i;
   }
+  return -1;
 }
 
-// Get median value from array
-int getMedian(int* arr, int size) {
-  // Create a temporary array for sorting
-  int temp[MEDIAN_SAMPLES];
-  for (int i = 0; i < size; i++) {
-    temp[i] = arr[i];
+// Find or add an AP; a full table reuses the entry heard from least recently (never the shown one)
+int trackAp(const uint8_t* bssid, uint8_t channel, unsigned long now) {
+  int i = findAp(bssid);
+  if (i >= 0) {
+    aps[i].channel = channel;
+    return i;
   }
-  
-  // Simple bubble sort for small array
-  for (int i = 0; i < size - 1; i++) {
-    for (int j = 0; j < size - i - 1; j++) {
-      if (temp[j] > temp[j + 1]) {
-        int swap = temp[j];
-        temp[j] = temp[j + 1];
-        temp[j + 1] = swap;
-      }
+  int slot = -1;
+  for (i = 0; i < MAX_APS; i++) {
+    if (!aps[i].used) {
+      slot = i;
+      break;
     }
+    if (i != activeAp && (slot < 0 || (long)(aps[i].lastSeen - aps[slot].lastSeen) < 0)) slot = i;
   }
+  if (slot < 0) return -1;
+  
+  TrackedAp& ap = aps[slot];
+  ap.used = true;
+  memcpy(ap.bssid, bssid, 6);
+  ap.channel = channel;
+  ap.scanMedian.clear();
+  ap.sniffMedian.clear();
+  ap.primed = false;
+  ap.pending = 0;
+  ap.lastSeen = now;
+  ap.silent = false;
+  if (sniffing && channel == sniffChannel) MU_SniffWatch(bssid);
   
-  return temp[size / 2];
+  MU_Logf("Tracking AP %d: %02X:%02X:%02X:%02X:%02X:%02X on channel %d\n", slot,
+                bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5], channel);
+  return slot;
 }
 
-// Apply median filter then EMA smoothing to RSSI
-float smoothRSSI(int rawRSSI) {
-  // Add to circular buffer
-  rssiBuffer[bufferIndex] = rawRSSI;
-  bufferIndex = (bufferIndex + 1) % MEDIAN_SAMPLES;
-  
-  if (!bufferFull && bufferIndex == 0) {
-    bufferFull = true;
+void forgetAps() {
+  for (int i = 0; i < MAX_APS; i++) aps[i].used = false;
+  activeAp = -1;
+}
+
+// Median filter one raw reading into the AP's window
+void addSample(int i, int rssi, bool sniffed, unsigned long now) {
+  TrackedAp& ap = aps[i];
+  ap.median = sniffed ? ap.sniffMedian.push(rssi) : ap.scanMedian.push(rssi);
+  ap.lastRSSI = rssi;
+  ap.pending++;
+  ap.lastSeen = now;
+  ap.silent = false;
+}
+
+// EMA step for every AP that got samples, once per update step so the smoothing time
+// constant does not depend on how many frames were sniffed
+void commitSamples() {
+  for (int i = 0; i < MAX_APS; i++) {
+    TrackedAp& ap = aps[i];
+    if (!ap.used || ap.pending == 0) continue;
+    if (!ap.primed) {
+      ap.ema = ap.median;
+      ap.primed = true;
+    } else {
+      ap.ema = (EMA_ALPHA * ap.median) + ((1 - EMA_ALPHA) * ap.ema);
+    }
+    ap.pending = 0;
   }
-  
-  // Get median value
-  int medianValue;
-  if (bufferFull) {
-    medianValue = getMedian(rssiBuffer, MEDIAN_SAMPLES);
-  } else {
-    medianValue = getMedian(rssiBuffer, bufferIndex);
+}
+
+// Strongest AP (by smoothed RSSI) worth switching to, or -1
+int bestAp(unsigned long now, int exclude) {
+  int best = -1;
+  for (int i = 0; i < MAX_APS; i++) {
+    const TrackedAp& ap = aps[i];
+    if (!ap.used || !ap.primed || ap.silent || i == exclude) continue;
+    if (now - ap.lastSeen > AP_FORGET_MS) continue;
+    if (best < 0 || ap.ema > aps[best].ema) best = i;
   }
-  
-  // Apply EMA to median value
-  if (firstReading) {
-    rssiEMA = medianValue;
-    firstReading = false;
-  } else {
-    rssiEMA = (EMA_ALPHA * medianValue) + ((1 - EMA_ALPHA) * rssiEMA);
+  return best;
+}
+
+bool startSniffer();
+
+// Show AP i from now on; retunes the sniffer when it sits on another channel
+void selectAp(int i, unsigned long now) {
+  TrackedAp& ap = aps[i];
+  if (activeAp >= 0 && activeAp != i) {
+    MU_Logf("Handoff: AP %d -> AP %d (%.1f dBm)\n", activeAp, i, ap.ema);
   }
-  return rssiEMA;
+  activeAp = i;
+  activeSince = now;
+  MU_Logf("Locked to BSSID %02X:%02X:%02X:%02X:%02X:%02X on channel %d\n",
+                ap.bssid[0], ap.bssid[1], ap.bssid[2],
+                ap.bssid[3], ap.bssid[4], ap.bssid[5],
+                ap.channel);
+  if (sniffing && ap.channel != sniffChannel) startSniffer();
+}
+
+// After a sampling pass: hand off when the shown AP went quiet or a live one on the same channel
+// is clearly stronger. Returns false when no tracked AP is left to show.
+bool updateHandoff(unsigned long now) {
+  TrackedAp& cur = aps[activeAp];
+  unsigned long heard = (long)(cur.lastSeen - activeSince) > 0 ? cur.lastSeen : activeSince;
+  int next = bestAp(now, activeAp);
+  if (now - heard > AP_LOST_MS) {
+    cur.silent = true;
+    if (next < 0) return false;
+    selectAp(next, now);
+  } else if (next >= 0 && aps[next].channel == cur.channel && now - aps[next].lastSeen <= AP_LOST_MS &&
+             aps[next].ema > cur.ema + HANDOFF_DB) {
+    selectAp(next, now);
+  }
+  return true;
 }
 
 // Display status colors based on state
 void showStatusColor() {
-  unsigned long currentTime = millis();
-  
   switch (currentState) {
     case STATE_DISCOVERY:
     case STATE_SCANNING:
-      // Dim amber for scanning
-      if (currentTime - lastBlinkTime > STATUS_BLINK_MS) {
-        blinkState = !blinkState;
-        lastBlinkTime = currentTime;
-      }
-      if (blinkState) {
-        fillMatrix(100, 50, 0);  // Amber
-      } else {
-        fillMatrix(50, 25, 0);   // Dim amber
-      }
+      // Amber / dim amber blink for scanning, timed by the effects engine in Render()
+      if (!MU_FxActive()) MU_FxBlink(CRGB(100, 50, 0), CRGB(50, 25, 0), 2 * STATUS_BLINK_MS);
       break;
       
     case STATE_LOST:
       // Brief gray flash for lost signal
+      MU_FxStop();
       fillMatrix(40, 40, 40);  // Gray
       break;
       
@@ -177,172 +445,349 @@ void showStatusColor() {
   }
 }
 
-// Perform discovery scan to find target network
-bool performDiscoveryScan() {
-  Serial.println("Starting discovery scan...");
-  
-  int numNetworks = WiFi.scanNetworks();
-  if (numNetworks == 0) {
-    Serial.println("No networks found");
-    return false;
+// Queue a channel once in the scan plan
+void planChannel(uint8_t ch) {
+  if (ch < 1 || ch > MAX_CHANNEL) return;
+  for (uint8_t i = 0; i < scanPlanLen; i++) {
+    if (scanPlan[i] == ch) return;
   }
-  
+  scanPlan[scanPlanLen++] = ch;
+}
+
+// Order channels for reacquiring: the last shown channel, then channels by prior hits, then the
+// neighbours of the last one (an AP that changed channel usually moves close by)
+void buildScanPlan(uint8_t lastChannel) {
+  scanPlanLen = 0;
+  scanPlanPos = 0;
+  planChannel(lastChannel);
+  for (int i = 0; i < MAX_APS; i++) {
+    if (aps[i].used) planChannel(aps[i].channel);
+  }
+  for (;;) {
+    uint8_t best = 0;
+    for (uint8_t ch = 1; ch <= MAX_CHANNEL; ch++) {
+      if (channelHits[ch] > channelHits[best]) {
+        bool planned = false;
+        for (uint8_t i = 0; i < scanPlanLen; i++) planned |= scanPlan[i] == ch;
+        if (!planned) best = ch;
+      }
+    }
+    if (best == 0) break;
+    planChannel(best);
+  }
+  if (lastChannel > 0) {
+    planChannel(lastChannel - 1);
+    planChannel(lastChannel + 1);
+  }
+  discoveryBackoff = DISCOVERY_RETRY_MS;
+  nextDiscoveryTime = millis();
+  scanStartTime = millis();
+}
+
+// Track every AP with the target SSID in a finished scan and show the strongest
+bool collectDiscovery(int numNetworks) {
+  unsigned long now = millis();
   int bestRSSI = -127;
-  int bestIndex = -1;
+  int strongest = -1;
   
-  // Find strongest network with target SSID
   for (int i = 0; i < numNetworks; i++) {
     if (WiFi.SSID(i) == TARGET_SSID) {
-      Serial.printf("Found %s: RSSI=%d, Channel=%d\n", 
+      MU_Logf("Found %s: RSSI=%d, Channel=%d\n", 
                     TARGET_SSID, WiFi.RSSI(i), WiFi.channel(i));
       
+      int ap = trackAp(WiFi.BSSID(i), WiFi.channel(i), now);
+      if (ap < 0) continue;
+      if (!aps[ap].primed && channelHits[aps[ap].channel] < 255) channelHits[aps[ap].channel]++;
+      addSample(ap, WiFi.RSSI(i), false, now);  // first reading initializes the AP's EMA
       if (WiFi.RSSI(i) > bestRSSI) {
         bestRSSI = WiFi.RSSI(i);
-        bestIndex = i;
+        strongest = ap;
       }
     }
   }
+  commitSamples();
   
-  if (bestIndex >= 0) {
-    // Store the BSSID and channel of strongest AP
-    memcpy(targetBSSID, WiFi.BSSID(bestIndex), 6);
-    targetChannel = WiFi.channel(bestIndex);
-    hasTarget = true;
-    
-    Serial.printf("Locked to BSSID %02X:%02X:%02X:%02X:%02X:%02X on channel %d\n",
-                  targetBSSID[0], targetBSSID[1], targetBSSID[2],
-                  targetBSSID[3], targetBSSID[4], targetBSSID[5],
-                  targetChannel);
-    
-    // Initialize EMA with first reading
-    smoothRSSI(bestRSSI);
-    
+  if (strongest >= 0) {
+    selectAp(strongest, now);
     return true;
   }
-  
-  Serial.println("Target network not found");
   return false;
 }
 
-// Scan for locked BSSID
-int scanForTarget() {
-  int numNetworks;
+// One non-blocking discovery pass: collect a finished scan, or start the next one in the plan.
+// Returns true once a target AP is locked.
+bool discoveryStep(unsigned long now) {
+  if (scanRunning) {
+    int n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_RUNNING) return false;
+    scanRunning = false;
+    bool found = n > 0 && collectDiscovery(n);
+    WiFi.scanDelete();
+    if (found) {
+      MU_Logf("Discovery: locked after %lu ms (channel %d)\n", now - scanStartTime, scanChannel);
+      return true;
+    }
+    if (scanChannel == 0) {
+      // Full sweep came up empty: back off, then walk the plan again
+      MU_Logf("Target network not found, retry in %lu ms\n", discoveryBackoff);
+      nextDiscoveryTime = now + discoveryBackoff;
+      discoveryBackoff = min(discoveryBackoff * 2, (unsigned long)DISCOVERY_RETRY_MAX_MS);
+      scanPlanPos = 0;
+    }
+  }
+  if ((long)(now - nextDiscoveryTime) < 0) return false;  // backing off
   
-  // Try single-channel scan if we know the channel
-  if (targetChannel > 0) {
-    // Note: ESP32 Arduino doesn't directly support single-channel scan
-    // We'll use regular scan but it will be faster with fewer networks
-    numNetworks = WiFi.scanNetworks(false, false, false, 300, targetChannel);
+  scanChannel = scanPlanPos < scanPlanLen ? scanPlan[scanPlanPos] : 0;
+  scanPlanPos = scanPlanPos < scanPlanLen ? scanPlanPos + 1 : 0;
+  if (scanChannel) {
+    MU_Logf("Discovery scan: channel %d\n", scanChannel);
   } else {
-    numNetworks = WiFi.scanNetworks();
+    MU_Log("Discovery scan: all channels\n");
   }
-  
-  if (numNetworks == 0) {
-    return -127;  // No signal
+  // Directed probe (ssid) so hidden or slow-beaconing HIDERs answer within the dwell
+  if (WiFi.scanNetworks(true, false, false, SCAN_DWELL_MS, scanChannel, TARGET_SSID) == WIFI_SCAN_FAILED) {
+    nextDiscoveryTime = now + DISCOVERY_RETRY_MS;
+    return false;
   }
+  scanRunning = true;
+  return false;
+}
+
+// Scan fallback: one single-channel scan on the shown AP's channel updates every tracked AP in it
+void scanTrackedAps(unsigned long now) {
+  MU_PROFILE_SCOPE("scan");  // blocking: this one dominates the update phase when it runs
+  int numNetworks = WiFi.scanNetworks(false, false, false, 300, aps[activeAp].channel);
   
-  // Look for our specific BSSID
   for (int i = 0; i < numNetworks; i++) {
-    uint8_t* bssid = WiFi.BSSID(i);
-    if (memcmp(bssid, targetBSSID, 6) == 0) {
-      return WiFi.RSSI(i);
+    int ap = findAp(WiFi.BSSID(i));
+    if (ap < 0 && WiFi.SSID(i) == TARGET_SSID) ap = trackAp(WiFi.BSSID(i), WiFi.channel(i), now);
+    if (ap >= 0) addSample(ap, WiFi.RSSI(i), false, now);
+  }
+}
+
+// Lock the radio to the shown AP's channel and sample every tracked AP (and any new beacon with
+// the target SSID) there; false = keep using scans
+bool startSniffer() {
+#if USE_SNIFFER
+  sniffChannel = aps[activeAp].channel;
+  sniffing = MU_SniffBegin(sniffChannel, TARGET_SSID);
+  if (sniffing) {
+    for (int i = 0; i < MAX_APS; i++) {
+      if (aps[i].used && aps[i].channel == sniffChannel) MU_SniffWatch(aps[i].bssid);
     }
   }
-  
-  return -127;  // Target not found
+  MU_Logf("RSSI source: %s (channel %d)\n", sniffing ? "promiscuous sniffer" : "channel scan", sniffChannel);
+#endif
+  return sniffing;
+}
+
+void stopSniffer() {
+  if (sniffing) MU_SniffEnd();
+  sniffing = false;
+}
+
+// Drain the sniffer ring into the AP table (newly seen BSSIDs are tracked on the fly)
+void drainSniffer(unsigned long now) {
+  MU_SniffSample s;
+  while (MU_SniffPoll(s)) {
+    int ap = findAp(s.bssid);
+    if (ap < 0) ap = trackAp(s.bssid, sniffChannel, now);
+    if (ap >= 0) addSample(ap, s.rssi, true, now);
+  }
+}
+
+void TrackerStep();
+
+float idleRssi = 0;  // shown RSSI at the last activity
+
+bool enterIdle() {
+#if HEATMAP_MODE
+  MU_ImuSleep();  // gyro off until the board moves (stays on if WoM can't be armed)
+#endif
+  MU_SchedSetUpdateUs(IDLE_STEP_MS * 1000UL);
+  MU_Log("Idle\n");
+  return true;
+}
+
+void leaveIdle() {
+  MU_SchedSetUpdateUs(SCAN_INTERVAL_MS * 1000UL);
+#if HEATMAP_MODE
+  MU_ImuResume();
+#endif
+  MU_Log("Awake\n");
+}
+
+int8_t wifiStage = -1;
+
+bool startImu() {
+  return MU_ImuBegin(MU_IMU_GAME);  // heading integrates the gyro
+}
+
+bool startWifi() {
+  bool ok = WiFi.mode(WIFI_STA);
+  WiFi.disconnect(true, true);
+  return ok;
+}
+
+bool wifiUp = false;              // the boot stage or a later retry brought the radio up
+unsigned long wifiRetryTime = 0;
+
+// Radio check for TrackerStep: up, still coming up (the blue startup frame stays; a late stage may
+// still land), or failed (red blink and a retry every WIFI_RETRY_MS, inline in the update step)
+bool wifiReady(unsigned long now) {
+  if (wifiUp) return true;
+  if (MU_BootOk(wifiStage)) return wifiUp = true;
+  if (!MU_BootDone(wifiStage)) return false;
+  if (!MU_FxActive()) MU_FxBlink(CRGB(100, 0, 0), CRGB(30, 0, 0), 2 * STATUS_BLINK_MS);
+  if (wifiRetryTime && now - wifiRetryTime < WIFI_RETRY_MS) return false;
+  wifiRetryTime = now;
+  MU_Log("WiFi bring-up failed, retrying\n");
+  if (!startWifi()) return false;
+  MU_FxStop();
+  return wifiUp = true;
+}
+
+// Once the serial stage has settled (host connected or given up on), after the BOOT: line
+void printBanner() {
+  MU_Log("\n=== WiFi Gradient Viewer ===\n");
+  MU_Logf("Target SSID: %s\n", TARGET_SSID);
+  MU_Logf("RSSI Range: %d to %d dBm\n", RSSI_MIN, RSSI_MAX);
+  MU_Logf("EMA Alpha: %.2f\n", EMA_ALPHA);
 }
 
 void setup() {
   Serial.begin(115200);
-  delay(1000);
-  
-  Serial.println("\n=== WiFi Gradient Viewer ===");
-  Serial.printf("Target SSID: %s\n", TARGET_SSID);
-  Serial.printf("RSSI Range: %d to %d dBm\n", RSSI_MIN, RSSI_MAX);
-  Serial.printf("EMA Alpha: %.2f\n", EMA_ALPHA);
+  MU_TelemetryBegin();  // loop() logging below is queued, never blocks on USB-CDC
   
   // Initialize LED Matrix
-  FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, NUM_LEDS);
-  FastLED.setBrightness(BRIGHTNESS);
-  FastLED.clear();
-  FastLED.show();
-  
-  // Initialize WiFi
-  WiFi.mode(WIFI_STA);
-  WiFi.disconnect(true, true);
-  delay(100);
-  
-  Serial.println("WiFi initialized in STA mode");
+  MU_ADD_LEDS(LED_PIN, leds, NUM_LEDS);
+  MU_SetBrightness(BRIGHTNESS_LIMIT);
+  fill_solid(leds, NUM_LEDS, CRGB::Black);
+  MU_ShowLeds(leds, NUM_LEDS);
+  // Bright frames are scaled to POWER_BUDGET_MA at MU_Brightness (before the output task starts)
+  MU_PowerConfig power;
+#if HEATMAP_MODE
+  power.temperatureC = MU_ImuTemperatureC;  // QMI8658 die temperature, read by the sensor task
+#endif
+  MU_PowerBegin(power);
+  MU_RenderBegin(MU_ShowLeds);
   
   // Show initialization pattern
   fillMatrix(0, 0, 100);  // Blue startup
-  delay(500);
+  Render();
+  MU_Present();
+  MU_BootFrame();
+  
+  MU_BootStart("serial", MU_BootSerial, MU_BOOT_SERIAL_MS);
+  MU_BootDefer(printBanner);
+#if HEATMAP_MODE
+  // One heatmap cell per step; heading/steps are computed in the IMU sensor task
+  MU_NavBegin();
+  int8_t imu = MU_BootStart("imu", startImu, IMU_BOOT_MS);
+  MU_BootDefer(MU_ImuDump, imu);  // register dump (IMU_DEBUG) once the IMU stage has finished
+#endif
+  wifiStage = MU_BootStart("wifi", startWifi, WIFI_BOOT_MS);
+
+  MU_IdleConfig idle;
+  idle.idleAfterMs = IDLE_AFTER_MS;
+  idle.enter = enterIdle;
+  idle.leave = leaveIdle;
+  idle.autoSleep = true;
+  MU_IdleBegin(idle);
+
+  // Scans block for hundreds of ms, so never run missed steps back-to-back
+  MU_SchedBegin(SCAN_INTERVAL_MS * 1000UL, TrackerStep, (uint32_t)FRAME_RATE_MS * 1000, Render, MU_Present);
+  MU_SchedSetCatchUp(1);
 }
 
 void loop() {
+  MU_SchedRun();  // sleeps until the next update or frame is due
+}
+
+// Update step: one pass of the state machine every SCAN_INTERVAL_MS
+void TrackerStep() {
+  MU_BootPoll();
+  unsigned long now = millis();
+#if HEATMAP_MODE
+  MU_ImuLoop();  // only does I2C itself when the sensor task is unavailable
+  if (MU_ImuMotion()) MU_IdleActivity();  // picked up while idle
+  updatePosition();
+#endif
+  if (!wifiReady(now)) {  // the IMU, position and idle keep running without the radio
+    MU_IdleUpdate();
+    return;
+  }
+  if (currentState != STATE_LOCKED) MU_IdleActivity();
   switch (currentState) {
     case STATE_DISCOVERY:
-      showStatusColor();
-      
-      if (performDiscoveryScan()) {
-        currentState = STATE_LOCKED;
-        lostCounter = 0;
-      } else {
-        // Stay in discovery, will retry
-        delay(1000);
-      }
-      break;
-      
     case STATE_SCANNING:
-      showStatusColor();
+      showStatusColor();  // keeps blinking while the scan runs in the background
       
-      // Try to find network again
-      if (performDiscoveryScan()) {
+      if (discoveryStep(now)) {
         currentState = STATE_LOCKED;
-        lostCounter = 0;
+        MU_FxStop();
+        startSniffer();
       }
       break;
       
     case STATE_LOCKED:
       {
-        int rssi = scanForTarget();
+        if (sniffing) {
+          drainSniffer(now);
+        } else {
+          scanTrackedAps(now);
+        }
+        
+        int shown = activeAp;
+        int samples = aps[shown].pending;
+        commitSamples();
         
-        if (rssi == -127) {
-          // Target lost
-          lostCounter++;
-          if (lostCounter > 3) {
-            Serial.println("Network lost!");
-            currentState = STATE_LOST;
-            lostCounter = 0;
+        if (!updateHandoff(now)) {
+          // Every tracked AP went quiet
+          MU_Log("Network lost!\n");
+          stopSniffer();  // discovery scans need the radio back
+          buildScanPlan(aps[activeAp].channel);
+          forgetAps();    // Rediscover with fresh filters
+          currentState = STATE_LOST;
+          lostTime = now;
+          break;
+        }
+        
+        if (samples > 0) {
+          const TrackedAp& ap = aps[shown];
+          if (fabsf(ap.ema - idleRssi) > IDLE_RSSI_DB) {
+            idleRssi = ap.ema;
+            MU_IdleActivity();
           }
-        } else {
-          lostCounter = 0;
-          
-          // Apply smoothing
-          float smoothed = smoothRSSI(rssi);
           
           // Convert to color
           uint8_t r, g, b;
-          rssiToColor(smoothed, &r, &g, &b);
+          rssiToColor(ap.ema, &r, &g, &b);
           
           // Update display
           fillMatrix(r, g, b);
+#if HEATMAP_MODE
+          if (MU_ImuReady()) addHeatSample(ap.bssid, ap.median);  // spatial map: median, not the EMA
+#endif
           
-          Serial.printf("RSSI: %d dBm (smoothed: %.1f) -> RGB(%d,%d,%d)\n",
-                        rssi, smoothed, r, g, b);
+          MU_Logf("RSSI: %d dBm (smoothed: %.1f, %d samples, AP %d) -> RGB(%d,%d,%d)\n",
+                        ap.lastRSSI, ap.ema, samples, shown, r, g, b);
         }
       }
       break;
       
     case STATE_LOST:
       showStatusColor();
-      delay(200);  // Brief gray flash
+      // Reacquire scans already run during the gray flash
+      if (discoveryStep(now)) {
+        currentState = STATE_LOCKED;
+        MU_FxStop();
+        startSniffer();
+        break;
+      }
+      if (now - lostTime < LOST_FLASH_MS) break;  // Brief gray flash
       currentState = STATE_SCANNING;
-      firstReading = true;  // Reset EMA for next lock
-      bufferIndex = 0;      // Reset median filter
-      bufferFull = false;
       break;
   }
-  
-  delay(SCAN_INTERVAL_MS);
+  MU_IdleUpdate();
 }
\ No newline at end of file
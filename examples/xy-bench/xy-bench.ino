@@ -0,0 +1,67 @@
+// xy-bench — compares the old branchy XY mapping against the compile-time table.
+// Prints one BENCH line per second with CPU cycles per full-frame pass (64 pixels on 8x8).
+// Compile with the repo root on the include path (see CLAUDE.md).
+
+#include <FastLED.h>
+#include "config/BoardConfig.h"
+#include "lib/MatrixUtil/MatrixUtil.h"
+
+#define BENCH_FRAMES 1000
+
+CRGB leds[NUM_LEDS];
+
+// Bounds read through volatiles so the compiler cannot fold the loops away
+volatile uint8_t benchW = MATRIX_WIDTH;
+volatile uint8_t benchH = MATRIX_HEIGHT;
+
+__attribute__((noinline)) void frameBranchy(CRGB c) {
+  uint8_t w = benchW, h = benchH;
+  for (uint8_t y = 0; y < h; ++y)
+    for (uint8_t x = 0; x < w; ++x)
+      leds[MU_XYCompute(x, y)] = c;
+}
+
+__attribute__((noinline)) void frameTable(CRGB c) {
+  uint8_t w = benchW, h = benchH;
+  for (uint8_t y = 0; y < h; ++y)
+    for (uint8_t x = 0; x < w; ++x)
+      leds[MU_XY(x, y)] = c;
+}
+
+__attribute__((noinline)) void frameTableLinear(CRGB c) {
+  uint16_t n = (uint16_t)benchW * benchH;
+  for (uint16_t i = 0; i < n; ++i)
+    leds[MU_XYIndex(i)] = c;
+}
+
+uint32_t cyclesPerFrame(void (*frame)(CRGB)) {
+  uint32_t t0 = ESP.getCycleCount();
+  for (uint16_t f = 0; f < BENCH_FRAMES; ++f) frame(CRGB(f & 0xFF, 0, 0));
+  return (ESP.getCycleCount() - t0) / BENCH_FRAMES;
+}
+
+// Every logical pixel must land on the same LED through both paths
+uint16_t countMismatches() {
+  uint16_t bad = 0;
+  for (uint8_t y = 0; y < MATRIX_HEIGHT; ++y)
+    for (uint8_t x = 0; x < MATRIX_WIDTH; ++x)
+      if (MU_XYCompute(x, y) != MU_XY(x, y) || MU_LedToXY(MU_XY(x, y)) != y * MATRIX_WIDTH + x) ++bad;
+  return bad;
+}
+
+void setup() {
+  Serial.begin(115200);
+  unsigned long t0 = millis();
+  while (!Serial && millis() - t0 < 1500) { delay(10); }
+  if (Serial) MU_PrintMeta();
+}
+
+void loop() {
+  uint32_t branchy = cyclesPerFrame(frameBranchy);
+  uint32_t table   = cyclesPerFrame(frameTable);
+  uint32_t linear  = cyclesPerFrame(frameTableLinear);
+  Serial.printf("BENCH: pixels=%d branchy=%lu table=%lu table_linear=%lu cyc/frame speedup=%.2fx mismatches=%u\n",
+                NUM_LEDS, (unsigned long)branchy, (unsigned long)table, (unsigned long)linear,
+                table ? (float)branchy / table : 0.0f, countMismatches());
+  delay(1000);
+}
@@ -0,0 +1,205 @@
+// MatrixBits.h - Packed 1-bpp bitmaps (one uint64_t per 8x8 tile) and their palette expansion to CRGB
+// Usage: include after MatrixUtil.h. Keep a monochrome layer or an occupancy map in an MU_Bitmap
+// (the matrix size) instead of a byte per cell: 8x less memory and whole-board operations take a
+// few word ops (one per tile), e.g. collision is `a.intersects(b)`. Draw it with MU_BitsExpand().
+// Provides:
+//  - MU_Bits<W, H>: get/set/clear/toggle/put(x, y), clearAll/fillAll, count/any, |= &= ^= andNot,
+//    intersects, == ; out-of-range cells read as clear and writes to them are ignored.
+//  - shift(dx, dy): move the image, uncovered cells clear (as MU_GfxScroll).
+//  - rotate(dx, dy): scroll with wrap-around.
+//  - MU_Bitmap: MU_Bits<MATRIX_WIDTH, MATRIX_HEIGHT>.
+//  - MU_BitsExpand(frame, bits, palette): one pass, palette[bit] per pixel; with two bitmaps
+//    (lo, hi) palette[lo | hi << 1], four colors.
+// Layout: tiles row-major, tile (tx, ty) covers x tx*8..tx*8+7 and y ty*8..ty*8+7; bit (y & 7) * 8 +
+// (x & 7), so each byte is one tile row. An 8x8 board is a single word with bit y * 8 + x (the
+// cell order SnakeCore's occupancy bitmap uses). Cells past W/H in edge tiles stay clear.
+
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <string.h>
+#include "MatrixGfx.h"
+
+// Byte b in every tile row
+static constexpr uint64_t MU_BitsRows(uint8_t b) {
+  return b * 0x0101010101010101ULL;
+}
+
+template <int W, int H>
+struct MU_Bits {
+  static_assert(W > 0 && H > 0, "MU_Bits needs a non-empty canvas");
+  static constexpr int TX = (W + 7) / 8;
+  static constexpr int TY = (H + 7) / 8;
+  static constexpr int kTiles = TX * TY;
+
+  uint64_t tile[kTiles] = {};
+
+  bool get(int16_t x, int16_t y) const {
+    if ((uint16_t)x >= W || (uint16_t)y >= H) return false;
+    return (tile[index(x, y)] >> bit(x, y)) & 1;
+  }
+  void set(int16_t x, int16_t y) {
+    if ((uint16_t)x < W && (uint16_t)y < H) tile[index(x, y)] |= 1ULL << bit(x, y);
+  }
+  void clear(int16_t x, int16_t y) {
+    if ((uint16_t)x < W && (uint16_t)y < H) tile[index(x, y)] &= ~(1ULL << bit(x, y));
+  }
+  void toggle(int16_t x, int16_t y) {
+    if ((uint16_t)x < W && (uint16_t)y < H) tile[index(x, y)] ^= 1ULL << bit(x, y);
+  }
+  void put(int16_t x, int16_t y, bool on) {
+    if (on) set(x, y);
+    else clear(x, y);
+  }
+
+  void clearAll() { memset(tile, 0, sizeof(tile)); }
+  void fillAll() {
+    for (int i = 0; i < kTiles; ++i) tile[i] = edgeMask(i);
+  }
+
+  uint16_t count() const {
+    uint16_t n = 0;
+    for (int i = 0; i < kTiles; ++i) n += (uint16_t)__builtin_popcountll(tile[i]);
+    return n;
+  }
+  bool any() const {
+    for (int i = 0; i < kTiles; ++i)
+      if (tile[i]) return true;
+    return false;
+  }
+  bool intersects(const MU_Bits& o) const {
+    for (int i = 0; i < kTiles; ++i)
+      if (tile[i] & o.tile[i]) return true;
+    return false;
+  }
+
+  MU_Bits& operator|=(const MU_Bits& o) {
+    for (int i = 0; i < kTiles; ++i) tile[i] |= o.tile[i];
+    return *this;
+  }
+  MU_Bits& operator&=(const MU_Bits& o) {
+    for (int i = 0; i < kTiles; ++i) tile[i] &= o.tile[i];
+    return *this;
+  }
+  MU_Bits& operator^=(const MU_Bits& o) {
+    for (int i = 0; i < kTiles; ++i) tile[i] ^= o.tile[i];
+    return *this;
+  }
+  MU_Bits& andNot(const MU_Bits& o) {
+    for (int i = 0; i < kTiles; ++i) tile[i] &= ~o.tile[i];
+    return *this;
+  }
+  bool operator==(const MU_Bits& o) const { return memcmp(tile, o.tile, sizeof(tile)) == 0; }
+  bool operator!=(const MU_Bits& o) const { return !(*this == o); }
+
+  // Cell (x, y) moves to (x + dx, y + dy); cells shifted off the canvas are lost
+  void shift(int16_t dx, int16_t dy) {
+    uint64_t t[kTiles];
+    if (dx) {
+      shiftX(tile, t, dx);
+      memcpy(tile, t, sizeof(tile));
+    }
+    if (dy) {
+      shiftY(tile, t, dy);
+      memcpy(tile, t, sizeof(tile));
+    }
+  }
+
+  // As shift(), but cells leaving one edge come back at the opposite one
+  void rotate(int16_t dx, int16_t dy) {
+    dx %= W;
+    if (dx < 0) dx += W;
+    dy %= H;
+    if (dy < 0) dy += H;
+    uint64_t a[kTiles], b[kTiles];
+    if (dx) {
+      shiftX(tile, a, dx);
+      shiftX(tile, b, dx - W);
+      for (int i = 0; i < kTiles; ++i) tile[i] = a[i] | b[i];
+    }
+    if (dy) {
+      shiftY(tile, a, dy);
+      shiftY(tile, b, dy - H);
+      for (int i = 0; i < kTiles; ++i) tile[i] = a[i] | b[i];
+    }
+  }
+
+  // Row y of tile column tx, bit n = x tx*8+n
+  uint8_t rowByte(int tx, int16_t y) const { return (uint8_t)(tile[(y >> 3) * TX + tx] >> ((y & 7) * 8)); }
+
+ private:
+  static int index(int16_t x, int16_t y) { return (y >> 3) * TX + (x >> 3); }
+  static int bit(int16_t x, int16_t y) { return (y & 7) * 8 + (x & 7); }
+
+  // Cells of tile i inside the canvas
+  static constexpr uint64_t edgeMask(int i) {
+    int cols = W - (i % TX) * 8, rows = H - (i / TX) * 8;
+    uint64_t m = MU_BitsRows(cols >= 8 ? 0xFF : (uint8_t)((1u << cols) - 1));
+    return rows >= 8 ? m : m & ((1ULL << (rows * 8)) - 1);
+  }
+
+  static int floorDiv8(int v) { return v >= 0 ? v / 8 : -((7 - v) / 8); }
+
+  // Whole tiles by q = floor(d / 8), then r = d - 8q bits with the carry from the neighbour tile
+  static void shiftX(const uint64_t* in, uint64_t* out, int dx) {
+    int q = floorDiv8(dx), r = dx - q * 8;
+    uint64_t keep = MU_BitsRows((uint8_t)(0xFF << r)), carry = MU_BitsRows((uint8_t)((1u << r) - 1));
+    for (int ty = 0; ty < TY; ++ty) {
+      for (int tx = 0; tx < TX; ++tx) {
+        int sx = tx - q;
+        uint64_t a = (sx >= 0 && sx < TX) ? in[ty * TX + sx] : 0;
+        uint64_t v = a;
+        if (r) {
+          uint64_t b = (sx - 1 >= 0 && sx - 1 < TX) ? in[ty * TX + sx - 1] : 0;
+          v = ((a << r) & keep) | ((b >> (8 - r)) & carry);
+        }
+        out[ty * TX + tx] = v & edgeMask(ty * TX + tx);
+      }
+    }
+  }
+
+  static void shiftY(const uint64_t* in, uint64_t* out, int dy) {
+    int q = floorDiv8(dy), r = dy - q * 8;
+    for (int ty = 0; ty < TY; ++ty) {
+      int sy = ty - q;
+      for (int tx = 0; tx < TX; ++tx) {
+        uint64_t a = (sy >= 0 && sy < TY) ? in[sy * TX + tx] : 0;
+        uint64_t v = a;
+        if (r) {
+          uint64_t b = (sy - 1 >= 0 && sy - 1 < TY) ? in[(sy - 1) * TX + tx] : 0;
+          v = (a << (8 * r)) | (b >> (64 - 8 * r));
+        }
+        out[ty * TX + tx] = v & edgeMask(ty * TX + tx);
+      }
+    }
+  }
+};
+
+using MU_Bitmap = MU_Bits<MATRIX_WIDTH, MATRIX_HEIGHT>;
+
+// Every pixel of the matrix from its bit: palette[0] clear, palette[1] set
+static inline void MU_BitsExpand(CRGB* frame, const MU_Bitmap& bits, const CRGB* palette) {
+  for (int16_t y = 0; y < MATRIX_HEIGHT; ++y) {
+    const uint16_t* row = &MU_XY_TABLES.fwd[y * MATRIX_WIDTH];
+    for (int tx = 0; tx < MU_Bitmap::TX; ++tx) {
+      uint8_t b = bits.rowByte(tx, y);
+      int16_t x0 = tx * 8, n = min(8, MATRIX_WIDTH - x0);
+      for (int16_t i = 0; i < n; ++i, b >>= 1) frame[row[x0 + i]] = palette[b & 1];
+    }
+    MU_GfxMark(frame, 0, MATRIX_WIDTH - 1, y);
+  }
+}
+
+// Two layers, four colors: palette[lo | hi << 1] (e.g. 0 empty, 1 body, 2 food, 3 head)
+static inline void MU_BitsExpand(CRGB* frame, const MU_Bitmap& lo, const MU_Bitmap& hi, const CRGB* palette) {
+  for (int16_t y = 0; y < MATRIX_HEIGHT; ++y) {
+    const uint16_t* row = &MU_XY_TABLES.fwd[y * MATRIX_WIDTH];
+    for (int tx = 0; tx < MU_Bitmap::TX; ++tx) {
+      uint8_t a = lo.rowByte(tx, y), b = hi.rowByte(tx, y);
+      int16_t x0 = tx * 8, n = min(8, MATRIX_WIDTH - x0);
+      for (int16_t i = 0; i < n; ++i, a >>= 1, b >>= 1) frame[row[x0 + i]] = palette[(a & 1) | ((b & 1) << 1)];
+    }
+    MU_GfxMark(frame, 0, MATRIX_WIDTH - 1, y);
+  }
+}
@@ -0,0 +1,193 @@
+// MatrixBoot.h - Staged startup: first frame at once, peripherals brought up side by side with timeouts
+// Usage: include after MatrixUtil.h. In setup(), show a first frame before anything slow and call
+// MU_BootFrame(); then start each slow bring-up as a stage and return:
+//   int8_t imu = MU_BootStart("imu", startImu, 300);   // bool startImu() { return MU_ImuBegin(...); }
+// Each stage runs on its own task (pinned to the caller's core, so e.g. MU_ImuBegin still puts the
+// sensor task on the other one) and the sketch carries on. Before using a peripheral it checks
+// MU_BootOk(id); MU_BootSettled(id) says when to stop waiting for it and go on without it (degraded
+// mode). A late stage may still finish later, and MU_BootOk() then turns true.
+// Call MU_BootPoll() from loop()/update(): once every stage has settled it prints one line
+//   BOOT:frame=<ms>,<stage>=ok|fail|late/<ms>,...,ready=<ms>     (ms since reset)
+// and runs the MU_BootDefer() callbacks (diagnostics such as register dumps), after the first frame.
+// A callback tied to a stage (MU_BootDefer(fn, id)) waits for that stage to finish, ok or failed,
+// even past its timeout, so keep calling MU_BootPoll(): a late stage's callback runs when it lands.
+// Host builds have no tasks: stages run inline in MU_BootStart().
+// Provides:
+//  - MU_BootFrame(): time of the first frame.
+//  - MU_BootStart(name, fn, timeoutMs): stage id (-1 with a full table; fn has then run inline).
+//  - MU_BootOk(id) / MU_BootSettled(id) / MU_BootWait(id): done and succeeded / done, failed or past
+//    its timeout / block until settled, returns MU_BootOk.
+//  - MU_BootSerial: stage fn waiting up to MU_BOOT_SERIAL_MS for the USB host to open the port.
+//  - MU_BootDefer(fn, stage), MU_BootPoll().
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdio.h>
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#ifndef MU_BOOT_MAX_STAGES
+#define MU_BOOT_MAX_STAGES 4
+#endif
+#ifndef MU_BOOT_MAX_DEFERRED
+#define MU_BOOT_MAX_DEFERRED 4
+#endif
+#ifndef MU_BOOT_TASK_STACK
+#define MU_BOOT_TASK_STACK 6144   // Wi-Fi bring-up runs on it
+#endif
+#ifndef MU_BOOT_TASK_PRIO
+#define MU_BOOT_TASK_PRIO 1
+#endif
+#ifndef MU_BOOT_SERIAL_MS
+#define MU_BOOT_SERIAL_MS 1500    // MU_BootSerial: give up on the USB host after this long
+#endif
+
+enum : uint8_t {
+  MU_BOOT_PENDING,
+  MU_BOOT_OK,
+  MU_BOOT_FAILED,
+};
+
+struct MU_BootStage {
+  const char* name;
+  bool (*fn)();
+  uint32_t startMs;
+  uint32_t timeoutMs;
+  uint32_t doneMs;                    // written before state leaves PENDING
+  std::atomic<uint8_t> state{MU_BOOT_PENDING};
+};
+
+struct MU_BootDeferred {
+  void (*fn)();
+  int8_t stage;                       // -1: runs with the BOOT: report
+};
+
+struct MU_BootState {
+  MU_BootStage stages[MU_BOOT_MAX_STAGES];
+  uint8_t count = 0;
+  uint32_t frameMs = 0;
+  bool framed = false;
+  bool reported = false;
+  MU_BootDeferred deferred[MU_BOOT_MAX_DEFERRED] = {};
+  uint8_t deferredCount = 0;
+};
+
+inline MU_BootState MU_Boot;
+
+static inline void MU_BootFrame() {
+  if (MU_Boot.framed) return;
+  MU_Boot.framed = true;
+  MU_Boot.frameMs = millis();
+}
+
+static inline void MU_BootRun(MU_BootStage& s) {
+  bool ok = s.fn();
+  s.doneMs = millis();
+  s.state.store(ok ? MU_BOOT_OK : MU_BOOT_FAILED, std::memory_order_release);
+}
+
+#if defined(ESP32)
+static void MU_BootTask(void* arg) {
+  MU_BootRun(*(MU_BootStage*)arg);
+  vTaskDelete(nullptr);
+}
+#endif
+
+// Start stage fn; it counts as late once timeoutMs have passed without it finishing
+static inline int8_t MU_BootStart(const char* name, bool (*fn)(), uint32_t timeoutMs) {
+  if (MU_Boot.count >= MU_BOOT_MAX_STAGES) {
+    fn();
+    return -1;
+  }
+  uint8_t id = MU_Boot.count++;
+  MU_BootStage& s = MU_Boot.stages[id];
+  s.name = name;
+  s.fn = fn;
+  s.startMs = millis();
+  s.timeoutMs = timeoutMs;
+#if defined(ESP32)
+  if (xTaskCreatePinnedToCore(MU_BootTask, name, MU_BOOT_TASK_STACK, &s, MU_BOOT_TASK_PRIO, nullptr,
+                              xPortGetCoreID()) == pdPASS)
+    return (int8_t)id;
+#endif
+  MU_BootRun(s);
+  return (int8_t)id;
+}
+
+static inline bool MU_BootOk(int8_t id) {
+  return id >= 0 && MU_Boot.stages[id].state.load(std::memory_order_acquire) == MU_BOOT_OK;
+}
+
+static inline bool MU_BootSettled(int8_t id) {
+  if (id < 0) return true;
+  const MU_BootStage& s = MU_Boot.stages[id];
+  return s.state.load(std::memory_order_acquire) != MU_BOOT_PENDING || millis() - s.startMs >= s.timeoutMs;
+}
+
+static inline bool MU_BootWait(int8_t id) {
+  while (!MU_BootSettled(id)) delay(1);
+  return MU_BootOk(id);
+}
+
+static inline bool MU_BootSerial() {
+  uint32_t t0 = millis();
+  while (!Serial && millis() - t0 < MU_BOOT_SERIAL_MS) delay(10);
+  return (bool)Serial;
+}
+
+static inline bool MU_BootDone(int8_t id) {
+  return id < 0 || MU_Boot.stages[id].state.load(std::memory_order_acquire) != MU_BOOT_PENDING;
+}
+
+// Run fn once after the BOOT: report and, with a stage id, once that stage has finished (ok or
+// failed); false with the table full (fn will not run)
+static inline bool MU_BootDefer(void (*fn)(), int8_t stage = -1) {
+  if (MU_Boot.reported && MU_BootDone(stage)) {
+    fn();
+    return true;
+  }
+  if (MU_Boot.deferredCount >= MU_BOOT_MAX_DEFERRED) return false;
+  MU_Boot.deferred[MU_Boot.deferredCount++] = { fn, stage };
+  return true;
+}
+
+// Deferred callbacks whose stage has finished, in the order they were added; the rest stay queued
+static inline void MU_BootRunDeferred() {
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < MU_Boot.deferredCount; ++i) {
+    MU_BootDeferred d = MU_Boot.deferred[i];
+    if (MU_BootDone(d.stage)) d.fn();
+    else MU_Boot.deferred[kept++] = d;
+  }
+  MU_Boot.deferredCount = kept;
+}
+
+// True once every stage has settled; the first such call prints BOOT:. Runs the deferred callbacks
+// that are due, so call it for as long as one may still be waiting on a late stage.
+static inline bool MU_BootPoll() {
+  if (MU_Boot.reported) {
+    if (MU_Boot.deferredCount) MU_BootRunDeferred();
+    return true;
+  }
+  for (uint8_t i = 0; i < MU_Boot.count; ++i)
+    if (!MU_BootSettled((int8_t)i)) return false;
+  MU_Boot.reported = true;
+  char buf[192];
+  int n = snprintf(buf, sizeof(buf), "BOOT:frame=%lu", (unsigned long)MU_Boot.frameMs);
+  for (uint8_t i = 0; i < MU_Boot.count && n > 0 && (size_t)n < sizeof(buf); ++i) {
+    const MU_BootStage& s = MU_Boot.stages[i];
+    uint8_t st = s.state.load(std::memory_order_acquire);
+    const char* what = st == MU_BOOT_OK ? "ok" : st == MU_BOOT_FAILED ? "fail" : "late";
+    uint32_t at = st == MU_BOOT_PENDING ? s.startMs + s.timeoutMs : s.doneMs;
+    n += snprintf(buf + n, sizeof(buf) - n, ",%s=%s/%lu", s.name, what, (unsigned long)at);
+  }
+  if (n > 0 && (size_t)n < sizeof(buf))
+    n += snprintf(buf + n, sizeof(buf) - n, ",ready=%lu\r\n", (unsigned long)millis());
+  if (n > 0) MU_SerialWrite((const uint8_t*)buf, (size_t)min(n, (int)sizeof(buf) - 1));
+  MU_BootRunDeferred();
+  return true;
+}
@@ -0,0 +1,151 @@
+// MatrixCanvas.h - Tiled canvas: several chained panels drawn as one MATRIX_WIDTH x MATRIX_HEIGHT matrix
+// Usage: included by MatrixUtil.h. For a multi-panel wall set MATRIX_WIDTH/HEIGHT in the board profile to
+// the whole canvas and list the panels in MATRIX_TILES; each MU_TILE has its own canvas offset, size,
+// rotation, flips, wiring and output chain (data pin). MU_XY() and MU_XY_TABLES then cover the whole
+// canvas, so sketches, the render pipeline and the frame stream work unchanged. Without MATRIX_TILES the
+// PANEL_* macros describe a single tile on chain 0, exactly as before.
+//   #define MATRIX_WIDTH 32
+//   #define MATRIX_HEIGHT 8
+//   #define MATRIX_TILES { MU_TILE(0, 0, 8, 8, 0, 0, 0, 1, 0), MU_TILE(8, 0, 8, 8, 0, 0, 0, 1, 0), [...]
+//                          MU_TILE(16, 0, 8, 8, 0, 0, 0, 1, 1), MU_TILE(24, 0, 8, 8, 0, 0, 0, 1, 1) }
+//   (one line, or continue it with backslashes)
+//   #define MATRIX_CHAIN_PINS { 14, 15 }
+// Provides:
+//  - MU_TILE(x, y, w, h, rotation, flipX, flipY, serpentine, chain) / MU_Tile: one panel.
+//  - MU_TileCompute(tile, lx, ly): LED index inside the panel (same rules as the single-panel mapping).
+//  - MU_CanvasCompute(tiles, x, y): physical LED index on the canvas; chains are stored back to back in
+//    chain order, panels within a chain in list order (the order the data line runs through them).
+//  - MU_CHAINS: per-chain first LED and LED count; MU_CHAIN_PINS: data pin per chain.
+//  - MU_FrameAlloc(bytes): zeroed frame memory, in PSRAM when MU_FB_PSRAM (large canvases on boards
+//    built with -DBOARD_HAS_PSRAM), else internal RAM.
+// Output: MU_ADD_LEDS / MU_ShowLeds (MatrixUtil.h) drive every chain; FastLED and the RMT backend both
+// transmit the chains in parallel, so a 32x32 wall on four pins refreshes like 256 LEDs, not 1024.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+#ifndef MU_CANVAS_MAX_CHAINS
+#define MU_CANVAS_MAX_CHAINS 8
+#endif
+
+#ifndef MU_FB_PSRAM
+#if defined(ESP32) && defined(BOARD_HAS_PSRAM) && MU_NUM_LEDS >= 256
+#define MU_FB_PSRAM 1   // render frames in PSRAM: small panels stay in faster internal RAM
+#else
+#define MU_FB_PSRAM 0
+#endif
+#endif
+
+struct MU_Tile {
+  uint8_t x, y;          // top-left canvas pixel
+  uint8_t w, h;          // size on the canvas
+  uint16_t rotation;     // 0 / 90 / 180 / 270, clockwise (90/270 need w == h)
+  bool flipX, flipY;
+  bool serpentine;
+  uint8_t chain;         // output chain / data pin index
+};
+
+#define MU_TILE(x, y, w, h, rot, flipX, flipY, serp, chain) \
+  MU_Tile{ (uint8_t)(x), (uint8_t)(y), (uint8_t)(w), (uint8_t)(h), (uint16_t)(rot), (bool)(flipX), \
+           (bool)(flipY), (bool)(serp), (uint8_t)(chain) }
+
+// Index inside one panel: rotation, then flips, then wiring
+static constexpr uint16_t MU_TileCompute(const MU_Tile& t, uint8_t x, uint8_t y) {
+  uint8_t w = t.w, h = t.h;
+  if (t.rotation == 90) {
+    uint8_t rx = w - 1 - y;
+    y = x;
+    x = rx;
+  } else if (t.rotation == 180) {
+    x = w - 1 - x;
+    y = h - 1 - y;
+  } else if (t.rotation == 270) {
+    uint8_t rx = y;
+    y = h - 1 - x;
+    x = rx;
+  }
+  if (t.flipX) x = w - 1 - x;
+  if (t.flipY) y = h - 1 - y;
+  if (t.serpentine && (y & 1)) return y * w + (w - 1 - x);
+  return y * w + x;
+}
+
+struct MU_ChainTable {
+  uint8_t n;
+  uint16_t start[MU_CANVAS_MAX_CHAINS];
+  uint16_t count[MU_CANVAS_MAX_CHAINS];
+};
+
+template <size_t N>
+static constexpr MU_ChainTable MU_BuildChains(const MU_Tile (&tiles)[N]) {
+  MU_ChainTable c{};
+  for (size_t i = 0; i < N; ++i) {
+    if (tiles[i].chain >= MU_CANVAS_MAX_CHAINS) continue;  // rejected by MU_CanvasValid
+    if (tiles[i].chain + 1 > c.n) c.n = tiles[i].chain + 1;
+    c.count[tiles[i].chain] += tiles[i].w * tiles[i].h;
+  }
+  for (uint8_t k = 1; k < c.n; ++k) c.start[k] = c.start[k - 1] + c.count[k - 1];
+  return c;
+}
+
+// Physical index of canvas pixel (x, y); 0xFFFF when no tile covers it
+template <size_t N>
+static constexpr uint16_t MU_CanvasCompute(const MU_Tile (&tiles)[N], uint8_t x, uint8_t y) {
+  MU_ChainTable c = MU_BuildChains(tiles);
+  for (size_t i = 0; i < N; ++i) {
+    const MU_Tile& t = tiles[i];
+    if (x < t.x || y < t.y || x >= t.x + t.w || y >= t.y + t.h) continue;
+    uint16_t base = c.start[t.chain];
+    for (size_t j = 0; j < i; ++j)
+      if (tiles[j].chain == t.chain) base += tiles[j].w * tiles[j].h;
+    return base + MU_TileCompute(t, x - t.x, y - t.y);
+  }
+  return 0xFFFF;
+}
+
+// Every tile inside the canvas, rotations legal, chains in range
+template <size_t N>
+static constexpr bool MU_CanvasValid(const MU_Tile (&tiles)[N], uint16_t width, uint16_t height) {
+  for (size_t i = 0; i < N; ++i) {
+    const MU_Tile& t = tiles[i];
+    if (t.w == 0 || t.h == 0 || t.x + t.w > width || t.y + t.h > height) return false;
+    if (t.rotation != 0 && t.rotation != 90 && t.rotation != 180 && t.rotation != 270) return false;
+    if ((t.rotation == 90 || t.rotation == 270) && t.w != t.h) return false;
+    if (t.chain >= MU_CANVAS_MAX_CHAINS) return false;
+  }
+  return true;
+}
+
+#ifdef MATRIX_TILES
+inline constexpr MU_Tile MU_TILES[] = MATRIX_TILES;
+#else
+inline constexpr MU_Tile MU_TILES[] = { MU_TILE(0, 0, MATRIX_WIDTH, MATRIX_HEIGHT, PANEL_ROTATION, PANEL_FLIP_X,
+                                                PANEL_FLIP_Y, PANEL_WIRING_SERPENTINE, 0) };
+#endif
+static_assert(MU_CanvasValid(MU_TILES, MATRIX_WIDTH, MATRIX_HEIGHT), "MATRIX_TILES: tile outside the canvas, bad rotation or chain");
+
+inline constexpr MU_ChainTable MU_CHAINS = MU_BuildChains(MU_TILES);
+
+#ifdef MATRIX_CHAIN_PINS
+inline constexpr uint8_t MU_CHAIN_PINS[] = MATRIX_CHAIN_PINS;
+static_assert(sizeof(MU_CHAIN_PINS) >= MU_CHAINS.n, "MATRIX_CHAIN_PINS needs one pin per chain");
+#else
+static_assert(MU_CHAINS.n == 1, "Tiles on more than one chain need MATRIX_CHAIN_PINS");
+#endif
+
+static inline void* MU_FrameAlloc(size_t bytes) {
+  void* p = nullptr;
+#if MU_FB_PSRAM
+  p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#endif
+  if (!p) p = malloc(bytes);  // no PSRAM fitted (or full): internal RAM
+  if (p) memset(p, 0, bytes);
+  return p;
+}
@@ -0,0 +1,157 @@
+// MatrixFx.h - Time-based full-matrix effects (flash, fade, wipe, blink) without delay()
+// Usage: include after MatrixRender.h and MatrixSched.h. Start an effect anywhere (MU_FxFlash(...)
+// in a game step, for example) and call MU_FxRender() first thing in the render callback: while an
+// effect plays it draws the frame for the current time and returns true (skip the normal drawing),
+// afterwards it returns false. Game logic, IMU reads, telemetry and scans keep running meanwhile.
+// An effect is a list of keyframes: each key holds a color from its time on, or ramps linearly to
+// it from the previous key (ramp = true). The last key's time is the duration; looping effects
+// wrap around it, others end there and leave the last color in the back buffer.
+// Provides:
+//  - MU_FxFlash(color, times, onMs, offMs, offColor): `times` on/off pulses.
+//  - MU_FxFade(from, to, ms) / MU_FxWipe(color, ms): ramp the whole matrix / fill column by column.
+//  - MU_FxBlink(a, b, periodMs): alternate two colors until MU_FxStop().
+//  - MU_FxBegin(mode) + MU_FxKey(atMs, color, ramp) + MU_FxStart(loop): custom keyframes.
+//  - MU_FxRender(nowUs): draw the current frame; MU_FxActive() / MU_FxStop().
+// Pixels are written straight into MU_BackBuffer(); when the sketch uses dirty marks (MU_SetPixel)
+// only the pixels that change are marked, so a held color costs no LED or serial traffic.
+
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "MatrixRender.h"
+#include "MatrixSched.h"
+
+#ifndef MU_FX_MAX_KEYS
+#define MU_FX_MAX_KEYS 16
+#endif
+
+#define MU_FX_FILL 0   // whole matrix shows the keyframe color
+#define MU_FX_WIPE 1   // columns fill left to right over the duration
+
+struct MU_FxKeyframe {
+  uint32_t atMs;
+  CRGB color;
+  bool ramp;            // interpolate from the previous key instead of switching at atMs
+};
+
+struct MU_FxState {
+  MU_FxKeyframe keys[MU_FX_MAX_KEYS];
+  uint8_t count = 0;
+  uint8_t mode = MU_FX_FILL;
+  bool loop = false;
+  bool active = false;
+  int64_t startUs = 0;
+};
+
+inline MU_FxState MU_Fx;
+
+static inline void MU_FxBegin(uint8_t mode = MU_FX_FILL) {
+  MU_Fx.active = false;
+  MU_Fx.count = 0;
+  MU_Fx.mode = mode;
+}
+
+// Keys must come in time order; extra keys past MU_FX_MAX_KEYS are dropped
+static inline void MU_FxKey(uint32_t atMs, const CRGB& color, bool ramp = false) {
+  if (MU_Fx.count < MU_FX_MAX_KEYS) MU_Fx.keys[MU_Fx.count++] = { atMs, color, ramp };
+}
+
+static inline void MU_FxStart(bool loop = false, int64_t nowUs = MU_NowUs()) {
+  MU_Fx.loop = loop && MU_Fx.count > 1 && MU_Fx.keys[MU_Fx.count - 1].atMs > 0;
+  MU_Fx.startUs = nowUs;
+  MU_Fx.active = MU_Fx.count > 0;
+}
+
+static inline void MU_FxStop() {
+  MU_Fx.active = false;
+}
+
+static inline bool MU_FxActive() {
+  return MU_Fx.active;
+}
+
+static inline void MU_FxFlash(const CRGB& color, uint8_t times, uint32_t onMs, uint32_t offMs,
+                              const CRGB& offColor = CRGB(0, 0, 0)) {
+  MU_FxBegin();
+  uint32_t t = 0;
+  for (uint8_t i = 0; i < times; ++i) {
+    MU_FxKey(t, color);
+    MU_FxKey(t + onMs, offColor);
+    t += onMs + offMs;
+  }
+  MU_FxKey(t, offColor);
+  MU_FxStart();
+}
+
+static inline void MU_FxFade(const CRGB& from, const CRGB& to, uint32_t ms) {
+  MU_FxBegin();
+  MU_FxKey(0, from);
+  MU_FxKey(ms, to, true);
+  MU_FxStart();
+}
+
+static inline void MU_FxWipe(const CRGB& color, uint32_t ms) {
+  MU_FxBegin(MU_FX_WIPE);
+  MU_FxKey(0, color);
+  MU_FxKey(ms, color);
+  MU_FxStart();
+}
+
+static inline void MU_FxBlink(const CRGB& a, const CRGB& b, uint32_t periodMs) {
+  MU_FxBegin();
+  MU_FxKey(0, a);
+  MU_FxKey(periodMs / 2, b);
+  MU_FxKey(periodMs, a);
+  MU_FxStart(true);
+}
+
+static inline CRGB MU_FxLerp(const CRGB& a, const CRGB& b, uint32_t num, uint32_t den) {
+  if (!den) return b;
+  return CRGB((uint8_t)(a.r + ((int32_t)b.r - a.r) * (int32_t)num / (int32_t)den),
+              (uint8_t)(a.g + ((int32_t)b.g - a.g) * (int32_t)num / (int32_t)den),
+              (uint8_t)(a.b + ((int32_t)b.b - a.b) * (int32_t)num / (int32_t)den));
+}
+
+static inline void MU_FxPut(CRGB* frame, uint8_t x, uint8_t y, const CRGB& c) {
+  CRGB& px = frame[MU_XY(x, y)];
+  if (px == c) return;
+  px = c;
+  if (MU_Render.dirtyTracking) MU_MarkDirty(x, y);
+}
+
+// Draw the effect for nowUs into the back buffer; false once no effect is playing
+static inline bool MU_FxRender(int64_t nowUs = MU_NowUs()) {
+  if (!MU_Fx.active) return false;
+  const MU_FxKeyframe* k = MU_Fx.keys;
+  uint8_t n = MU_Fx.count;
+  uint32_t durMs = k[n - 1].atMs;
+  uint32_t t = (uint32_t)((nowUs - MU_Fx.startUs) / 1000);
+  bool last = false;
+  if (t >= durMs) {
+    if (MU_Fx.loop) {
+      t %= durMs;
+    } else {
+      t = durMs;
+      last = true;  // draw the final key once, then stop
+    }
+  }
+
+  CRGB color = k[n - 1].color;
+  if (!last) {
+    uint8_t i = 0;
+    while (i + 1 < n && k[i + 1].atMs <= t) ++i;
+    color = k[i].color;
+    if (i + 1 < n && k[i + 1].ramp) color = MU_FxLerp(k[i].color, k[i + 1].color, t - k[i].atMs,
+                                                       k[i + 1].atMs - k[i].atMs);
+  }
+
+  CRGB* frame = MU_BackBuffer();
+  uint8_t cols = MATRIX_WIDTH;
+  if (MU_Fx.mode == MU_FX_WIPE && durMs) cols = (uint8_t)((t * MATRIX_WIDTH + durMs - 1) / durMs);
+  for (uint8_t y = 0; y < MATRIX_HEIGHT; ++y) {
+    for (uint8_t x = 0; x < cols; ++x) MU_FxPut(frame, x, y, color);
+  }
+  if (last) MU_Fx.active = false;
+  return true;
+}
@@ -0,0 +1,247 @@
+// MatrixGfx.h - Clipped 2D drawing, sprite blits, scrolling and a 3x5 font on the XY table
+// Usage: include after MatrixUtil.h (and after MatrixRender.h to get dirty marks). Every call takes the
+// frame to draw into (physical order, usually MU_BackBuffer()) and logical coordinates that may lie
+// partly or fully off the matrix; everything is clipped once per call, then the inner loops walk one
+// row of MU_XY_TABLES.fwd and store pixels - no per-pixel MU_XY() call, clamp or bounds check.
+// Provides:
+//  - MU_GfxFill(frame, c) / MU_GfxPixel(frame, x, y, c)
+//  - MU_GfxHSpan(frame, x0, x1, y, c) / MU_GfxVSpan(frame, x, y0, y1, c): inclusive spans.
+//  - MU_GfxFillRect(frame, x, y, w, h, c) / MU_GfxRect(...): filled / outlined rectangle.
+//  - MU_GfxLine(frame, x0, y0, x1, y1, c): Bresenham; horizontal and vertical lines become spans.
+//  - MU_GfxBlit1(frame, x, y, sprite, fg, bg, opaque): 1-bpp PROGMEM sprite, clear bits transparent
+//    unless opaque (then drawn in bg).
+//  - MU_GfxBlit565(frame, x, y, sprite): RGB565 PROGMEM sprite, `key` color (if set) transparent.
+//  - MU_GfxScroll(frame, dx, dy, fill): shift the image in place, uncovered pixels get `fill`.
+//  - MU_GfxChar / MU_GfxText / MU_GfxTextWidth: 3x5 font (ASCII 32..90, lowercase drawn as
+//    uppercase), 4 px advance.
+// When MatrixRender.h is included and the sketch uses dirty marks, drawing into MU_BackBuffer() marks
+// the touched span(s) instead of each pixel.
+
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#ifndef pgm_read_byte
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#endif
+#ifndef pgm_read_word
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#endif
+
+// 1-bpp sprite: rows top to bottom, each padded to whole bytes, MSB = leftmost pixel
+struct MU_Sprite1 {
+  uint8_t w, h;
+  const uint8_t* bits;        // PROGMEM
+};
+
+// RGB565 sprite, row-major; pixels equal to key are skipped when hasKey
+struct MU_Sprite565 {
+  uint8_t w, h;
+  const uint16_t* px;         // PROGMEM
+  bool hasKey;
+  uint16_t key;
+};
+
+#define MU_RGB565(r, g, b) (uint16_t)((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | ((b) >> 3))
+
+static inline CRGB MU_From565(uint16_t v) {
+  uint8_t r = (v >> 11) & 0x1F, g = (v >> 5) & 0x3F, b = v & 0x1F;
+  return CRGB((uint8_t)((r << 3) | (r >> 2)), (uint8_t)((g << 2) | (g >> 4)), (uint8_t)((b << 3) | (b >> 2)));
+}
+
+// Dirty marks for the logical range [y*W + x0, y*W + x1] (contiguous bits)
+static inline void MU_GfxMark(CRGB* frame, int16_t x0, int16_t x1, int16_t y) {
+#ifdef MU_RENDER_FRESH
+  if (!MU_Render.dirtyTracking || frame != MU_BackBuffer()) return;
+  uint16_t i = (uint16_t)y * MATRIX_WIDTH + x0, end = (uint16_t)y * MATRIX_WIDTH + x1 + 1;
+  while (i < end) {
+    uint16_t w = i >> 5, b = i & 31;
+    uint16_t n = min((uint16_t)(32 - b), (uint16_t)(end - i));
+    MU_Render.dirty[w] |= (n == 32 ? 0xFFFFFFFFu : (((uint32_t)1 << n) - 1)) << b;
+    i += n;
+  }
+#else
+  (void)frame; (void)x0; (void)x1; (void)y;
+#endif
+}
+
+static inline void MU_GfxFill(CRGB* frame, const CRGB& c) {
+  for (uint16_t i = 0; i < MU_NUM_LEDS; ++i) frame[i] = c;
+  for (int16_t y = 0; y < MATRIX_HEIGHT; ++y) MU_GfxMark(frame, 0, MATRIX_WIDTH - 1, y);
+}
+
+static inline void MU_GfxPixel(CRGB* frame, int16_t x, int16_t y, const CRGB& c) {
+  if (x < 0 || y < 0 || x >= MATRIX_WIDTH || y >= MATRIX_HEIGHT) return;
+  frame[MU_XY_TABLES.fwd[y * MATRIX_WIDTH + x]] = c;
+  MU_GfxMark(frame, x, x, y);
+}
+
+static inline void MU_GfxHSpan(CRGB* frame, int16_t x0, int16_t x1, int16_t y, const CRGB& c) {
+  if (x0 > x1) { int16_t t = x0; x0 = x1; x1 = t; }
+  if (y < 0 || y >= MATRIX_HEIGHT || x1 < 0 || x0 >= MATRIX_WIDTH) return;
+  if (x0 < 0) x0 = 0;
+  if (x1 >= MATRIX_WIDTH) x1 = MATRIX_WIDTH - 1;
+  const uint16_t* row = &MU_XY_TABLES.fwd[y * MATRIX_WIDTH];
+  for (int16_t x = x0; x <= x1; ++x) frame[row[x]] = c;
+  MU_GfxMark(frame, x0, x1, y);
+}
+
+static inline void MU_GfxVSpan(CRGB* frame, int16_t x, int16_t y0, int16_t y1, const CRGB& c) {
+  if (y0 > y1) { int16_t t = y0; y0 = y1; y1 = t; }
+  if (x < 0 || x >= MATRIX_WIDTH || y1 < 0 || y0 >= MATRIX_HEIGHT) return;
+  if (y0 < 0) y0 = 0;
+  if (y1 >= MATRIX_HEIGHT) y1 = MATRIX_HEIGHT - 1;
+  const uint16_t* col = &MU_XY_TABLES.fwd[x];
+  for (int16_t y = y0; y <= y1; ++y) {
+    frame[col[y * MATRIX_WIDTH]] = c;
+    MU_GfxMark(frame, x, x, y);
+  }
+}
+
+static inline void MU_GfxFillRect(CRGB* frame, int16_t x, int16_t y, int16_t w, int16_t h, const CRGB& c) {
+  if (w <= 0 || h <= 0) return;
+  int16_t y1 = y + h - 1;
+  if (y < 0) y = 0;
+  if (y1 >= MATRIX_HEIGHT) y1 = MATRIX_HEIGHT - 1;
+  for (; y <= y1; ++y) MU_GfxHSpan(frame, x, x + w - 1, y, c);
+}
+
+static inline void MU_GfxRect(CRGB* frame, int16_t x, int16_t y, int16_t w, int16_t h, const CRGB& c) {
+  if (w <= 0 || h <= 0) return;
+  MU_GfxHSpan(frame, x, x + w - 1, y, c);
+  if (h > 1) MU_GfxHSpan(frame, x, x + w - 1, y + h - 1, c);
+  if (h > 2) {
+    MU_GfxVSpan(frame, x, y + 1, y + h - 2, c);
+    if (w > 1) MU_GfxVSpan(frame, x + w - 1, y + 1, y + h - 2, c);
+  }
+}
+
+static inline void MU_GfxLine(CRGB* frame, int16_t x0, int16_t y0, int16_t x1, int16_t y1, const CRGB& c) {
+  if (y0 == y1) { MU_GfxHSpan(frame, x0, x1, y0, c); return; }
+  if (x0 == x1) { MU_GfxVSpan(frame, x0, y0, y1, c); return; }
+  int16_t dx = abs(x1 - x0), dy = -abs(y1 - y0);
+  int16_t sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+  int16_t err = dx + dy;
+  for (;;) {
+    MU_GfxPixel(frame, x0, y0, c);
+    if (x0 == x1 && y0 == y1) break;
+    int16_t e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+// Visible part of a w x h box placed at (x, y): sprite columns [sx0, sx1), rows [sy0, sy1)
+struct MU_GfxClip {
+  int16_t sx0, sx1, sy0, sy1;
+};
+
+static inline bool MU_GfxClipBox(int16_t x, int16_t y, int16_t w, int16_t h, MU_GfxClip& c) {
+  c.sx0 = x < 0 ? -x : 0;
+  c.sy0 = y < 0 ? -y : 0;
+  c.sx1 = x + w > MATRIX_WIDTH ? MATRIX_WIDTH - x : w;
+  c.sy1 = y + h > MATRIX_HEIGHT ? MATRIX_HEIGHT - y : h;
+  return c.sx0 < c.sx1 && c.sy0 < c.sy1;
+}
+
+static inline void MU_GfxBlit1(CRGB* frame, int16_t x, int16_t y, const MU_Sprite1& s, const CRGB& fg,
+                               const CRGB& bg = CRGB(0, 0, 0), bool opaque = false) {
+  MU_GfxClip c;
+  if (!MU_GfxClipBox(x, y, s.w, s.h, c)) return;
+  uint8_t stride = (uint8_t)((s.w + 7) >> 3);
+  for (int16_t sy = c.sy0; sy < c.sy1; ++sy) {
+    const uint16_t* row = &MU_XY_TABLES.fwd[(y + sy) * MATRIX_WIDTH];
+    const uint8_t* bits = s.bits + sy * stride;
+    uint8_t byte = pgm_read_byte(bits + (c.sx0 >> 3));
+    for (int16_t sx = c.sx0; sx < c.sx1; ++sx) {
+      if ((sx & 7) == 0) byte = pgm_read_byte(bits + (sx >> 3));
+      if (byte & (0x80 >> (sx & 7))) frame[row[x + sx]] = fg;
+      else if (opaque) frame[row[x + sx]] = bg;
+    }
+    MU_GfxMark(frame, x + c.sx0, x + c.sx1 - 1, y + sy);
+  }
+}
+
+static inline void MU_GfxBlit565(CRGB* frame, int16_t x, int16_t y, const MU_Sprite565& s) {
+  MU_GfxClip c;
+  if (!MU_GfxClipBox(x, y, s.w, s.h, c)) return;
+  for (int16_t sy = c.sy0; sy < c.sy1; ++sy) {
+    const uint16_t* row = &MU_XY_TABLES.fwd[(y + sy) * MATRIX_WIDTH];
+    const uint16_t* px = s.px + sy * s.w;
+    for (int16_t sx = c.sx0; sx < c.sx1; ++sx) {
+      uint16_t v = pgm_read_word(px + sx);
+      if (s.hasKey && v == s.key) continue;
+      frame[row[x + sx]] = MU_From565(v);
+    }
+    MU_GfxMark(frame, x + c.sx0, x + c.sx1 - 1, y + sy);
+  }
+}
+
+// Rows and columns are walked away from the direction of travel, so every source pixel is read
+// before it is overwritten and no scratch frame is needed
+static inline void MU_GfxScroll(CRGB* frame, int16_t dx, int16_t dy, const CRGB& fill = CRGB(0, 0, 0)) {
+  if (dx >= MATRIX_WIDTH || -dx >= MATRIX_WIDTH || dy >= MATRIX_HEIGHT || -dy >= MATRIX_HEIGHT) {
+    MU_GfxFill(frame, fill);
+    return;
+  }
+  for (int16_t i = 0; i < MATRIX_HEIGHT; ++i) {
+    int16_t y = dy > 0 ? MATRIX_HEIGHT - 1 - i : i;
+    int16_t srcY = y - dy;
+    const uint16_t* dst = &MU_XY_TABLES.fwd[y * MATRIX_WIDTH];
+    if (srcY < 0 || srcY >= MATRIX_HEIGHT) {
+      for (int16_t x = 0; x < MATRIX_WIDTH; ++x) frame[dst[x]] = fill;
+      continue;
+    }
+    const uint16_t* src = &MU_XY_TABLES.fwd[srcY * MATRIX_WIDTH];
+    for (int16_t j = 0; j < MATRIX_WIDTH; ++j) {
+      int16_t x = dx > 0 ? MATRIX_WIDTH - 1 - j : j;
+      int16_t srcX = x - dx;
+      frame[dst[x]] = (srcX < 0 || srcX >= MATRIX_WIDTH) ? fill : frame[src[srcX]];
+    }
+  }
+  for (int16_t y = 0; y < MATRIX_HEIGHT; ++y) MU_GfxMark(frame, 0, MATRIX_WIDTH - 1, y);
+}
+
+// 3x5 glyphs for ASCII 32..90, 15 bits each: five 3-bit rows top to bottom, bit 2 = left column
+#define MU_FONT_W 3
+#define MU_FONT_H 5
+#define MU_FONT_ADVANCE 4
+
+inline const uint16_t MU_Font3x5[] PROGMEM = {
+  0x0000, 0x2482, 0x5A00, 0x5F7D, 0x3C9E, 0x52A5, 0x2AAB, 0x2400, 0x1491, 0x4494, 0x0AA8, 0x05D0,
+  0x0014, 0x01C0, 0x0002, 0x12A4, 0x7B6F, 0x2C97, 0x73E7, 0x72CF, 0x5BC9, 0x79CF, 0x79EF, 0x7292,
+  0x7BEF, 0x7BCF, 0x0410, 0x0414, 0x1511, 0x0E38, 0x4454, 0x7282, 0x7BE7, 0x2BED, 0x6BAE, 0x3923,
+  0x6B6E, 0x79A7, 0x79A4, 0x396B, 0x5BED, 0x7497, 0x126A, 0x5BAD, 0x4927, 0x5FED, 0x5FFD, 0x2B6A,
+  0x6BA4, 0x2B7B, 0x6BAD, 0x388E, 0x7492, 0x5B6F, 0x5B6A, 0x5BFD, 0x5AAD, 0x5A92, 0x72A7
+};
+
+// Draws one glyph (unknown characters as blanks); returns the advance
+static inline uint8_t MU_GfxChar(CRGB* frame, int16_t x, int16_t y, char ch, const CRGB& c) {
+  if (ch >= 'a' && ch <= 'z') ch = (char)(ch - 'a' + 'A');
+  if (ch < ' ' || ch > 'Z') return MU_FONT_ADVANCE;
+  uint16_t g = pgm_read_word(&MU_Font3x5[ch - ' ']);
+  MU_GfxClip cl;
+  if (!g || !MU_GfxClipBox(x, y, MU_FONT_W, MU_FONT_H, cl)) return MU_FONT_ADVANCE;
+  for (int16_t gy = cl.sy0; gy < cl.sy1; ++gy) {
+    uint8_t bits = (g >> (12 - 3 * gy)) & 7;
+    if (!bits) continue;
+    const uint16_t* row = &MU_XY_TABLES.fwd[(y + gy) * MATRIX_WIDTH];
+    for (int16_t gx = cl.sx0; gx < cl.sx1; ++gx)
+      if (bits & (4 >> gx)) frame[row[x + gx]] = c;
+    MU_GfxMark(frame, x + cl.sx0, x + cl.sx1 - 1, y + gy);
+  }
+  return MU_FONT_ADVANCE;
+}
+
+static inline int16_t MU_GfxTextWidth(const char* s) {
+  int16_t n = (int16_t)strlen(s);
+  return n ? n * MU_FONT_ADVANCE - 1 : 0;
+}
+
+// Returns the x after the last glyph, so callers can scroll text by decrementing x each frame
+static inline int16_t MU_GfxText(CRGB* frame, int16_t x, int16_t y, const char* s, const CRGB& c) {
+  for (; *s && x < MATRIX_WIDTH; ++s) x += MU_GfxChar(frame, x, y, *s, c);
+  while (*s++) x += MU_FONT_ADVANCE;
+  return x;
+}
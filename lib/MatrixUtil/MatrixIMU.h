@@ -0,0 +1,425 @@
+// MatrixIMU.h - QMI8658 FIFO batch reads for MatrixUtil sketches
+// Usage: bring the sensor up as usual (SensorQMI8658 begin/config/enable), then call
+// MU_ImuFifoBegin(Wire, QMI8658_L_SLAVE_ADDRESS) once. Each MU_ImuFifoRead() drains every sample
+// the sensor buffered since the last call in a few burst transactions, instead of one 12-byte
+// read per poll that drops the ~9 samples produced in between at 896.8 Hz.
+// Provides:
+//  - MU_ImuFifoBegin(wire, addr, watermark, size): stream-mode FIFO, sensors paused while configuring.
+//    With the gyroscope disabled (accelerometer-only) the FIFO holds 6-byte samples; gyro reads as 0.
+//  - MU_ImuFifoSetOdr(hz): sample period used for timestamps and the task's fallback wait.
+//  - MU_ImuFifoCount(): samples waiting in the FIFO.
+//  - MU_ImuFifoRead(out, max): burst-reads up to max samples into the caller's buffer, oldest first,
+//    each timestamped on the esp_timer/micros clock from its position in the batch.
+//  - MU_ImuAverage(samples, n, accelG, gyroDps): batch mean in g and deg/s.
+//  - MU_ImuTaskBegin(intPin, intLine): sensor task on the other core, woken by the FIFO watermark
+//    interrupt (or a timer when intPin < 0). It publishes the batch mean to a latest-state slot, so
+//    loop() reads MU_ImuLatest() without touching I2C; that slot is the interface. A consumer that
+//    needs every sample (e.g. MatrixTilt.h) adds a sample hook instead of queueing them.
+//  - MU_ImuService(): one read/publish pass (what the task runs; call it yourself without one).
+//  - MU_ImuPause(on): stop/restart the passes; returns once a running pass has finished, so the
+//    caller may reconfigure the sensor (e.g. MatrixQMI.h arming wake-on-motion before sleeping).
+//  - MU_ImuWaitFresh(ms): sleep the calling task until new data is published.
+//  - MU_ImuAddSampleHook(fn): per-sample callback (e.g. MatrixTilt.h and MatrixNav.h, side by side);
+//    up to MU_IMU_MAX_HOOKS, each run in the order added, where MU_ImuService runs.
+//  - MU_ImuTemperatureC(): die temperature, refreshed by MU_ImuService every MU_IMU_TEMP_PERIOD_MS;
+//    NAN until the first read. Any task may call it (e.g. the MatrixPower.h thermal derate).
+//  - MU_IMU_ACCEL_MEDIAN: per-axis running median over that many samples (MatrixMedian.h), applied
+//    to the accelerometer before samples are hooked/averaged; knocks and taps show up as
+//    single-sample spikes at this ODR. 0 disables it.
+// Raw counts assume the examples' ranges (4G, 64 dps); override MU_IMU_ACC_LSB_PER_G / MU_IMU_GYR_LSB_PER_DPS.
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "MatrixRing.h"
+#include "MatrixMedian.h"
+#if defined(ESP32)
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#ifndef MU_PROFILE_SCOPE
+#define MU_PROFILE_SCOPE(name) ((void)0)  // include MatrixUtil.h first to time the FIFO reads
+#endif
+
+#ifndef MU_IMU_ACC_LSB_PER_G
+#define MU_IMU_ACC_LSB_PER_G 8192     // ACC_RANGE_4G
+#endif
+#ifndef MU_IMU_GYR_LSB_PER_DPS
+#define MU_IMU_GYR_LSB_PER_DPS 512    // GYR_RANGE_64DPS
+#endif
+#ifndef MU_IMU_ODR_HZ
+#define MU_IMU_ODR_HZ 896.8f          // 6DOF mode runs at the gyro ODR
+#endif
+#ifndef MU_IMU_BURST_SAMPLES
+#define MU_IMU_BURST_SAMPLES 10       // 120 bytes per transaction, fits the 128-byte Wire buffer
+#endif
+#ifndef MU_IMU_BATCH_MAX
+#define MU_IMU_BATCH_MAX 64           // ~70 ms at 896.8 Hz, one full MU_QMI_FIFO_SIZE_64
+#endif
+#ifndef MU_IMU_MAX_HOOKS
+#define MU_IMU_MAX_HOOKS 4            // per-sample callbacks (tilt filter, step/heading, ...)
+#endif
+#ifndef MU_IMU_ACCEL_MEDIAN
+#define MU_IMU_ACCEL_MEDIAN 5         // ~5.6 ms window at 896.8 Hz, adds ~2.8 ms latency
+#endif
+#ifndef MU_IMU_TEMP_PERIOD_MS
+#define MU_IMU_TEMP_PERIOD_MS 1000    // one 2-byte read per second; 0 disables the temperature read
+#endif
+#ifndef MU_IMU_TASK_PRIO
+#define MU_IMU_TASK_PRIO 3            // above the render (2) and telemetry (1) tasks
+#endif
+#ifndef MU_IMU_TASK_STACK
+#define MU_IMU_TASK_STACK 3072
+#endif
+
+// QMI8658 registers used here (datasheet names)
+#define MU_QMI_CTRL1          0x02
+#define MU_QMI_CTRL7          0x08
+#define MU_QMI_CTRL9          0x0A
+#define MU_QMI_FIFO_WTM_TH    0x13
+#define MU_QMI_FIFO_CTRL      0x14
+#define MU_QMI_FIFO_SMPL_CNT  0x15
+#define MU_QMI_FIFO_STATUS    0x16
+#define MU_QMI_FIFO_DATA      0x17
+#define MU_QMI_STATUSINT      0x2D
+#define MU_QMI_TEMP_L         0x33       // TEMP_L/TEMP_H: int16, 1/256 degC
+
+#define MU_QMI_CTRL1_FIFO_INT_SEL 0x04   // FIFO interrupts on INT1 instead of INT2
+#define MU_QMI_CTRL1_INT1_EN      0x08
+#define MU_QMI_CTRL1_INT2_EN      0x10
+
+#define MU_QMI_CMD_ACK        0x00
+#define MU_QMI_CMD_RST_FIFO   0x04
+#define MU_QMI_CMD_REQ_FIFO   0x05
+
+#define MU_QMI_FIFO_MODE_STREAM 0x02
+#define MU_QMI_FIFO_RD_MODE     0x80
+#define MU_QMI_FIFO_SIZE_16     0x00
+#define MU_QMI_FIFO_SIZE_32     0x04
+#define MU_QMI_FIFO_SIZE_64     0x08
+#define MU_QMI_FIFO_SIZE_128    0x0C
+
+#define MU_IMU_SAMPLE_BYTES 12        // ax ay az gx gy gz, int16 little-endian
+#define MU_IMU_ACCEL_BYTES 6          // ax ay az only, accelerometer-only mode
+
+struct MU_ImuSample {
+  int64_t tUs;
+  int16_t ax, ay, az;
+  int16_t gx, gy, gz;
+};
+
+struct MU_ImuFifoState {
+  TwoWire* wire = nullptr;
+  uint8_t addr = 0;
+  uint8_t fifoCtrl = 0;
+  uint8_t watermark = 0;
+  uint8_t sampleBytes = MU_IMU_SAMPLE_BYTES;  // per FIFO sample, from the enabled sensors
+  uint32_t periodUs = (uint32_t)(1000000.0f / MU_IMU_ODR_HZ);
+  uint32_t reads = 0;           // I2C burst transactions issued
+  uint32_t samples = 0;         // samples delivered
+};
+
+inline MU_ImuFifoState MU_ImuFifo;
+
+static inline int64_t MU_ImuNowUs() {
+#if defined(ESP32)
+  return esp_timer_get_time();
+#else
+  return (int64_t)micros();
+#endif
+}
+
+static inline bool MU_QmiWrite(uint8_t reg, uint8_t val) {
+  TwoWire& w = *MU_ImuFifo.wire;
+  w.beginTransmission(MU_ImuFifo.addr);
+  w.write(reg);
+  w.write(val);
+  return w.endTransmission() == 0;
+}
+
+static inline bool MU_QmiRead(uint8_t reg, uint8_t* buf, uint8_t len) {
+  TwoWire& w = *MU_ImuFifo.wire;
+  w.beginTransmission(MU_ImuFifo.addr);
+  w.write(reg);
+  if (w.endTransmission(false) != 0) return false;
+  if (w.requestFrom(MU_ImuFifo.addr, len) != len) return false;
+  for (uint8_t i = 0; i < len; ++i) buf[i] = (uint8_t)w.read();
+  return true;
+}
+
+// CTRL9 handshake: command, wait for CmdDone, acknowledge, wait for it to clear
+static inline bool MU_QmiCommand(uint8_t cmd) {
+  if (!MU_QmiWrite(MU_QMI_CTRL9, cmd)) return false;
+  for (uint8_t phase = 0; phase < 2; ++phase) {
+    uint32_t t0 = millis();
+    uint8_t st = 0;
+    for (;;) {
+      if (!MU_QmiRead(MU_QMI_STATUSINT, &st, 1)) return false;
+      if (((st & 0x80) != 0) == (phase == 0)) break;
+      if (millis() - t0 > 10) return false;
+    }
+    if (phase == 0 && !MU_QmiWrite(MU_QMI_CTRL9, MU_QMI_CMD_ACK)) return false;
+  }
+  return true;
+}
+
+// Watermark is in samples; stream mode keeps the newest `size` samples if reads fall behind
+static inline bool MU_ImuFifoBegin(TwoWire& wire, uint8_t addr, uint8_t watermark = 8,
+                                   uint8_t size = MU_QMI_FIFO_SIZE_64) {
+  MU_ImuFifo.wire = &wire;
+  MU_ImuFifo.addr = addr;
+  MU_ImuFifo.fifoCtrl = (uint8_t)(size | MU_QMI_FIFO_MODE_STREAM);
+  MU_ImuFifo.watermark = watermark;
+  uint8_t ctrl7 = 0;
+  if (!MU_QmiRead(MU_QMI_CTRL7, &ctrl7, 1)) return false;
+  // FIFO settings only take effect while the sensors are disabled
+  bool ok = MU_QmiWrite(MU_QMI_CTRL7, 0) &&
+            MU_QmiWrite(MU_QMI_FIFO_WTM_TH, watermark) &&
+            MU_QmiWrite(MU_QMI_FIFO_CTRL, MU_ImuFifo.fifoCtrl) &&
+            MU_QmiCommand(MU_QMI_CMD_RST_FIFO);
+  ok = MU_QmiWrite(MU_QMI_CTRL7, ctrl7) && ok;
+  if (!ok) MU_ImuFifo.wire = nullptr;
+  // CTRL7 bit 1 = gyroscope enabled; without it the FIFO stores accelerometer data only
+  MU_ImuFifo.sampleBytes = (ctrl7 & 0x02) ? MU_IMU_SAMPLE_BYTES : MU_IMU_ACCEL_BYTES;
+  return ok;
+}
+
+static inline void MU_ImuFifoSetOdr(float hz) {
+  if (hz > 0) MU_ImuFifo.periodUs = (uint32_t)(1000000.0f / hz);
+}
+
+static inline uint16_t MU_ImuFifoCount() {
+  if (!MU_ImuFifo.wire) return 0;
+  uint8_t st[2];
+  if (!MU_QmiRead(MU_QMI_FIFO_SMPL_CNT, st, 2)) return 0;
+  // The counter is in 16-bit words; one 6-axis sample is six of them, an accelerometer-only one three
+  uint16_t words = (uint16_t)(((st[1] & 0x03) << 8) | st[0]);
+  return (uint16_t)(words * 2 / MU_ImuFifo.sampleBytes);
+}
+
+static inline int16_t MU_ImuLe16(const uint8_t* p) {
+  return (int16_t)(p[0] | (p[1] << 8));
+}
+
+// Returns the number of samples written to out (oldest first); 0 if none or on a bus error
+static inline uint16_t MU_ImuFifoRead(MU_ImuSample* out, uint16_t max) {
+  uint16_t n = MU_ImuFifoCount();
+  if (n > max) n = max;
+  if (n == 0) return 0;
+  MU_PROFILE_SCOPE("imu_i2c");
+  int64_t tRead = MU_ImuNowUs();
+  if (!MU_QmiCommand(MU_QMI_CMD_REQ_FIFO)) return 0;
+
+  uint8_t raw[MU_IMU_BURST_SAMPLES * MU_IMU_SAMPLE_BYTES];
+  const uint8_t bytes = MU_ImuFifo.sampleBytes;
+  const uint16_t perBurst = (uint16_t)(sizeof(raw) / bytes);  // twice the samples when accel-only
+  uint16_t got = 0;
+  while (got < n) {
+    uint8_t chunk = (uint8_t)min(perBurst, (uint16_t)(n - got));
+    if (!MU_QmiRead(MU_QMI_FIFO_DATA, raw, (uint8_t)(chunk * bytes))) break;
+    MU_ImuFifo.reads++;
+    for (uint8_t i = 0; i < chunk; ++i) {
+      const uint8_t* p = raw + i * bytes;
+      MU_ImuSample& s = out[got + i];
+      s.ax = MU_ImuLe16(p + 0);  s.ay = MU_ImuLe16(p + 2);  s.az = MU_ImuLe16(p + 4);
+      if (bytes == MU_IMU_SAMPLE_BYTES) {
+        s.gx = MU_ImuLe16(p + 6);  s.gy = MU_ImuLe16(p + 8);  s.gz = MU_ImuLe16(p + 10);
+      } else {
+        s.gx = s.gy = s.gz = 0;
+      }
+    }
+    got += chunk;
+  }
+  // Leave FIFO read mode (clears FIFO_RD_MODE, keeps size/mode)
+  MU_QmiWrite(MU_QMI_FIFO_CTRL, MU_ImuFifo.fifoCtrl);
+
+  // The newest sample is roughly "now"; earlier ones are one ODR period apart
+  for (uint16_t i = 0; i < got; ++i)
+    out[i].tUs = tRead - (int64_t)(got - 1 - i) * MU_ImuFifo.periodUs;
+  MU_ImuFifo.samples += got;
+  return got;
+}
+
+// Raw-count sample from SensorQMI8658-style float readings (g, deg/s), for the polling fallback
+static inline MU_ImuSample MU_ImuMakeSample(int64_t tUs, float ax, float ay, float az,
+                                             float gx, float gy, float gz) {
+  auto acc = [](float v) { return (int16_t)constrain(v * MU_IMU_ACC_LSB_PER_G, -32768.0f, 32767.0f); };
+  auto gyr = [](float v) { return (int16_t)constrain(v * MU_IMU_GYR_LSB_PER_DPS, -32768.0f, 32767.0f); };
+  return { tUs, acc(ax), acc(ay), acc(az), gyr(gx), gyr(gy), gyr(gz) };
+}
+
+static inline void MU_ImuAverage(const MU_ImuSample* s, uint16_t n, float accelG[3], float gyroDps[3]) {
+  if (n == 0) return;
+  int32_t sum[6] = { 0, 0, 0, 0, 0, 0 };
+  for (uint16_t i = 0; i < n; ++i) {
+    sum[0] += s[i].ax;  sum[1] += s[i].ay;  sum[2] += s[i].az;
+    sum[3] += s[i].gx;  sum[4] += s[i].gy;  sum[5] += s[i].gz;
+  }
+  for (uint8_t k = 0; k < 3; ++k) {
+    accelG[k]  = (float)sum[k]     / ((float)n * MU_IMU_ACC_LSB_PER_G);
+    gyroDps[k] = (float)sum[k + 3] / ((float)n * MU_IMU_GYR_LSB_PER_DPS);
+  }
+}
+
+// ---- Sensor task: FIFO reads off the game thread ----
+
+struct MU_ImuState {
+  int64_t tUs;        // timestamp of the newest sample in the batch
+  float accel[3];     // batch mean, g
+  float gyro[3];      // batch mean, deg/s
+  uint16_t samples;
+};
+
+typedef void (*MU_ImuHookFn)(const MU_ImuSample& s);
+inline MU_ImuHookFn MU_ImuSampleHooks[MU_IMU_MAX_HOOKS] = {};  // filled before MU_ImuTaskBegin
+inline uint8_t MU_ImuSampleHookCount = 0;
+inline MU_Latest<MU_ImuState> MU_ImuLatestState;
+inline MU_ImuSample MU_ImuBatch[MU_IMU_BATCH_MAX];
+inline std::atomic<int16_t> MU_ImuTempRaw{INT16_MIN};  // INT16_MIN = not read yet
+inline uint32_t MU_ImuTempLastMs = 0;
+inline std::atomic<bool> MU_ImuPaused{false};
+inline std::atomic<bool> MU_ImuBusy{false};            // a pass is reading the sensor
+#if MU_IMU_ACCEL_MEDIAN > 1
+inline MU_RunningMedian<int16_t, MU_IMU_ACCEL_MEDIAN> MU_ImuAccelMedian[3];
+#endif
+
+#if defined(ESP32)
+inline TaskHandle_t MU_ImuTaskHandle = nullptr;
+inline std::atomic<TaskHandle_t> MU_ImuWaiter{nullptr};
+inline int8_t MU_ImuIntPin = -1;
+#endif
+
+// Add a per-sample callback before MU_ImuTaskBegin (the task reads the list without a lock). Adding
+// the same one again is a no-op; false with the list full.
+static inline bool MU_ImuAddSampleHook(MU_ImuHookFn fn) {
+  for (uint8_t i = 0; i < MU_ImuSampleHookCount; ++i)
+    if (MU_ImuSampleHooks[i] == fn) return true;
+  if (MU_ImuSampleHookCount >= MU_IMU_MAX_HOOKS) return false;
+  MU_ImuSampleHooks[MU_ImuSampleHookCount++] = fn;
+  return true;
+}
+
+static inline void MU_ImuRunSampleHooks(const MU_ImuSample& s) {
+  for (uint8_t i = 0; i < MU_ImuSampleHookCount; ++i) MU_ImuSampleHooks[i](s);
+}
+
+// Newest published batch; false if nothing new since the last call
+static inline bool MU_ImuLatest(MU_ImuState& out) {
+  return MU_ImuLatestState.take(out);
+}
+
+static inline float MU_ImuTemperatureC() {
+  int16_t raw = MU_ImuTempRaw.load(std::memory_order_relaxed);
+  return raw == INT16_MIN ? NAN : raw / 256.0f;
+}
+
+static inline void MU_ImuReadTemperature() {
+#if MU_IMU_TEMP_PERIOD_MS > 0
+  uint32_t now = millis();
+  if (MU_ImuTempRaw.load(std::memory_order_relaxed) != INT16_MIN && now - MU_ImuTempLastMs < MU_IMU_TEMP_PERIOD_MS)
+    return;
+  MU_ImuTempLastMs = now;
+  uint8_t b[2];
+  if (MU_QmiRead(MU_QMI_TEMP_L, b, 2)) MU_ImuTempRaw.store((int16_t)(b[0] | (b[1] << 8)), std::memory_order_relaxed);
+#endif
+}
+
+// Drain the FIFO, hand each sample to the hook and publish the batch mean; returns the samples read
+static inline uint16_t MU_ImuServicePass() {
+  MU_ImuReadTemperature();
+  uint16_t n = MU_ImuFifoRead(MU_ImuBatch, MU_IMU_BATCH_MAX);
+  if (n == 0) return 0;
+  for (uint16_t i = 0; i < n; ++i) {
+#if MU_IMU_ACCEL_MEDIAN > 1
+    MU_ImuBatch[i].ax = MU_ImuAccelMedian[0].push(MU_ImuBatch[i].ax);
+    MU_ImuBatch[i].ay = MU_ImuAccelMedian[1].push(MU_ImuBatch[i].ay);
+    MU_ImuBatch[i].az = MU_ImuAccelMedian[2].push(MU_ImuBatch[i].az);
+#endif
+    MU_ImuRunSampleHooks(MU_ImuBatch[i]);
+  }
+  MU_ImuState st;
+  st.tUs = MU_ImuBatch[n - 1].tUs;
+  st.samples = n;
+  MU_ImuAverage(MU_ImuBatch, n, st.accel, st.gyro);
+  MU_ImuLatestState.publish(st);
+#if defined(ESP32)
+  TaskHandle_t waiter = MU_ImuWaiter.exchange(nullptr);
+  if (waiter) xTaskNotifyGive(waiter);
+#endif
+  return n;
+}
+
+static inline uint16_t MU_ImuService() {
+  // Busy before the pause check: MU_ImuPause() sets paused before waiting on busy, so one side always sees the other
+  MU_ImuBusy.store(true);
+  uint16_t n = MU_ImuPaused.load() ? 0 : MU_ImuServicePass();
+  MU_ImuBusy.store(false);
+  return n;
+}
+
+static inline void MU_ImuPause(bool on) {
+  MU_ImuPaused.store(on);
+  if (on)
+    while (MU_ImuBusy.load()) delay(1);
+}
+
+#if defined(ESP32)
+static void IRAM_ATTR MU_ImuIsr() {
+  BaseType_t woken = pdFALSE;
+  if (MU_ImuTaskHandle) vTaskNotifyGiveFromISR(MU_ImuTaskHandle, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+static void MU_ImuTask(void*) {
+  // One watermark's worth of samples; with an INT line this is only the missed-edge fallback
+  uint32_t batchMs = ((uint32_t)max(MU_ImuFifo.watermark, (uint8_t)1) * MU_ImuFifo.periodUs + 999) / 1000;
+  TickType_t wait = pdMS_TO_TICKS(MU_ImuIntPin >= 0 ? batchMs * 4 : batchMs);
+  if (wait == 0) wait = 1;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, wait);
+    MU_ImuService();
+  }
+}
+
+// Start the sensor task after MU_ImuFifoBegin(); intLine is the QMI8658 pin (1/2) wired to intPin
+static inline bool MU_ImuTaskBegin(int8_t intPin = -1, uint8_t intLine = 2) {
+  if (MU_ImuTaskHandle) return true;
+  if (!MU_ImuFifo.wire) return false;
+  MU_ImuIntPin = intPin;
+  if (intPin >= 0) {
+    // Route the FIFO watermark interrupt to the wired line
+    uint8_t ctrl1 = 0;
+    if (!MU_QmiRead(MU_QMI_CTRL1, &ctrl1, 1)) return false;
+    if (intLine == 1) ctrl1 |= MU_QMI_CTRL1_INT1_EN | MU_QMI_CTRL1_FIFO_INT_SEL;
+    else ctrl1 = (uint8_t)((ctrl1 | MU_QMI_CTRL1_INT2_EN) & ~MU_QMI_CTRL1_FIFO_INT_SEL);
+    if (!MU_QmiWrite(MU_QMI_CTRL1, ctrl1)) return false;
+  }
+  BaseType_t core = xPortGetCoreID() == 0 ? 1 : 0;
+  if (xTaskCreatePinnedToCore(MU_ImuTask, "mu_imu", MU_IMU_TASK_STACK, nullptr,
+                              MU_IMU_TASK_PRIO, &MU_ImuTaskHandle, core) != pdPASS) return false;
+  if (intPin >= 0) {
+    pinMode(intPin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(intPin), MU_ImuIsr, RISING);
+  }
+  return true;
+}
+
+// Block the calling task until the sensor task publishes (true) or timeoutMs passes (false)
+static inline bool MU_ImuWaitFresh(uint32_t timeoutMs) {
+  MU_ImuWaiter.store(xTaskGetCurrentTaskHandle());
+  return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs)) > 0;
+}
+#else
+// No RTOS (host builds): no task, the caller runs MU_ImuService() itself
+static inline bool MU_ImuTaskBegin(int8_t = -1, uint8_t = 2) {
+  return false;
+}
+
+static inline bool MU_ImuWaitFresh(uint32_t timeoutMs) {
+  delay(timeoutMs);
+  return false;
+}
+#endif
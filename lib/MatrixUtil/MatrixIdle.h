@@ -0,0 +1,180 @@
+// MatrixIdle.h - Idle detection and ESP32-S3 light sleep with the last frame latched on the LEDs
+// Usage: include after config/BoardConfig.h. MU_IdleBegin(cfg) once, then MU_IdleActivity() whenever
+// something changes (input, a new frame, a state change). After cfg.idleAfterMs without it the
+// sketch is idle:
+//  - loop()-driven sketches call MU_IdleSleep() where they used to delay(): while idle it sleeps one
+//    cfg.pollMs slice (light sleep; woken early by cfg.wakePin or Wi-Fi), runs cfg.poll() and
+//    returns true; otherwise it returns false at once and the sketch waits as before.
+//    Without a wake pin (cfg.wakePin unset or -1, e.g. IMU_INT_PIN -1) the poll is the only way to
+//    notice activity, so slices are cfg.polledMs instead: wake-up latency up to that plus the poll.
+//  - MatrixSched sketches call MU_IdleUpdate() from update(). With cfg.autoSleep, idle switches on
+//    automatic light sleep (esp_pm + tickless idle), so MU_SchedRun()'s waits sleep the chip.
+// cfg.enter() runs when the sketch goes idle (e.g. MU_ImuSleep: IMU to wake-on-motion) and
+// cfg.leave() on the first activity after it (e.g. MU_ImuResume).
+// WS2812s keep showing their last frame while the data line stays quiet, so the LED pin keeps its
+// awake configuration through light sleep instead of switching to the sleep (floating) one.
+// Sleeping needs `#define IDLE_SLEEP 1` in the board profile (MU_IDLE_SLEEP). At 0 (the default, a
+// USB-powered board whose serial link would drop during light sleep) and on host builds idle slices
+// are plain delays, so the idle logic and hooks still run.
+// Provides:
+//  - MU_IdleBegin(cfg), MU_IdleActivity(), MU_IdleUpdate() (true while idle), MU_IdleSleep().
+//  - MU_IdleStats(): light sleeps, time asleep, wake-ups by timer / GPIO / Wi-Fi.
+
+#pragma once
+
+#include <Arduino.h>
+#if defined(ESP32)
+#include <sdkconfig.h>
+#include <esp_idf_version.h>
+#include <esp_sleep.h>
+#include <esp_pm.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <soc/soc_caps.h>
+#endif
+
+#ifndef MU_IDLE_SLEEP
+#ifdef IDLE_SLEEP
+#define MU_IDLE_SLEEP IDLE_SLEEP      // from the board profile
+#else
+#define MU_IDLE_SLEEP 0
+#endif
+#endif
+
+#if defined(ESP32) && MU_IDLE_SLEEP && defined(CONFIG_PM_ENABLE) && defined(CONFIG_FREERTOS_USE_TICKLESS_IDLE)
+#define MU_IDLE_AUTO_SLEEP 1          // the core was built with automatic light sleep support
+#else
+#define MU_IDLE_AUTO_SLEEP 0
+#endif
+
+struct MU_IdleConfig {
+  uint32_t idleAfterMs = 3000;        // no MU_IdleActivity() this long -> idle
+  uint32_t pollMs = 100;              // MU_IdleSleep() slice: timer wake-up, then poll()
+  uint32_t polledMs = 20;             // slice when no wake pin can end it early (latency vs wake-ups)
+  bool (*enter)() = nullptr;          // going idle; false = stay awake (retried on the next call)
+  void (*leave)() = nullptr;          // first activity after enter()
+  bool (*poll)() = nullptr;           // after each slice: true counts as activity (e.g. MU_ImuMotionPoll)
+  bool (*ready)() = nullptr;          // false postpones a sleep (e.g. MU_RenderIdle: frame still going out)
+  int8_t (*wakePin)() = nullptr;      // GPIO that ends a sleep on any level change (e.g. MU_ImuWakePin)
+  bool wakeWifi = false;              // Wi-Fi events end a sleep (where the chip supports it)
+  bool autoSleep = false;             // idle enables automatic light sleep (MU_IdleUpdate sketches)
+  int8_t ledPin = LED_PIN;            // keeps its level through light sleep; -1 = none
+  uint16_t minMhz = 80;               // automatic light sleep: CPU clock while awake between sleeps
+};
+
+struct MU_IdleStatsData {
+  uint32_t sleeps;                    // light sleeps entered (MU_IdleSleep)
+  uint64_t sleptUs;
+  uint32_t wakeTimer;
+  uint32_t wakeGpio;
+  uint32_t wakeWifi;
+};
+
+struct MU_IdleState {
+  MU_IdleConfig cfg;
+  uint32_t lastActiveMs = 0;
+  bool idle = false;
+  bool entered = false;               // cfg.enter() succeeded for this idle period
+  MU_IdleStatsData stats = {};
+};
+
+inline MU_IdleState MU_Idle;
+
+static inline void MU_IdleAutoSleep(bool on) {
+#if MU_IDLE_AUTO_SLEEP
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_pm_config_t pm = {};
+#else
+  esp_pm_config_esp32s3_t pm = {};
+#endif
+  pm.max_freq_mhz = (int)getCpuFrequencyMhz();
+  pm.min_freq_mhz = on ? (int)MU_Idle.cfg.minMhz : pm.max_freq_mhz;
+  pm.light_sleep_enable = on;
+  esp_pm_configure(&pm);
+#else
+  (void)on;
+#endif
+}
+
+static inline void MU_IdleBegin(const MU_IdleConfig& cfg = MU_IdleConfig()) {
+  MU_Idle.cfg = cfg;
+  MU_Idle.lastActiveMs = millis();
+  MU_Idle.idle = false;
+  MU_Idle.entered = false;
+#if defined(ESP32) && MU_IDLE_SLEEP && SOC_GPIO_SUPPORT_SLP_SWITCH
+  // Without this the pin may switch to its sleep configuration and glitch the strip
+  if (cfg.ledPin >= 0) gpio_sleep_sel_dis((gpio_num_t)cfg.ledPin);
+#endif
+}
+
+// Something changed: stay (or come back) awake for another idleAfterMs
+static inline void MU_IdleActivity() {
+  MU_Idle.lastActiveMs = millis();
+  if (!MU_Idle.idle) return;
+  MU_Idle.idle = false;
+  if (MU_Idle.cfg.autoSleep) MU_IdleAutoSleep(false);
+  if (MU_Idle.entered && MU_Idle.cfg.leave) MU_Idle.cfg.leave();
+  MU_Idle.entered = false;
+}
+
+// Idle bookkeeping; true while idle
+static inline bool MU_IdleUpdate() {
+  if (!MU_Idle.idle && millis() - MU_Idle.lastActiveMs >= MU_Idle.cfg.idleAfterMs) MU_Idle.idle = true;
+  if (MU_Idle.idle && !MU_Idle.entered) {
+    MU_Idle.entered = !MU_Idle.cfg.enter || MU_Idle.cfg.enter();
+    if (!MU_Idle.entered) return false;
+    if (MU_Idle.cfg.autoSleep) MU_IdleAutoSleep(true);
+  }
+  return MU_Idle.idle;
+}
+
+// Light-sleep for up to ms with the timer, wake pin and Wi-Fi armed; plain delay without sleep support
+static inline void MU_IdleLightSleep(uint32_t ms) {
+#if defined(ESP32) && MU_IDLE_SLEEP
+  int8_t pin = MU_Idle.cfg.wakePin ? MU_Idle.cfg.wakePin() : -1;
+  esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+  if (pin >= 0) {
+    // The WoM output toggles per event: wake on the level it is not at now
+    gpio_wakeup_enable((gpio_num_t)pin, digitalRead(pin) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+  }
+#if SOC_PM_SUPPORT_WIFI_WAKEUP
+  if (MU_Idle.cfg.wakeWifi) esp_sleep_enable_wifi_wakeup();
+#endif
+  Serial.flush();
+  int64_t t0 = esp_timer_get_time();
+  esp_light_sleep_start();
+  MU_Idle.stats.sleptUs += (uint64_t)(esp_timer_get_time() - t0);
+  MU_Idle.stats.sleeps++;
+  switch (esp_sleep_get_wakeup_cause()) {
+    case ESP_SLEEP_WAKEUP_TIMER: MU_Idle.stats.wakeTimer++; break;
+    case ESP_SLEEP_WAKEUP_GPIO: MU_Idle.stats.wakeGpio++; break;
+    case ESP_SLEEP_WAKEUP_WIFI: MU_Idle.stats.wakeWifi++; break;
+    default: break;
+  }
+  if (pin >= 0) {
+    gpio_wakeup_disable((gpio_num_t)pin);
+    gpio_set_intr_type((gpio_num_t)pin, GPIO_INTR_ANYEDGE);  // back to the CHANGE interrupt MatrixQMI.h attached
+  }
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+#else
+  delay(ms);
+#endif
+}
+
+// While idle: sleep one slice, then poll for activity. False (at once) while awake.
+static inline bool MU_IdleSleep() {
+  if (!MU_IdleUpdate()) return false;
+  if (MU_Idle.cfg.ready && !MU_Idle.cfg.ready()) {
+    delay(1);
+    return true;
+  }
+  bool pinWake = MU_Idle.cfg.wakePin && MU_Idle.cfg.wakePin() >= 0;
+  MU_IdleLightSleep(pinWake ? MU_Idle.cfg.pollMs : MU_Idle.cfg.polledMs);
+  if (MU_Idle.cfg.poll && MU_Idle.cfg.poll()) MU_IdleActivity();
+  return true;
+}
+
+static inline MU_IdleStatsData MU_IdleStats() {
+  return MU_Idle.stats;
+}
@@ -0,0 +1,67 @@
+// MatrixMedian.h - Streaming sliding-window median
+// Usage: MU_RunningMedian<int16_t, 31> m; then v = m.push(sample) per sample.
+// The window is kept twice: in arrival order (a ring, to know what to evict) and sorted. push()
+// finds the evicted and the new value's positions by binary search and shifts only the elements
+// between them, so a step is O(log N) compares plus one memmove of at most N elements - no copy or
+// sort of the whole window per sample (the 5..63 sample windows used here are a few cache lines).
+// Provides:
+//  - push(v): add a sample (evicting the oldest once full), returns the new median.
+//  - median(): element at index size()/2 of the sorted window (upper median for even sizes).
+//  - size() / full() / clear().
+// Only depends on the C library, so host tools (tools/bench) can use it directly.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+template <class T, uint16_t N>
+class MU_RunningMedian {
+  static_assert(N >= 1, "MU_RunningMedian needs a window of at least one sample");
+
+ public:
+  T push(const T& v) {
+    uint16_t pos;
+    if (count_ < N) {
+      pos = lowerBound(v, count_);
+      memmove(&sorted_[pos + 1], &sorted_[pos], (count_ - pos) * sizeof(T));
+      ++count_;
+    } else {
+      // Replace the oldest value: close its gap and open one for v in a single shift
+      uint16_t old = lowerBound(ring_[head_], N);
+      pos = lowerBound(v, N);
+      if (pos > old) {
+        --pos;
+        memmove(&sorted_[old], &sorted_[old + 1], (pos - old) * sizeof(T));
+      } else if (pos < old) {
+        memmove(&sorted_[pos + 1], &sorted_[pos], (old - pos) * sizeof(T));
+      }
+    }
+    sorted_[pos] = v;
+    ring_[head_] = v;
+    head_ = (uint16_t)(head_ + 1 == N ? 0 : head_ + 1);
+    return sorted_[count_ / 2];
+  }
+
+  T median() const { return count_ ? sorted_[count_ / 2] : T(); }
+  uint16_t size() const { return count_; }
+  bool full() const { return count_ == N; }
+  void clear() { count_ = 0; head_ = 0; }
+
+ private:
+  // First index in sorted_[0, n) whose value is not less than v
+  uint16_t lowerBound(const T& v, uint16_t n) const {
+    uint16_t lo = 0, hi = n;
+    while (lo < hi) {
+      uint16_t mid = (uint16_t)((lo + hi) >> 1);
+      if (sorted_[mid] < v) lo = (uint16_t)(mid + 1);
+      else hi = mid;
+    }
+    return lo;
+  }
+
+  T ring_[N];
+  T sorted_[N];
+  uint16_t count_ = 0;
+  uint16_t head_ = 0;
+};
@@ -0,0 +1,108 @@
+// MatrixNav.h - Step counting and relative heading (pedestrian dead reckoning) from the IMU
+// Usage: include after MatrixIMU.h; call MU_NavBegin(cfg) before MU_ImuTaskBegin() so every FIFO
+// sample runs through MU_NavUpdate in the sensor task. There is no magnetometer, so heading is the
+// gyro rate about the measured "up" axis integrated from 0 at start (it drifts slowly; fine for a
+// walk of a few minutes). Each detected step moves the position one stepLen along the heading.
+// Provides:
+//  - MU_NavBegin(cfg): adds MU_NavUpdate to the IMU sample hooks (false with the list full) and
+//    resets position/heading.
+//  - MU_NavRead(state): newest heading, step count and position; false if nothing new.
+//  - MU_NavUpdate(sample): one step of the heading integrator and step detector.
+// Position uses display conventions: x right, y down, heading 0 = "up" (the direction faced at
+// MU_NavBegin), positive heading = turning left (counter-clockwise seen from above).
+// The examples run the gyro at 64 dps full scale; faster turns clip and under-count the heading.
+
+#pragma once
+
+#include <Arduino.h>
+#include <math.h>
+#include "MatrixIMU.h"
+#include "MatrixRing.h"
+
+struct MU_NavConfig {
+  int16_t stepOnMg = 150;       // |a| this far above the gravity baseline starts a step
+  int16_t stepOffMg = 40;       // ...and it must drop back below this before the next one
+  uint32_t minStepUs = 280000;  // faster than ~3.5 steps/s is bounce, not walking
+  uint32_t baseTauUs = 1000000; // gravity baseline (and "up" axis) time constant
+  float stepLen = 1.0f;         // distance per step in caller units (wifi-slam: heatmap cells)
+};
+
+struct MU_NavState {
+  int64_t tUs;
+  int32_t headingCd;            // 0..35999, centidegrees
+  uint32_t steps;
+  float x, y;
+};
+
+struct MU_NavFilter {
+  MU_NavConfig cfg;
+  float up[3] = { 0, 0, 0 };    // low-passed specific force (points away from the ground), raw LSB
+  float headingDeg = 0;
+  bool inStep = false;
+  int64_t lastStepUs = 0;
+  int64_t lastUs = 0;
+  bool primed = false;
+  MU_NavState st = {};
+};
+
+inline MU_NavFilter MU_Nav;
+inline MU_Latest<MU_NavState> MU_NavLatest;
+
+static inline void MU_NavUpdate(const MU_ImuSample& s) {
+  MU_NavFilter& n = MU_Nav;
+  float a[3] = { (float)s.ax, (float)s.ay, (float)s.az };
+  if (!n.primed) {
+    for (uint8_t i = 0; i < 3; ++i) n.up[i] = a[i];
+    n.lastUs = s.tUs;
+    n.primed = true;
+  }
+  int64_t dtUs = s.tUs - n.lastUs;
+  if (dtUs < 0 || dtUs > 50000) dtUs = 0;  // clock jump or long gap
+  n.lastUs = s.tUs;
+  float dt = dtUs * 1e-6f;
+
+  float k = dt / (n.cfg.baseTauUs * 1e-6f + dt);
+  for (uint8_t i = 0; i < 3; ++i) n.up[i] += (a[i] - n.up[i]) * k;
+  float upLen = sqrtf(n.up[0] * n.up[0] + n.up[1] * n.up[1] + n.up[2] * n.up[2]);
+  if (upLen < 1.0f) return;
+
+  // Yaw rate = gyro projected on the up axis, independent of how the board is mounted
+  float yawDps = (s.gx * n.up[0] + s.gy * n.up[1] + s.gz * n.up[2]) / (upLen * MU_IMU_GYR_LSB_PER_DPS);
+  n.headingDeg += yawDps * dt;
+  if (n.headingDeg >= 360.0f) n.headingDeg -= 360.0f;
+  if (n.headingDeg < 0.0f) n.headingDeg += 360.0f;
+
+  // Steps: peaks of |a| over the baseline magnitude, with hysteresis and a cadence limit
+  float mag = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+  float devMg = (mag - upLen) * 1000.0f / MU_IMU_ACC_LSB_PER_G;
+  bool moved = false;
+  if (!n.inStep && devMg > n.cfg.stepOnMg && s.tUs - n.lastStepUs >= (int64_t)n.cfg.minStepUs) {
+    n.inStep = true;
+    n.lastStepUs = s.tUs;
+    n.st.steps++;
+    float h = n.headingDeg * (float)(M_PI / 180.0);
+    n.st.x -= sinf(h) * n.cfg.stepLen;
+    n.st.y -= cosf(h) * n.cfg.stepLen;
+    moved = true;
+  } else if (n.inStep && devMg < n.cfg.stepOffMg) {
+    n.inStep = false;
+  }
+
+  int32_t cd = (int32_t)(n.headingDeg * 100.0f) % 36000;
+  // Publish on steps and whole-degree heading changes only; the consumer polls far slower than ODR
+  if (moved || cd / 100 != n.st.headingCd / 100) {
+    n.st.tUs = s.tUs;
+    n.st.headingCd = cd;
+    MU_NavLatest.publish(n.st);
+  }
+}
+
+static inline bool MU_NavBegin(const MU_NavConfig& cfg = MU_NavConfig()) {
+  MU_Nav = MU_NavFilter();
+  MU_Nav.cfg = cfg;
+  return MU_ImuAddSampleHook(MU_NavUpdate);
+}
+
+static inline bool MU_NavRead(MU_NavState& out) {
+  return MU_NavLatest.take(out);
+}
@@ -0,0 +1,253 @@
+// MatrixOutput.h - Asynchronous WS2812 output over the ESP32-S3 RMT peripheral
+// Selected from the board profile with `#define LED_BACKEND MU_BACKEND_RMT` (MatrixUtil.h includes
+// this header and routes MU_ADD_LEDS / MU_ShowLeds / MU_ShowNeoPixel here). Requires arduino-esp32 3.x
+// (ESP-IDF 5 RMT TX driver).
+// Provides:
+//  - MU_RmtBegin(pin, count): claims one RMT TX channel per data pin (up to MU_RMT_MAX_STRIPS;
+//    strips on different pins transmit in parallel). Returns the strip index or -1.
+//  - MU_RmtShow(frame, count, brightness, strip): converts to wire order into an idle staging buffer,
+//    waits only for the previous frame on that strip to finish, then starts the transfer and returns.
+//  - MU_RmtShowRaw(bytes, len, strip): same for data already in wire order (e.g. NeoPixel getPixels()).
+//  - MU_RmtWaitDone(timeoutMs, strip): blocks until the strip's last frame is on the LEDs.
+//  - MU_RmtOnFrameDone(cb, arg): callback from the RMT ISR when a frame (incl. reset gap) completes.
+
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#if !defined(ESP32) || !__has_include(<driver/rmt_tx.h>)
+#error "LED_BACKEND MU_BACKEND_RMT needs arduino-esp32 3.x (ESP-IDF 5 RMT driver); use MU_BACKEND_LIB"
+#endif
+
+#include <driver/rmt_tx.h>
+#include <driver/rmt_encoder.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_heap_caps.h>
+#include <stddef.h>
+
+#ifndef MU_RMT_MAX_STRIPS
+#define MU_RMT_MAX_STRIPS 4            // ESP32-S3 has 4 RMT TX channels
+#endif
+#ifndef MU_RMT_RESOLUTION_HZ
+#define MU_RMT_RESOLUTION_HZ 10000000  // 0.1 us per tick
+#endif
+#ifndef MU_RMT_RESET_US
+#define MU_RMT_RESET_US 300            // latch gap; newer WS2812B parts need > 280 us
+#endif
+#ifndef MU_RMT_DMA
+#define MU_RMT_DMA 1                   // try a DMA-backed channel first (only one is available on S3)
+#endif
+#ifndef MU_RMT_TIMEOUT_MS
+#define MU_RMT_TIMEOUT_MS 50
+#endif
+
+// WS2812 bit timings in RMT ticks (T0H 0.4 us, T0L 0.85 us, T1H 0.8 us, T1L 0.45 us)
+#define MU_RMT_T0H (MU_RMT_RESOLUTION_HZ / 2500000)
+#define MU_RMT_T0L (MU_RMT_RESOLUTION_HZ * 85 / 100000000)
+#define MU_RMT_T1H (MU_RMT_RESOLUTION_HZ / 1250000)
+#define MU_RMT_T1L (MU_RMT_RESOLUTION_HZ * 45 / 100000000)
+
+// Pixel bytes followed by one low "reset" symbol, so back-to-back frames always latch
+struct MU_LedEncoder {
+  rmt_encoder_t base;  // must stay first: the driver hands us &base
+  rmt_encoder_handle_t bytes;
+  rmt_encoder_handle_t copy;
+  int state;
+  rmt_symbol_word_t reset;
+};
+
+static size_t MU_LedEncode(rmt_encoder_t* encoder, rmt_channel_handle_t channel,
+                           const void* data, size_t size, rmt_encode_state_t* ret_state) {
+  MU_LedEncoder* le = reinterpret_cast<MU_LedEncoder*>(encoder);
+  rmt_encode_state_t session = RMT_ENCODING_RESET;
+  int state = RMT_ENCODING_RESET;
+  size_t symbols = 0;
+  if (le->state == 0) {
+    symbols += le->bytes->encode(le->bytes, channel, data, size, &session);
+    if (session & RMT_ENCODING_COMPLETE) le->state = 1;
+    if (session & RMT_ENCODING_MEM_FULL) {
+      *ret_state = (rmt_encode_state_t)(state | RMT_ENCODING_MEM_FULL);
+      return symbols;  // resume here when the driver has room again
+    }
+  }
+  if (le->state == 1) {
+    symbols += le->copy->encode(le->copy, channel, &le->reset, sizeof(le->reset), &session);
+    if (session & RMT_ENCODING_COMPLETE) {
+      le->state = RMT_ENCODING_RESET;
+      state |= RMT_ENCODING_COMPLETE;
+    }
+    if (session & RMT_ENCODING_MEM_FULL) state |= RMT_ENCODING_MEM_FULL;
+  }
+  *ret_state = (rmt_encode_state_t)state;
+  return symbols;
+}
+
+static esp_err_t MU_LedEncoderReset(rmt_encoder_t* encoder) {
+  MU_LedEncoder* le = reinterpret_cast<MU_LedEncoder*>(encoder);
+  rmt_encoder_reset(le->bytes);
+  rmt_encoder_reset(le->copy);
+  le->state = RMT_ENCODING_RESET;
+  return ESP_OK;
+}
+
+static esp_err_t MU_LedEncoderDel(rmt_encoder_t* encoder) {
+  MU_LedEncoder* le = reinterpret_cast<MU_LedEncoder*>(encoder);
+  rmt_del_encoder(le->bytes);
+  rmt_del_encoder(le->copy);
+  free(le);
+  return ESP_OK;
+}
+
+static rmt_encoder_handle_t MU_NewLedEncoder() {
+  MU_LedEncoder* le = (MU_LedEncoder*)calloc(1, sizeof(MU_LedEncoder));
+  if (!le) return nullptr;
+  le->base.encode = MU_LedEncode;
+  le->base.reset = MU_LedEncoderReset;
+  le->base.del = MU_LedEncoderDel;
+
+  rmt_bytes_encoder_config_t bcfg = {};
+  bcfg.bit0.level0 = 1; bcfg.bit0.duration0 = MU_RMT_T0H;
+  bcfg.bit0.level1 = 0; bcfg.bit0.duration1 = MU_RMT_T0L;
+  bcfg.bit1.level0 = 1; bcfg.bit1.duration0 = MU_RMT_T1H;
+  bcfg.bit1.level1 = 0; bcfg.bit1.duration1 = MU_RMT_T1L;
+  bcfg.flags.msb_first = 1;
+  rmt_copy_encoder_config_t ccfg = {};
+  if (rmt_new_bytes_encoder(&bcfg, &le->bytes) != ESP_OK ||
+      rmt_new_copy_encoder(&ccfg, &le->copy) != ESP_OK) {
+    if (le->bytes) rmt_del_encoder(le->bytes);
+    free(le);
+    return nullptr;
+  }
+  uint32_t half = (uint32_t)MU_RMT_RESOLUTION_HZ / 1000000 * MU_RMT_RESET_US / 2;
+  le->reset.level0 = 0; le->reset.duration0 = half;
+  le->reset.level1 = 0; le->reset.duration1 = half;
+  return &le->base;
+}
+
+struct MU_RmtStrip {
+  rmt_channel_handle_t chan = nullptr;
+  rmt_encoder_handle_t enc = nullptr;
+  SemaphoreHandle_t done = nullptr;  // given by the ISR when the frame on the wire completes
+  uint8_t* staging[2] = { nullptr, nullptr };
+  uint16_t count = 0;
+  uint8_t cur = 0;                   // staging buffer last handed to the driver
+};
+
+inline MU_RmtStrip MU_RmtStrips[MU_RMT_MAX_STRIPS];
+inline uint8_t MU_RmtStripCount = 0;
+inline void (*MU_RmtDoneCb)(void* arg) = nullptr;
+inline void* MU_RmtDoneArg = nullptr;
+
+// Called from the RMT ISR; cb must be short and ISR-safe
+static inline void MU_RmtOnFrameDone(void (*cb)(void* arg), void* arg) {
+  MU_RmtDoneArg = arg;
+  MU_RmtDoneCb = cb;
+}
+
+static bool MU_RmtTxDone(rmt_channel_handle_t, const rmt_tx_done_event_data_t*, void* ctx) {
+  MU_RmtStrip* s = (MU_RmtStrip*)ctx;
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(s->done, &woken);
+  if (MU_RmtDoneCb) MU_RmtDoneCb(MU_RmtDoneArg);
+  return woken == pdTRUE;
+}
+
+// Undo a partial MU_RmtBegin and free the slot for the next attempt; an enabled channel must be
+// disabled before it can be deleted
+static inline int MU_RmtAbort(MU_RmtStrip& s, bool enabled) {
+  if (enabled) rmt_disable(s.chan);
+  if (s.chan) rmt_del_channel(s.chan);
+  if (s.enc) rmt_del_encoder(s.enc);
+  if (s.done) vSemaphoreDelete(s.done);
+  heap_caps_free(s.staging[0]);
+  heap_caps_free(s.staging[1]);
+  s = MU_RmtStrip();
+  return -1;
+}
+
+// Strip index, or -1 (nothing left claimed) if the channel, buffers or driver setup fail
+static inline int MU_RmtBegin(int pin, uint16_t count) {
+  if (MU_RmtStripCount >= MU_RMT_MAX_STRIPS) return -1;
+  MU_RmtStrip& s = MU_RmtStrips[MU_RmtStripCount];
+
+  rmt_tx_channel_config_t cfg = {};
+  cfg.gpio_num = (gpio_num_t)pin;
+  cfg.clk_src = RMT_CLK_SRC_DEFAULT;
+  cfg.resolution_hz = MU_RMT_RESOLUTION_HZ;
+  cfg.trans_queue_depth = 2;
+  esp_err_t err = ESP_FAIL;
+  #if MU_RMT_DMA
+    cfg.mem_block_symbols = 1024;
+    cfg.flags.with_dma = 1;
+    err = rmt_new_tx_channel(&cfg, &s.chan);
+  #endif
+  if (err != ESP_OK) {
+    cfg.mem_block_symbols = 48;      // one RMT memory block, refilled from the ISR
+    cfg.flags.with_dma = 0;
+    if (rmt_new_tx_channel(&cfg, &s.chan) != ESP_OK) return MU_RmtAbort(s, false);
+  }
+
+  s.enc = MU_NewLedEncoder();
+  s.done = xSemaphoreCreateBinary();
+  s.staging[0] = (uint8_t*)heap_caps_malloc((size_t)count * 3, MALLOC_CAP_DMA);
+  s.staging[1] = (uint8_t*)heap_caps_malloc((size_t)count * 3, MALLOC_CAP_DMA);
+  if (!s.enc || !s.done || !s.staging[0] || !s.staging[1]) return MU_RmtAbort(s, false);
+  s.count = count;
+
+  rmt_tx_event_callbacks_t cbs = {};
+  cbs.on_trans_done = MU_RmtTxDone;
+  if (rmt_tx_register_event_callbacks(s.chan, &cbs, &s) != ESP_OK) return MU_RmtAbort(s, false);
+  if (rmt_enable(s.chan) != ESP_OK) return MU_RmtAbort(s, false);
+  xSemaphoreGive(s.done);  // nothing on the wire yet
+  return MU_RmtStripCount++;
+}
+
+static inline bool MU_RmtWaitDone(uint32_t timeoutMs = MU_RMT_TIMEOUT_MS, uint8_t strip = 0) {
+  if (strip >= MU_RmtStripCount) return false;
+  MU_RmtStrip& s = MU_RmtStrips[strip];
+  if (xSemaphoreTake(s.done, pdMS_TO_TICKS(timeoutMs)) != pdTRUE) return false;
+  xSemaphoreGive(s.done);  // leave it signalled for the next show
+  return true;
+}
+
+// Hand buffer `idx` (already filled) to the driver once the previous transfer has finished
+static inline bool MU_RmtKick(MU_RmtStrip& s, uint8_t idx, size_t len) {
+  if (xSemaphoreTake(s.done, pdMS_TO_TICKS(MU_RMT_TIMEOUT_MS)) != pdTRUE) return false;
+  rmt_transmit_config_t tx = {};
+  if (rmt_transmit(s.chan, s.enc, s.staging[idx], len, &tx) != ESP_OK) {
+    xSemaphoreGive(s.done);
+    return false;
+  }
+  s.cur = idx;
+  return true;
+}
+
+static inline bool MU_RmtShow(const CRGB* frame, uint16_t count, uint8_t brightness = 255, uint8_t strip = 0) {
+  if (strip >= MU_RmtStripCount) return false;
+  MU_RmtStrip& s = MU_RmtStrips[strip];
+  if (count > s.count) count = s.count;
+  // Channel positions on the wire, decoded from FastLED's octal EOrder (e.g. GRB = 0102)
+  constexpr uint8_t order = (uint8_t)COLOR_ORDER;
+  constexpr uint8_t c0 = (order >> 6) & 0x3, c1 = (order >> 3) & 0x7, c2 = order & 0x7;
+  const uint16_t scale = (uint16_t)brightness + 1;
+  uint8_t idx = s.cur ^ 1;  // the other buffer may still be on the wire
+  uint8_t* p = s.staging[idx];
+  for (uint16_t i = 0; i < count; ++i) {
+    const uint8_t* raw = frame[i].raw;
+    *p++ = (uint8_t)((raw[c0] * scale) >> 8);
+    *p++ = (uint8_t)((raw[c1] * scale) >> 8);
+    *p++ = (uint8_t)((raw[c2] * scale) >> 8);
+  }
+  return MU_RmtKick(s, idx, (size_t)count * 3);
+}
+
+static inline bool MU_RmtShowRaw(const uint8_t* bytes, size_t len, uint8_t strip = 0) {
+  if (strip >= MU_RmtStripCount) return false;
+  MU_RmtStrip& s = MU_RmtStrips[strip];
+  if (len > (size_t)s.count * 3) len = (size_t)s.count * 3;
+  uint8_t idx = s.cur ^ 1;
+  memcpy(s.staging[idx], bytes, len);
+  return MU_RmtKick(s, idx, len);
+}
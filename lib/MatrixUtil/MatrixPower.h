@@ -0,0 +1,141 @@
+// MatrixPower.h - Current- and temperature-budgeted brightness limiter for MatrixRender.h sketches
+// Usage: include after MatrixRender.h and call MU_PowerBegin(cfg) once, before MU_RenderBegin().
+// Every frame the output task estimates the LED current from the channel values and the brightness the
+// show callback applies, and if it exceeds the budget scales the whole frame down just enough to fit.
+// Dim scenes go out untouched; only bright ones (full-white flashes, large fills) are limited, so the
+// sketch's brightness setting no longer has to assume the worst-case frame.
+// Provides:
+//  - MU_PowerConfig / MU_PowerBegin(cfg): budget in mA, the show callback's brightness, and an optional
+//    temperature source (e.g. MU_ImuTemperatureC from MatrixIMU.h) that derates the budget linearly
+//    from hotC down to minPercent at maxC.
+//  - MU_PowerFilter(frame, count): the MU_RenderFilterHook pass (sum through the LUT, scale if needed).
+//  - MU_PowerStats(): last estimate before/after limiting, scale, limited frames, pass duration.
+//  - MU_POWER_GAMMA_X10: optional output gamma (22 = 2.2) folded into the same LUT; 0 = values as drawn.
+// Model: each channel draws MU_POWER_MA_PER_CHANNEL at 255 after brightness, linear in the value (the
+// WS2812 PWM duty), plus MU_POWER_IDLE_UA per LED. Calibrate both against a meter for your panel.
+// Cost: one table load and add per channel, no copy while a frame is within budget (~1 us for 8x8).
+
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <math.h>
+#include <atomic>
+#include "MatrixRender.h"
+
+#ifndef MU_POWER_BUDGET_MA
+#ifdef POWER_BUDGET_MA
+#define MU_POWER_BUDGET_MA POWER_BUDGET_MA   // from the board profile
+#else
+#define MU_POWER_BUDGET_MA 400
+#endif
+#endif
+#ifndef MU_POWER_MA_PER_CHANNEL
+#define MU_POWER_MA_PER_CHANNEL 20    // WS2812B datasheet: ~20 mA per color at full duty
+#endif
+#ifndef MU_POWER_IDLE_UA
+#define MU_POWER_IDLE_UA 1000         // quiescent current per LED (all channels off)
+#endif
+#ifndef MU_POWER_GAMMA_X10
+#define MU_POWER_GAMMA_X10 0          // gamma x 10 (22 = 2.2); 0 = no gamma
+#endif
+
+struct MU_PowerConfig {
+  uint16_t budgetMa = MU_POWER_BUDGET_MA;
+  uint8_t brightness = 0;              // brightness the show callback applies; 0 = MU_Brightness
+  float (*temperatureC)() = nullptr;   // board temperature, NAN when unknown
+  float hotC = 45.0f;                  // derating starts here
+  float maxC = 60.0f;                  // budget reaches minPercent here
+  uint8_t minPercent = 25;
+};
+
+struct MU_PowerState {
+  MU_PowerConfig cfg;
+  uint8_t lut[256];                    // channel value -> value on the wire (gamma, or identity)
+  bool identity = true;
+  std::atomic<uint16_t> estimateMa{0}; // last frame as drawn
+  std::atomic<uint16_t> outputMa{0};   // last frame as sent
+  std::atomic<uint16_t> scale{256};    // 256 = unscaled
+  std::atomic<uint32_t> limited{0};    // frames scaled down
+  std::atomic<uint32_t> lastUs{0};
+};
+
+inline MU_PowerState MU_Power;
+inline CRGB MU_PowerFrame[MU_NUM_LEDS];  // scaled copy handed to show(), owned by the output task
+
+struct MU_PowerStatsData {
+  uint16_t estimateMa;
+  uint16_t outputMa;
+  uint16_t scale;
+  uint32_t limited;
+  uint32_t lastUs;
+};
+
+static inline MU_PowerStatsData MU_PowerStats() {
+  return { MU_Power.estimateMa.load(std::memory_order_relaxed), MU_Power.outputMa.load(std::memory_order_relaxed),
+           MU_Power.scale.load(std::memory_order_relaxed), MU_Power.limited.load(std::memory_order_relaxed),
+           MU_Power.lastUs.load(std::memory_order_relaxed) };
+}
+
+// Budget after thermal derating
+static inline uint32_t MU_PowerBudgetMa() {
+  const MU_PowerConfig& c = MU_Power.cfg;
+  uint32_t budget = c.budgetMa;
+  if (!c.temperatureC || c.maxC <= c.hotC) return budget;
+  float t = c.temperatureC();
+  if (isnan(t) || t <= c.hotC) return budget;
+  float f = t >= c.maxC ? 0.0f : 1.0f - (t - c.hotC) / (c.maxC - c.hotC);
+  float pct = c.minPercent + (100 - c.minPercent) * f;
+  return (uint32_t)(budget * pct / 100.0f);
+}
+
+// Channel-value sum (after the LUT) -> mA at `bright`, without the idle share
+static inline uint32_t MU_PowerLedMa(uint32_t sum, uint8_t bright) {
+  return (uint32_t)((uint64_t)sum * bright * MU_POWER_MA_PER_CHANNEL / (255u * 255u));
+}
+
+static const CRGB* MU_PowerFilter(const CRGB* frame, uint16_t count) {
+  uint32_t t0 = micros();
+  const uint8_t* lut = MU_Power.lut;
+  const uint8_t* p = (const uint8_t*)frame;
+  uint32_t sum = 0;
+  for (uint16_t i = 0; i < count * 3u; ++i) sum += lut[p[i]];
+
+  uint8_t bright = MU_Power.cfg.brightness ? MU_Power.cfg.brightness : MU_Brightness;
+  uint32_t idleMa = (uint32_t)count * MU_POWER_IDLE_UA / 1000;
+  uint32_t ledMa = MU_PowerLedMa(sum, bright);
+  uint32_t budget = MU_PowerBudgetMa();
+  uint32_t avail = budget > idleMa ? budget - idleMa : 0;
+  uint16_t scale = 256;
+  if (ledMa > avail) scale = (uint16_t)(avail * 256 / ledMa);  // < 256, rounds down: stays in budget
+
+  const CRGB* out = frame;
+  if (scale < 256 || !MU_Power.identity) {
+    uint8_t* q = (uint8_t*)MU_PowerFrame;
+    for (uint16_t i = 0; i < count * 3u; ++i) q[i] = (uint8_t)((lut[p[i]] * scale) >> 8);
+    out = MU_PowerFrame;
+  }
+  if (scale < 256) MU_Power.limited.fetch_add(1, std::memory_order_relaxed);
+  MU_Power.estimateMa.store((uint16_t)min(ledMa + idleMa, (uint32_t)0xFFFF), std::memory_order_relaxed);
+  MU_Power.outputMa.store((uint16_t)min((ledMa * scale >> 8) + idleMa, (uint32_t)0xFFFF), std::memory_order_relaxed);
+  MU_Power.scale.store(scale, std::memory_order_relaxed);
+  MU_Power.lastUs.store(micros() - t0, std::memory_order_relaxed);
+  return out;
+}
+
+// Installs MU_PowerFilter as MU_RenderFilterHook. Call it before MU_RenderBegin(): the output task
+// reads the hook, cfg and the LUT without a lock, so they must be in place before it starts (its
+// first frame is then already limited). With cfg.temperatureC the budget shrinks as the board warms.
+static inline void MU_PowerBegin(const MU_PowerConfig& cfg = MU_PowerConfig()) {
+  MU_Power.cfg = cfg;
+  for (uint16_t v = 0; v < 256; ++v) {
+#if MU_POWER_GAMMA_X10 > 0
+    MU_Power.lut[v] = (uint8_t)(powf(v / 255.0f, MU_POWER_GAMMA_X10 / 10.0f) * 255.0f + 0.5f);
+#else
+    MU_Power.lut[v] = (uint8_t)v;
+#endif
+  }
+  MU_Power.identity = MU_POWER_GAMMA_X10 <= 0;
+  MU_RenderFilterHook = MU_PowerFilter;
+  MU_RenderInvalidate();  // re-send the current frame under the new limit
+}
@@ -0,0 +1,242 @@
+// MatrixProfile.h - Scoped cycle-counter profiler with a PROFILE: serial report
+// Usage: included by MatrixUtil.h. Enable with `#define PROFILE_SECTIONS 1` in the board profile (so every
+// translation unit agrees), then put MU_PROFILE_SCOPE("name"); at the top of any block to time it.
+// With it off (the default) the macro expands to nothing.
+// Each scope reads the CPU cycle counter (Xtensa CCOUNT) on entry and exit and adds the difference to a
+// static per-name slot: calls, sum, min, max. The slot is found once per call site (a function-local
+// static), so a scope costs two register reads, a few adds and two stores of the slot's sequence
+// counter. Scopes nest; scopes with the same name share one slot. A slot should be fed from one task at
+// a time (it has a single writer), and a scope must start and end on the same core, which pinned tasks
+// guarantee. The printer never writes a slot: it copies it under the sequence counter (retrying a copy
+// torn by an update) and starts a new window by bumping MU_ProfileWindow; each slot's owner then clears
+// the stale stats on its next update.
+// Provides:
+//  - MU_PROFILE_SCOPE(name): time the enclosing block under `name` (a string literal).
+//  - MU_ProfilePrint(reset): one line
+//      PROFILE:ms=<window>,mhz=<cpu>,<name>=calls/avg/min/max,...   (cycles)
+//    tools/led_matrix_viz.py shows it as an overlay (--stats or --profile).
+//  - MU_ProfileService(): prints every MU_PROFILE_INTERVAL_MS; the host's 'P' goes through
+//    MU_HostService() (MatrixUtil.h). MU_SchedRun() calls both, other sketches call them from loop().
+// Built-in sections: upd/ren/pre (MatrixSched.h), show (MatrixRender.h output task), imu_i2c
+// (MatrixIMU.h FIFO reads), tx_serial (MatrixTelemetry.h drain), frame_tx (MU_SendFrame*).
+
+#pragma once
+
+#include <Arduino.h>
+#include <string.h>
+
+#ifndef MU_PROFILE
+#ifdef PROFILE_SECTIONS
+#define MU_PROFILE PROFILE_SECTIONS   // from the board profile
+#else
+#define MU_PROFILE 0
+#endif
+#endif
+
+#if MU_PROFILE
+
+#include <atomic>
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#endif
+#if !defined(__XTENSA__) && defined(ESP32)
+#include <esp_cpu.h>
+#elif !defined(ESP32)
+#include <chrono>
+#endif
+
+#ifndef MU_PROFILE_MAX_SLOTS
+#define MU_PROFILE_MAX_SLOTS 24
+#endif
+#ifndef MU_PROFILE_INTERVAL_MS
+#define MU_PROFILE_INTERVAL_MS 1000   // 0: only on a host 'P'
+#endif
+#ifndef MU_PROFILE_HOST_REQ
+#define MU_PROFILE_HOST_REQ 1         // a host 'P' on Serial prints a PROFILE line
+#endif
+#ifndef MU_PROFILE_READ_TRIES
+#define MU_PROFILE_READ_TRIES 8       // copies of a slot being updated before it is skipped for the window
+#endif
+
+// Free-running cycle count of the calling core (host builds: nanoseconds, reported as mhz=1000)
+static inline __attribute__((always_inline)) uint32_t MU_ProfileCycles() {
+#if defined(__XTENSA__)
+  uint32_t c;
+  __asm__ __volatile__("rsr %0, ccount" : "=a"(c));
+  return c;
+#elif defined(ESP32)
+  return (uint32_t)esp_cpu_get_cycle_count();
+#else
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static inline uint32_t MU_ProfileMhz() {
+#if defined(ESP32)
+  return getCpuFrequencyMhz();
+#else
+  return 1000;
+#endif
+}
+
+struct MU_ProfileStats {
+  uint32_t calls;
+  uint32_t minCyc;
+  uint32_t maxCyc;
+  uint64_t sumCyc;
+};
+
+struct MU_ProfileSlotData {
+  const char* name;
+  std::atomic<uint32_t> seq{0};       // odd while the owner updates the slot
+  uint32_t window;                    // MU_ProfileWindow the stats belong to
+  MU_ProfileStats st;
+};
+
+inline MU_ProfileSlotData MU_ProfileSlots[MU_PROFILE_MAX_SLOTS];
+inline std::atomic<uint8_t> MU_ProfileSlotCount{0};   // published after the slot's name is written
+inline std::atomic<uint32_t> MU_ProfileWindow{0};
+inline uint32_t MU_ProfileSinceMs = 0;
+#if defined(ESP32)
+inline portMUX_TYPE MU_ProfileSlotLock = portMUX_INITIALIZER_UNLOCKED;
+#else
+inline std::atomic_flag MU_ProfileSlotLock = ATOMIC_FLAG_INIT;
+#endif
+
+static inline void MU_ProfileClear(MU_ProfileStats& s) {
+  s.calls = 0;
+  s.minCyc = 0xFFFFFFFFu;
+  s.maxCyc = 0;
+  s.sumCyc = 0;
+}
+
+static inline uint8_t MU_ProfileFind(const char* name, uint8_t n) {
+  for (uint8_t i = 0; i < n; ++i)
+    if (strcmp(MU_ProfileSlots[i].name, name) == 0) return i;
+  return n;
+}
+
+// Slot for `name`, registered on first use; MU_PROFILE_MAX_SLOTS means the table is full (not timed).
+// Two call sites registering at once (any task, any core) serialize on the lock, so each name gets one
+// slot and no reader sees a slot before its name is set.
+static inline uint8_t MU_ProfileSlot(const char* name) {
+  uint8_t n = MU_ProfileSlotCount.load(std::memory_order_acquire);
+  uint8_t i = MU_ProfileFind(name, n);
+  if (i < n) return i;
+#if defined(ESP32)
+  portENTER_CRITICAL(&MU_ProfileSlotLock);
+#else
+  while (MU_ProfileSlotLock.test_and_set(std::memory_order_acquire)) {}
+#endif
+  n = MU_ProfileSlotCount.load(std::memory_order_relaxed);
+  i = MU_ProfileFind(name, n);
+  if (i == n && n < MU_PROFILE_MAX_SLOTS) {
+    MU_ProfileSlotData& s = MU_ProfileSlots[n];
+    s.name = name;
+    s.window = MU_ProfileWindow.load(std::memory_order_relaxed);
+    MU_ProfileClear(s.st);
+    MU_ProfileSlotCount.store(n + 1, std::memory_order_release);
+  } else if (i == n) {
+    i = MU_PROFILE_MAX_SLOTS;
+  }
+#if defined(ESP32)
+  portEXIT_CRITICAL(&MU_ProfileSlotLock);
+#else
+  MU_ProfileSlotLock.clear(std::memory_order_release);
+#endif
+  return i;
+}
+
+struct MU_ProfileScope {
+  uint8_t slot;
+  uint32_t t0;
+  explicit MU_ProfileScope(uint8_t s) : slot(s), t0(MU_ProfileCycles()) {}
+  ~MU_ProfileScope() {
+    uint32_t d = MU_ProfileCycles() - t0;
+    if (slot >= MU_PROFILE_MAX_SLOTS) return;
+    MU_ProfileSlotData& s = MU_ProfileSlots[slot];
+    uint32_t q = s.seq.load(std::memory_order_relaxed);
+    s.seq.store(q + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    uint32_t w = MU_ProfileWindow.load(std::memory_order_relaxed);
+    if (s.window != w) {              // the printer started a new window
+      s.window = w;
+      MU_ProfileClear(s.st);
+    }
+    s.st.calls++;
+    s.st.sumCyc += d;
+    if (d < s.st.minCyc) s.st.minCyc = d;
+    if (d > s.st.maxCyc) s.st.maxCyc = d;
+    s.seq.store(q + 2, std::memory_order_release);
+  }
+};
+
+// Consistent copy of slot i's stats for window w (empty if its owner has not updated it since w began);
+// false if every try raced an update
+static inline bool MU_ProfileRead(uint8_t i, uint32_t w, MU_ProfileStats& out) {
+  MU_ProfileSlotData& s = MU_ProfileSlots[i];
+  for (uint8_t t = 0; t < MU_PROFILE_READ_TRIES; ++t) {
+    uint32_t q = s.seq.load(std::memory_order_acquire);
+    if (q & 1) continue;
+    bool current = s.window == w;
+    out = s.st;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (s.seq.load(std::memory_order_relaxed) != q) continue;
+    if (!current) MU_ProfileClear(out);
+    return true;
+  }
+  return false;
+}
+
+#define MU_PROFILE_CAT2(a, b) a##b
+#define MU_PROFILE_CAT(a, b) MU_PROFILE_CAT2(a, b)
+#define MU_PROFILE_SCOPE(name)                                                           \
+  static const uint8_t MU_PROFILE_CAT(muProfSlot_, __LINE__) = MU_ProfileSlot(name);     \
+  MU_ProfileScope MU_PROFILE_CAT(muProfScope_, __LINE__)(MU_PROFILE_CAT(muProfSlot_, __LINE__))
+
+// PROFILE:ms=<window>,mhz=<cpu>,<name>=calls/avg/min/max,... (cycles); resets the window by default.
+// A slot whose owner kept updating through every read try is left out of this line.
+static inline void MU_ProfilePrint(bool reset = true) {
+  char buf[640];
+  uint32_t now = millis();
+  uint32_t w = MU_ProfileWindow.load(std::memory_order_relaxed);
+  int n = snprintf(buf, sizeof(buf), "PROFILE:ms=%lu,mhz=%lu", (unsigned long)(now - MU_ProfileSinceMs),
+                   (unsigned long)MU_ProfileMhz());
+  uint8_t count = MU_ProfileSlotCount.load(std::memory_order_acquire);
+  for (uint8_t i = 0; i < count && n > 0 && (size_t)n < sizeof(buf); ++i) {
+    MU_ProfileStats s;
+    if (!MU_ProfileRead(i, w, s)) continue;
+    n += snprintf(buf + n, sizeof(buf) - n, ",%s=%lu/%lu/%lu/%lu", MU_ProfileSlots[i].name,
+                  (unsigned long)s.calls, (unsigned long)(s.calls ? s.sumCyc / s.calls : 0),
+                  (unsigned long)(s.calls ? s.minCyc : 0), (unsigned long)s.maxCyc);
+  }
+  if (n > 0 && (size_t)n < sizeof(buf)) n += snprintf(buf + n, sizeof(buf) - n, "\r\n");
+  if (n > 0) MU_SerialWrite((const uint8_t*)buf, (size_t)min(n, (int)sizeof(buf) - 1));
+  if (reset) {
+    MU_ProfileWindow.store(w + 1, std::memory_order_relaxed);
+    MU_ProfileSinceMs = now;
+  }
+}
+
+#if MU_PROFILE_HOST_REQ
+static inline void MU_ProfileHostPrint() {
+  MU_ProfilePrint();
+}
+static const bool MU_ProfileHostCmd = MU_HostOn('P', MU_ProfileHostPrint);
+#endif
+
+static inline void MU_ProfileService() {
+  #if MU_PROFILE_INTERVAL_MS > 0
+    if (millis() - MU_ProfileSinceMs >= MU_PROFILE_INTERVAL_MS) MU_ProfilePrint();
+  #endif
+}
+
+#else
+
+#define MU_PROFILE_SCOPE(name) ((void)0)
+
+static inline void MU_ProfilePrint(bool = true) {}
+static inline void MU_ProfileService() {}
+
+#endif
@@ -0,0 +1,328 @@
+// MatrixQMI.h - QMI8658 driver for the Waveshare board: bring-up, per-loop reads and power profiles
+// Usage: include after config/BoardConfig.h and MatrixUtil.h (and MatrixTilt.h / MatrixNav.h when used).
+// Add the sample hooks first (MU_TiltBegin and/or MU_NavBegin; both may run), then in setup():
+//   if (!MU_ImuBegin(MU_IMU_GAME)) { ... no sensor ... }
+// and MU_ImuLoop() where the sketch reads the sensor; it copies the newest data into MU_ImuAccel /
+// MU_ImuGyro (g, deg/s) without touching I2C when the sensor task runs.
+// Profiles:
+//  - MU_IMU_GAME: 6DOF, accel 1000 Hz / 4 g + gyro 896.8 Hz / 64 dps, FIFO batches of 9 samples
+//    (~10 ms) drained by the sensor task. ~10.8 kB/s of FIFO reads. Snake, wifi-slam (heading).
+//  - MU_IMU_TILT: accelerometer only at MU_IMU_TILT_ODR (low-power 128 Hz), gyro powered down.
+//    6-byte FIFO samples, batches of MU_IMU_TILT_WATERMARK; ~0.8 kB/s. Gyro reads 0, so MatrixTilt
+//    runs as a plain low-pass on the accelerometer angle: use a short tauUs. tilt-demo.
+//  - MU_IMU_WAKE: accelerometer only at MU_IMU_WAKE_ODR (low-power 21 Hz) with the sensor's
+//    wake-on-motion engine armed at MU_IMU_WAKE_MG. No FIFO, no task: an event arrives on
+//    IMU_INT_PIN (the WoM output toggles on each event), or STATUS1 is polled every
+//    MU_IMU_WAKE_POLL_MS without a pin. MU_ImuAccel is only refreshed after an event.
+// Provides:
+//  - MU_ImuBegin(profile, wire, sda, scl): false if the sensor does not answer. May run on another
+//    task (MatrixBoot.h stage); MU_ImuReady() turns true once it succeeded.
+//  - MU_ImuLoop(): newest batch into MU_ImuAccel/MU_ImuGyro; reads FIFO/registers itself without a task.
+//    Does nothing until MU_ImuReady(), so a sketch runs on (without tilt) when the sensor is missing.
+//  - MU_ImuWait(ms): sleep until the sensor task publishes (plain delay without one).
+//  - MU_ImuMotion(): true once per wake-on-motion event since the last call (MU_IMU_WAKE only).
+//  - MU_ImuWakePin(): GPIO carrying the WoM interrupt, -1 when polled (for light-sleep wake sources).
+//  - MU_ImuSleep() / MU_ImuResume(): park a GAME/TILT sensor in the MU_IMU_WAKE setup while the sketch
+//    idles (sensor task paused) and bring the profile back; MU_ImuMotionPoll() checks for an event
+//    right away. MatrixIdle.h's enter/leave/poll hooks.
+//  - MU_ImuDump(): control register dump (IMU_DEBUG only), e.g. MU_BootDefer(MU_ImuDump) so it
+//    prints after boot instead of delaying the first frame.
+//  - MU_QmiSensor: the SensorQMI8658 instance, for anything the profiles don't cover.
+// Debug output (chip id, register dump, one line per batch) is compiled in only with
+// `#define IMU_DEBUG 1` in the board profile (MU_IMU_DEBUG); wiring errors are always printed.
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <atomic>
+#include "SensorQMI8658.hpp"
+#include "MatrixIMU.h"
+
+#ifndef MU_IMU_DEBUG
+#ifdef IMU_DEBUG
+#define MU_IMU_DEBUG IMU_DEBUG        // from the board profile
+#else
+#define MU_IMU_DEBUG 0
+#endif
+#endif
+#ifndef IMU_SDA_PIN
+#define IMU_SDA_PIN 11
+#endif
+#ifndef IMU_SCL_PIN
+#define IMU_SCL_PIN 12
+#endif
+#ifndef IMU_INT_PIN
+#define IMU_INT_PIN -1
+#endif
+#ifndef IMU_INT_LINE
+#define IMU_INT_LINE 2
+#endif
+#ifndef MU_IMU_GAME_WATERMARK
+#define MU_IMU_GAME_WATERMARK 9       // one batch every ~10 ms at 896.8 Hz
+#endif
+#ifndef MU_IMU_TILT_ODR
+#define MU_IMU_TILT_ODR SensorQMI8658::ACC_ODR_LOWPOWER_128Hz
+#define MU_IMU_TILT_ODR_HZ 128.0f
+#endif
+#ifndef MU_IMU_TILT_ODR_HZ
+#error "MU_IMU_TILT_ODR needs a matching MU_IMU_TILT_ODR_HZ"
+#endif
+#ifndef MU_IMU_TILT_WATERMARK
+#define MU_IMU_TILT_WATERMARK 2       // one batch every ~16 ms at 128 Hz
+#endif
+#ifndef MU_IMU_WAKE_ODR
+#define MU_IMU_WAKE_ODR SensorQMI8658::ACC_ODR_LOWPOWER_21Hz
+#endif
+#ifndef MU_IMU_WAKE_MG
+#define MU_IMU_WAKE_MG 100            // change on any axis that counts as motion, 1 mg/LSB
+#endif
+#ifndef MU_IMU_WAKE_BLANKING
+#define MU_IMU_WAKE_BLANKING 8        // samples ignored after arming (0..63)
+#endif
+#ifndef MU_IMU_WAKE_POLL_MS
+#define MU_IMU_WAKE_POLL_MS 50        // STATUS1 poll period without an interrupt pin
+#endif
+
+#if MU_IMU_DEBUG
+#define MU_IMU_LOG(...) printf(__VA_ARGS__)
+#else
+#define MU_IMU_LOG(...) ((void)0)
+#endif
+
+// Wake-on-motion registers and command (datasheet names)
+#define MU_QMI_CAL1_L          0x0B     // WoM threshold, mg
+#define MU_QMI_CAL1_H          0x0C     // [7] initial INT level, [6] INT2 (else INT1), [5:0] blanking
+#define MU_QMI_STATUS1         0x2F
+#define MU_QMI_STATUS1_WOM     0x04
+#define MU_QMI_CMD_WRITE_WOM   0x08
+
+enum MU_ImuProfile : uint8_t {
+  MU_IMU_GAME,
+  MU_IMU_TILT,
+  MU_IMU_WAKE,
+};
+
+struct MU_ImuDriverState {
+  MU_ImuProfile profile = MU_IMU_GAME;
+  bool fifo = false;                  // FIFO batches (else single-sample polling or WoM)
+  bool task = false;                  // sensor task drains the FIFO
+  bool sleeping = false;              // MU_ImuSleep(): WoM armed in place of the profile
+  std::atomic<bool> ready{false};     // MU_ImuBegin() succeeded; set last, after the fields above
+  uint8_t ctrl1 = 0;                  // CTRL1 before WoM claimed an interrupt line
+  int8_t wakePin = -1;
+  uint32_t lastPollMs = 0;
+  uint32_t motionSeen = 0;            // events MU_ImuLoop has refreshed MU_ImuAccel for
+  std::atomic<uint32_t> motionEvents{0};
+  std::atomic<bool> motion{false};
+};
+
+inline SensorQMI8658 MU_QmiSensor;
+inline MU_ImuDriverState MU_ImuDrv;
+inline IMUdata MU_ImuAccel = { 0, 0, 0 };
+inline IMUdata MU_ImuGyro = { 0, 0, 0 };
+
+static inline void MU_ImuMotionEvent() {
+  MU_ImuDrv.motionEvents.fetch_add(1, std::memory_order_relaxed);
+  MU_ImuDrv.motion.store(true, std::memory_order_release);
+}
+
+#if defined(ESP32)
+static void IRAM_ATTR MU_ImuWakeIsr() {
+  MU_ImuDrv.motionEvents.fetch_add(1, std::memory_order_relaxed);
+  MU_ImuDrv.motion.store(true, std::memory_order_release);
+}
+#endif
+
+// Accelerometer only, wake-on-motion armed; sensors are disabled while the engine is configured
+static inline bool MU_ImuArmWake(int8_t intPin, uint8_t intLine) {
+  MU_QmiSensor.configAccelerometer(SensorQMI8658::ACC_RANGE_4G, MU_IMU_WAKE_ODR, SensorQMI8658::LPF_MODE_0);
+  uint8_t cal1h = (uint8_t)((intLine == 1 ? 0x00 : 0x40) | (MU_IMU_WAKE_BLANKING & 0x3F));  // INT starts low
+  uint8_t ctrl1 = 0;
+  bool ok = MU_QmiRead(MU_QMI_CTRL1, &MU_ImuDrv.ctrl1, 1) &&
+            MU_QmiWrite(MU_QMI_CTRL7, 0) &&
+            MU_QmiWrite(MU_QMI_CAL1_L, MU_IMU_WAKE_MG) &&
+            MU_QmiWrite(MU_QMI_CAL1_H, cal1h) &&
+            MU_QmiCommand(MU_QMI_CMD_WRITE_WOM) &&
+            MU_QmiRead(MU_QMI_CTRL1, &ctrl1, 1);
+  if (!ok) return false;
+  ctrl1 |= intLine == 1 ? MU_QMI_CTRL1_INT1_EN : MU_QMI_CTRL1_INT2_EN;
+  if (!MU_QmiWrite(MU_QMI_CTRL1, ctrl1)) return false;
+  MU_QmiSensor.enableAccelerometer();
+  MU_ImuDrv.wakePin = -1;
+#if defined(ESP32)
+  if (intPin >= 0) {
+    pinMode(intPin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(intPin), MU_ImuWakeIsr, CHANGE);
+    MU_ImuDrv.wakePin = intPin;
+  }
+#else
+  (void)intPin;  // no interrupts on host builds: STATUS1 is polled
+#endif
+  return true;
+}
+
+// Sensor setup of one profile on an answering QMI8658 (MU_ImuBegin, MU_ImuResume)
+static inline bool MU_ImuConfigure(MU_ImuProfile profile) {
+  TwoWire& wire = *MU_ImuFifo.wire;
+  if (profile == MU_IMU_WAKE) {
+    MU_QmiSensor.disableGyroscope();
+    if (!MU_ImuArmWake(IMU_INT_PIN, IMU_INT_LINE)) {
+      printf("QMI8658 wake-on-motion setup failed\r\n");
+      return false;
+    }
+  } else {
+    uint8_t watermark = MU_IMU_GAME_WATERMARK;
+    float odrHz = MU_IMU_ODR_HZ;
+    if (profile == MU_IMU_TILT) {
+      MU_QmiSensor.configAccelerometer(SensorQMI8658::ACC_RANGE_4G, MU_IMU_TILT_ODR, SensorQMI8658::LPF_MODE_0);
+      MU_QmiSensor.disableGyroscope();  // accelerometer-only: ODR is the accelerometer's own
+      MU_QmiSensor.enableAccelerometer();
+      watermark = MU_IMU_TILT_WATERMARK;
+      odrHz = MU_IMU_TILT_ODR_HZ;
+    } else {
+      MU_QmiSensor.configAccelerometer(SensorQMI8658::ACC_RANGE_4G, SensorQMI8658::ACC_ODR_1000Hz, SensorQMI8658::LPF_MODE_0);
+      MU_QmiSensor.configGyroscope(SensorQMI8658::GYR_RANGE_64DPS, SensorQMI8658::GYR_ODR_896_8Hz, SensorQMI8658::LPF_MODE_3);
+      // In 6DOF mode the output data rate is derived from the gyroscope's
+      MU_QmiSensor.enableGyroscope();
+      MU_QmiSensor.enableAccelerometer();
+    }
+    // Buffer samples on the sensor; the sensor task (other core) drains them in burst reads
+    MU_ImuDrv.fifo = MU_ImuFifoBegin(wire, QMI8658_L_SLAVE_ADDRESS, watermark, MU_QMI_FIFO_SIZE_64);
+    MU_ImuFifoSetOdr(odrHz);
+    if (!MU_ImuDrv.fifo) printf("QMI8658 FIFO setup failed, polling single samples\r\n");
+    MU_ImuDrv.task = MU_ImuDrv.fifo && MU_ImuTaskBegin(IMU_INT_PIN, IMU_INT_LINE);
+  }
+  return true;
+}
+
+static inline bool MU_ImuBegin(MU_ImuProfile profile = MU_IMU_GAME, TwoWire& wire = Wire,
+                               int sda = IMU_SDA_PIN, int scl = IMU_SCL_PIN) {
+  MU_ImuDrv.profile = profile;
+  wire.begin(sda, scl);
+  if (!MU_QmiSensor.begin(wire, QMI8658_L_SLAVE_ADDRESS, sda, scl)) {
+    printf("Failed to find QMI8658 - check your wiring!\r\n");
+    return false;
+  }
+  MU_IMU_LOG("Device ID: %x\r\n", MU_QmiSensor.getChipID());
+  MU_ImuFifo.wire = &wire;  // register access for the raw paths
+  MU_ImuFifo.addr = QMI8658_L_SLAVE_ADDRESS;
+  if (!MU_ImuConfigure(profile)) return false;
+  MU_IMU_LOG("Read data now...\r\n");
+  MU_ImuDrv.ready.store(true, std::memory_order_release);
+  return true;
+}
+
+static inline bool MU_ImuReady() {
+  return MU_ImuDrv.ready.load(std::memory_order_acquire);
+}
+
+static inline void MU_ImuDump() {
+#if MU_IMU_DEBUG
+  if (!MU_ImuReady()) return;
+  MU_ImuPause(true);  // the dump shares the bus with the sensor task
+  MU_QmiSensor.dumpCtrlRegister();
+  MU_ImuPause(false);
+#endif
+}
+
+// Sleep until the sensor task has a new batch (or timeoutMs); plain delay without the task
+static inline void MU_ImuWait(uint32_t timeoutMs) {
+  if (MU_ImuReady() && MU_ImuDrv.task) MU_ImuWaitFresh(timeoutMs);
+  else delay(timeoutMs);
+}
+
+static inline bool MU_ImuMotion() {
+  return MU_ImuDrv.motion.exchange(false, std::memory_order_acq_rel);
+}
+
+static inline int8_t MU_ImuWakePin() {
+  return MU_ImuDrv.wakePin;
+}
+
+static inline void MU_ImuLoopWake() {
+  if (MU_ImuDrv.wakePin < 0 && millis() - MU_ImuDrv.lastPollMs >= MU_IMU_WAKE_POLL_MS) {
+    MU_ImuDrv.lastPollMs = millis();
+    uint8_t st = 0;  // reading STATUS1 clears the event
+    if (MU_QmiRead(MU_QMI_STATUS1, &st, 1) && (st & MU_QMI_STATUS1_WOM)) MU_ImuMotionEvent();
+  }
+  uint32_t events = MU_ImuDrv.motionEvents.load(std::memory_order_relaxed);
+  if (events == MU_ImuDrv.motionSeen) return;
+  MU_ImuDrv.motionSeen = events;
+  // One fresh reading after the board moved, e.g. to re-orient the display on pick-up
+  if (MU_QmiSensor.getAccelerometer(MU_ImuAccel.x, MU_ImuAccel.y, MU_ImuAccel.z)) {
+    MU_IMU_LOG("WOM: %lu  ACCEL:  %f  %f  %f\r\n", (unsigned long)events, MU_ImuAccel.x, MU_ImuAccel.y, MU_ImuAccel.z);
+    MU_ImuRunSampleHooks(MU_ImuMakeSample(MU_ImuNowUs(), MU_ImuAccel.x, MU_ImuAccel.y, MU_ImuAccel.z, 0, 0, 0));
+  }
+}
+
+static inline bool MU_ImuMotionPoll() {
+  MU_ImuDrv.lastPollMs = millis() - MU_IMU_WAKE_POLL_MS;  // read STATUS1 now
+  MU_ImuLoopWake();
+  return MU_ImuMotion();
+}
+
+// Idle: pause the sensor task and leave only the wake-on-motion engine running
+static inline bool MU_ImuSleep() {
+  if (!MU_ImuReady()) return false;
+  if (MU_ImuDrv.profile == MU_IMU_WAKE || MU_ImuDrv.sleeping) return true;
+  MU_ImuPause(true);
+  MU_QmiSensor.disableGyroscope();
+  MU_ImuDrv.sleeping = MU_ImuArmWake(IMU_INT_PIN, IMU_INT_LINE);
+  if (!MU_ImuDrv.sleeping) {
+    MU_ImuConfigure(MU_ImuDrv.profile);
+    MU_ImuPause(false);
+  }
+  MU_ImuMotion();  // events start from here
+  return MU_ImuDrv.sleeping;
+}
+
+static inline void MU_ImuResume() {
+  if (!MU_ImuDrv.sleeping) return;
+  MU_ImuDrv.sleeping = false;
+  // Threshold 0 disarms the engine; the profile's CTRL1 routing comes back before the FIFO restarts
+  MU_QmiWrite(MU_QMI_CTRL7, 0);
+  MU_QmiWrite(MU_QMI_CAL1_L, 0);
+  MU_QmiCommand(MU_QMI_CMD_WRITE_WOM);
+  MU_QmiWrite(MU_QMI_CTRL1, MU_ImuDrv.ctrl1);
+#if defined(ESP32)
+  if (MU_ImuDrv.wakePin >= 0) {
+    detachInterrupt(digitalPinToInterrupt(MU_ImuDrv.wakePin));
+    if (MU_ImuDrv.task) attachInterrupt(digitalPinToInterrupt(MU_ImuDrv.wakePin), MU_ImuIsr, RISING);
+  }
+#endif
+  MU_ImuDrv.wakePin = -1;
+  MU_ImuConfigure(MU_ImuDrv.profile);
+  MU_ImuPause(false);
+}
+
+static inline void MU_ImuLoop() {
+  if (!MU_ImuReady()) return;
+  if (MU_ImuDrv.profile == MU_IMU_WAKE || MU_ImuDrv.sleeping) {
+    MU_ImuLoopWake();
+    return;
+  }
+  if (MU_ImuDrv.fifo) {
+    // Latest batch mean from the sensor task, no I2C here
+    if (!MU_ImuDrv.task) MU_ImuService();
+    MU_ImuState st;
+    if (MU_ImuLatest(st)) {
+      MU_ImuAccel.x = st.accel[0]; MU_ImuAccel.y = st.accel[1]; MU_ImuAccel.z = st.accel[2];
+      MU_ImuGyro.x = st.gyro[0];   MU_ImuGyro.y = st.gyro[1];   MU_ImuGyro.z = st.gyro[2];
+      MU_IMU_LOG("ACCEL:  %f  %f  %f\r\n", MU_ImuAccel.x, MU_ImuAccel.y, MU_ImuAccel.z);
+      MU_IMU_LOG("GYRO:  %f  %f  %f\r\n", MU_ImuGyro.x, MU_ImuGyro.y, MU_ImuGyro.z);
+      MU_IMU_LOG("\t\t>      %lld us   %u samples\r\n\r\n", (long long)st.tUs, st.samples);
+    }
+    return;
+  }
+  if (MU_QmiSensor.getDataReady()) {
+    MU_QmiSensor.getAccelerometer(MU_ImuAccel.x, MU_ImuAccel.y, MU_ImuAccel.z);
+    if (MU_ImuDrv.profile == MU_IMU_GAME) MU_QmiSensor.getGyroscope(MU_ImuGyro.x, MU_ImuGyro.y, MU_ImuGyro.z);
+    // Polled path feeds the same per-sample hooks (tilt filter, nav) as the FIFO path
+    MU_ImuRunSampleHooks(MU_ImuMakeSample(MU_ImuNowUs(), MU_ImuAccel.x, MU_ImuAccel.y, MU_ImuAccel.z,
+                                          MU_ImuGyro.x, MU_ImuGyro.y, MU_ImuGyro.z));
+    MU_IMU_LOG("ACCEL:  %f  %f  %f\r\n", MU_ImuAccel.x, MU_ImuAccel.y, MU_ImuAccel.z);
+    MU_IMU_LOG("GYRO:  %f  %f  %f\r\n", MU_ImuGyro.x, MU_ImuGyro.y, MU_ImuGyro.z);
+    MU_IMU_LOG("\t\t>      %lu   %.2f C\r\n\r\n", (unsigned long)MU_QmiSensor.getTimestamp(), MU_QmiSensor.getTemperature_C());
+  }
+}
@@ -0,0 +1,641 @@
+// MatrixRecord.h - Record presented frames (and the inputs behind them) to a ring of flash files, replay them
+// Usage: include after MatrixRender.h. MU_RecordBegin() mounts LittleFS and starts a writer task; then
+// present with MU_RecordPresent() (or call MU_RecordFrame(frame, dirty) after MU_Present()) and log
+// inputs with MU_RecordImu / MU_RecordRssi / MU_RecordInput from the same thread. MU_PlayBegin() later
+// streams the ring back through MU_BackBuffer() + MU_Present() at the original timing.
+// Format: every record is a frame-stream packet (MatrixUtil.h framing, CRC, per-record seq) whose
+// payload starts with dtUs u32, the time since the previous record in the file:
+//   MU_REC_META  0x10  magic "MUR1", width u16, height u16, file sequence u32 (first record of a file)
+//   MU_REC_KEY   0x11  W*H RGB in XY order (first frame of a file, every MU_REC_KEYFRAME_INTERVAL frames)
+//   MU_REC_DELTA 0x12  changed runs, same layout as MU_PKT_DELTA
+//   MU_REC_INPUT 0x13  kind u8 + data (MU_REC_IN_IMU: 6 x float32 g/dps, MU_REC_IN_RSSI: bssid[6] rssi i8 ch u8)
+// Files MU_REC_DIR/mu_rec<N>.bin, N = 0..MU_REC_FILES-1, each up to MU_REC_FILE_BYTES; the oldest is
+// overwritten when the ring wraps. tools/led_matrix_viz.py --replay plays them, and MU_RecordDump()
+// sends the ring over Serial in the same bytes.
+// Writes: records are appended to one of two MU_REC_PAGE_BYTES (flash sector) pages in RAM; a full page
+// goes to the writer task (other core, low priority), so loop() never makes the file system calls.
+// It still feels them: while the flash is programmed or erased, the cache is off for both cores, and
+// code or constants not in IRAM stall until the operation ends (milliseconds for an erase). Keep the
+// LED output IRAM-safe (e.g. an RMT driver whose interrupt is in IRAM, CONFIG_RMT_ISR_IRAM_SAFE) or a
+// frame can glitch mid-write; MU_RecordStats().maxWriteUs shows how long pages take. The file is
+// fsync()ed every MU_REC_SYNC_PAGES pages and when it is closed, not per page, since each commit
+// rewrites LittleFS metadata; a power cut loses at most those pages plus the one in RAM.
+// When both pages are busy the record is dropped and the next frame is recorded as a keyframe.
+// IMU inputs are recorded on change: MU_RecordImu() skips a sample within MU_REC_IMU_DEADBAND of the
+// last one recorded, and records at most one per MU_REC_IMU_MIN_MS. Replay holds the last value.
+// Provides:
+//  - MU_RecordBegin() / MU_RecordStop(): start a new file after the newest one / flush and close.
+//  - MU_RecordFrame(frame, dirty), MU_RecordPresent(): keyframe or delta of the frame just presented.
+//  - MU_RecordInput(kind, data, len), MU_RecordImu(ax..gz), MU_RecordRssi(bssid, rssi, channel).
+//  - MU_RecordStats(): records, bytes, dropped records, pages written, slowest page write.
+//  - MU_PlayBegin(loop) / MU_PlayRender(nowUs) / MU_PlayRun(): replay, oldest file first. MU_PlayRender
+//    applies every record due by nowUs to the back buffer (true while playing) for a render callback;
+//    MU_PlayRun() presents each frame at its recorded time until the ring ends. Replayed inputs go to
+//    MU_PlayInputHook.
+// Host builds write the same files to the working directory with stdio.
+
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include "MatrixRender.h"
+#include "MatrixSched.h"
+
+#if defined(ESP32)
+#include <LittleFS.h>
+#include <unistd.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#ifndef MU_REC_FILES
+#define MU_REC_FILES 8
+#endif
+#ifndef MU_REC_FILE_BYTES
+#define MU_REC_FILE_BYTES (64 * 1024)   // 8 x 64 KB: ~45 min of Snake (0.19 KB/s in tools/emu),
+                                        // ~10 min if the board never stops moving
+#endif
+#ifndef MU_REC_PAGE_BYTES
+#define MU_REC_PAGE_BYTES 4096          // one flash sector per write
+#endif
+#ifndef MU_REC_SYNC_PAGES
+#define MU_REC_SYNC_PAGES 4             // fsync after this many pages (and on close)
+#endif
+#ifndef MU_REC_IMU_DEADBAND
+#define MU_REC_IMU_DEADBAND 0.05f       // g (accel) and 10x that in dps (gyro) before a sample is new
+#endif
+#ifndef MU_REC_IMU_MIN_MS
+#define MU_REC_IMU_MIN_MS 50            // at most one IMU record per this many ms (20/s)
+#endif
+#ifndef MU_REC_KEYFRAME_INTERVAL
+#define MU_REC_KEYFRAME_INTERVAL 250    // frames between keyframes (seek points for the player)
+#endif
+#ifndef MU_REC_DIR
+#if defined(ESP32)
+#define MU_REC_DIR "/littlefs"          // LittleFS default mount point
+#else
+#define MU_REC_DIR "."
+#endif
+#endif
+#ifndef MU_REC_TASK_PRIO
+#define MU_REC_TASK_PRIO 1
+#endif
+#ifndef MU_REC_TASK_STACK
+#define MU_REC_TASK_STACK 4096
+#endif
+
+#define MU_REC_META  0x10
+#define MU_REC_KEY   0x11
+#define MU_REC_DELTA 0x12
+#define MU_REC_INPUT 0x13
+
+#define MU_REC_IN_IMU  1
+#define MU_REC_IN_RSSI 2
+#define MU_REC_IN_USER 0x80             // first kind free for sketches
+
+#define MU_REC_DT_BYTES 4
+#define MU_REC_INPUT_MAX 64
+#define MU_REC_MAX_PAYLOAD (MU_NUM_LEDS * 3 > MU_REC_INPUT_MAX + 1 ? MU_NUM_LEDS * 3 : MU_REC_INPUT_MAX + 1)
+#define MU_REC_MAX_BYTES (MU_PKT_HEADER + MU_REC_DT_BYTES + MU_REC_MAX_PAYLOAD + MU_PKT_TRAILER)
+
+static_assert(MU_REC_MAX_BYTES <= MU_REC_PAGE_BYTES, "Keyframe larger than a page: raise MU_REC_PAGE_BYTES");
+static_assert(MU_REC_FILE_BYTES >= 2 * MU_REC_PAGE_BYTES, "MU_REC_FILE_BYTES must hold at least two pages");
+
+struct MU_RecPage {
+  uint8_t data[MU_REC_PAGE_BYTES];
+  uint16_t len = 0;
+  int16_t openFile = -1;                 // open this file (truncated) before writing
+  bool close = false;                    // close the file after writing
+  std::atomic<bool> full{false};         // handed to the writer
+};
+
+struct MU_RecordState {
+  MU_RecPage pages[2];
+  uint8_t cur = 0;                       // page loop() appends to
+  bool active = false;
+  uint32_t fileSeq = 0;                  // increments per file, decides the playback order
+  uint8_t file = 0;
+  uint32_t fileBytes = 0;
+  int64_t lastUs = 0;
+  uint16_t seq = 0;
+  bool keyPending = true;
+  uint16_t sinceKey = 0;
+  CRGB prev[MU_NUM_LEDS];                // last recorded frame, XY order
+  uint8_t rec[MU_REC_MAX_BYTES];         // record being built
+  float imuLast[6];                      // last IMU sample recorded
+  bool imuHave = false;
+  int64_t imuUs = 0;
+  // writer task
+  FILE* out = nullptr;
+  uint8_t nextWrite = 0;
+  uint8_t unsynced = 0;                  // pages written since the last fsync
+  std::atomic<uint32_t> records{0};
+  std::atomic<uint32_t> bytes{0};
+  std::atomic<uint32_t> dropped{0};
+  std::atomic<uint32_t> pagesWritten{0};
+  std::atomic<uint32_t> writeErrors{0};
+  std::atomic<uint32_t> maxWriteUs{0};
+};
+
+inline MU_RecordState MU_Rec;
+
+struct MU_RecordStatsData {
+  uint32_t records;
+  uint32_t bytes;
+  uint32_t dropped;
+  uint32_t pagesWritten;
+  uint32_t writeErrors;
+  uint32_t maxWriteUs;
+};
+
+static inline MU_RecordStatsData MU_RecordStats() {
+  return { MU_Rec.records.load(std::memory_order_relaxed), MU_Rec.bytes.load(std::memory_order_relaxed),
+           MU_Rec.dropped.load(std::memory_order_relaxed), MU_Rec.pagesWritten.load(std::memory_order_relaxed),
+           MU_Rec.writeErrors.load(std::memory_order_relaxed), MU_Rec.maxWriteUs.load(std::memory_order_relaxed) };
+}
+
+static inline void MU_RecPath(char* buf, size_t n, uint8_t file) {
+  snprintf(buf, n, "%s/mu_rec%u.bin", MU_REC_DIR, (unsigned)file);
+}
+
+static inline FILE* MU_RecOpen(uint8_t file, const char* mode) {
+  char path[48];
+  MU_RecPath(path, sizeof(path), file);
+  return fopen(path, mode);
+}
+
+static inline uint32_t MU_RecU32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void MU_RecPutU32(uint8_t* p, uint32_t v) {
+  p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+// Read one record; false at the end of the file or on a damaged record
+static inline bool MU_RecRead(FILE* f, uint8_t* buf, uint8_t& type, uint16_t& len) {
+  if (fread(buf, 1, MU_PKT_HEADER, f) != MU_PKT_HEADER) return false;
+  if (buf[0] != MU_PKT_SYNC0 || buf[1] != MU_PKT_SYNC1) return false;
+  type = buf[2];
+  len = (uint16_t)(buf[5] | (buf[6] << 8));
+  if (len < MU_REC_DT_BYTES || MU_PKT_HEADER + len + MU_PKT_TRAILER > MU_REC_MAX_BYTES) return false;
+  if (fread(buf + MU_PKT_HEADER, 1, len + MU_PKT_TRAILER, f) != (size_t)len + MU_PKT_TRAILER) return false;
+  uint16_t crc = (uint16_t)(buf[MU_PKT_HEADER + len] | (buf[MU_PKT_HEADER + len + 1] << 8));
+  return MU_Crc16(buf + 2, (size_t)(MU_PKT_HEADER - 2) + len) == crc;
+}
+
+// File sequence from a file's META record; false if missing or not a recording
+static inline bool MU_RecFileSeq(uint8_t file, uint32_t& seq) {
+  FILE* f = MU_RecOpen(file, "rb");
+  if (!f) return false;
+  uint8_t buf[MU_PKT_HEADER + 32];
+  bool ok = fread(buf, 1, sizeof(buf), f) >= MU_PKT_HEADER + MU_REC_DT_BYTES + 12 && buf[0] == MU_PKT_SYNC0 &&
+            buf[1] == MU_PKT_SYNC1 && buf[2] == MU_REC_META && memcmp(buf + MU_PKT_HEADER + MU_REC_DT_BYTES, "MUR1", 4) == 0;
+  if (ok) seq = MU_RecU32(buf + MU_PKT_HEADER + MU_REC_DT_BYTES + 8);
+  fclose(f);
+  return ok;
+}
+
+// Ring files in recording order, oldest first; returns how many hold a recording
+static inline uint8_t MU_RecFileOrder(uint8_t* order, uint32_t* seqs = nullptr) {
+  uint32_t seq[MU_REC_FILES];
+  uint8_t n = 0;
+  for (uint8_t f = 0; f < MU_REC_FILES; ++f) {
+    uint32_t s;
+    if (!MU_RecFileSeq(f, s)) continue;
+    uint8_t i = n++;
+    while (i > 0 && seq[i - 1] > s) {  // insertion sort, at most MU_REC_FILES entries
+      seq[i] = seq[i - 1];
+      order[i] = order[i - 1];
+      --i;
+    }
+    seq[i] = s;
+    order[i] = f;
+  }
+  if (seqs) memcpy(seqs, seq, n * sizeof(uint32_t));
+  return n;
+}
+
+// ---- Writer side (writer task, or inline on host builds) ----
+
+// Commit the file written so far (fclose commits on its own)
+static inline void MU_RecSync() {
+  MU_Rec.unsynced = 0;
+#if defined(ESP32)
+  if (MU_Rec.out) fsync(fileno(MU_Rec.out));
+#endif
+}
+
+static inline void MU_RecWritePage(MU_RecPage& pg) {
+  uint32_t t0 = micros();
+  if (pg.openFile >= 0) {
+    if (MU_Rec.out) fclose(MU_Rec.out);
+    MU_Rec.unsynced = 0;
+    MU_Rec.out = MU_RecOpen((uint8_t)pg.openFile, "wb");
+    if (MU_Rec.out) setvbuf(MU_Rec.out, nullptr, _IONBF, 0);  // already batched into a page
+  }
+  if (MU_Rec.out && pg.len) {
+    if (fwrite(pg.data, 1, pg.len, MU_Rec.out) != pg.len) MU_Rec.writeErrors.fetch_add(1, std::memory_order_relaxed);
+    fflush(MU_Rec.out);
+    if (++MU_Rec.unsynced >= MU_REC_SYNC_PAGES && !pg.close) MU_RecSync();
+  } else if (pg.len) {
+    MU_Rec.writeErrors.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (pg.close && MU_Rec.out) {
+    fclose(MU_Rec.out);
+    MU_Rec.out = nullptr;
+    MU_Rec.unsynced = 0;
+  }
+  uint32_t us = micros() - t0;
+  if (us > MU_Rec.maxWriteUs.load(std::memory_order_relaxed)) MU_Rec.maxWriteUs.store(us, std::memory_order_relaxed);
+  MU_Rec.pagesWritten.fetch_add(1, std::memory_order_relaxed);
+  pg.len = 0;
+  pg.openFile = -1;
+  pg.close = false;
+  pg.full.store(false, std::memory_order_release);
+}
+
+// Pages are submitted alternately, so writing them in the same order keeps the file byte order
+static inline void MU_RecWritePending() {
+  while (MU_Rec.pages[MU_Rec.nextWrite].full.load(std::memory_order_acquire)) {
+    MU_RecWritePage(MU_Rec.pages[MU_Rec.nextWrite]);
+    MU_Rec.nextWrite ^= 1;
+  }
+}
+
+#if defined(ESP32)
+inline TaskHandle_t MU_RecTaskHandle = nullptr;
+
+static void MU_RecTask(void*) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    MU_RecWritePending();
+  }
+}
+#endif
+
+// ---- Producer side (one thread, usually loop()) ----
+
+static inline void MU_RecSubmit() {
+  MU_RecPage& pg = MU_Rec.pages[MU_Rec.cur];
+  pg.full.store(true, std::memory_order_release);
+  MU_Rec.cur ^= 1;
+#if defined(ESP32)
+  if (MU_RecTaskHandle) xTaskNotifyGive(MU_RecTaskHandle);
+#else
+  MU_RecWritePending();
+#endif
+}
+
+static inline uint16_t MU_RecFinish(uint8_t type, uint16_t payloadLen, int64_t nowUs) {
+  int64_t dt = MU_Rec.lastUs ? nowUs - MU_Rec.lastUs : 0;
+  MU_RecPutU32(MU_Rec.rec + MU_PKT_HEADER, (uint32_t)(dt < 0 ? 0 : dt > 0xFFFFFFFF ? 0xFFFFFFFF : dt));
+  return (uint16_t)MU_FinishPacketSeq(MU_Rec.rec, type, MU_Rec.seq++, MU_REC_DT_BYTES + payloadLen);
+}
+
+static inline void MU_RecDrop() {
+  MU_Rec.dropped.fetch_add(1, std::memory_order_relaxed);
+  MU_Rec.keyPending = true;  // the frames recorded next must not depend on what was lost
+}
+
+// Append one finished record; false (and a keyframe next) if both pages are still being written
+static inline bool MU_RecPush(const uint8_t* data, uint16_t n) {
+  MU_RecPage* pg = &MU_Rec.pages[MU_Rec.cur];
+  uint16_t space = MU_REC_PAGE_BYTES - pg->len;
+  if (pg->full.load(std::memory_order_acquire) ||
+      (n > space && MU_Rec.pages[MU_Rec.cur ^ 1].full.load(std::memory_order_acquire))) {
+    MU_RecDrop();
+    return false;
+  }
+  uint16_t first = n < space ? n : space;
+  memcpy(pg->data + pg->len, data, first);
+  pg->len += first;
+  if (pg->len == MU_REC_PAGE_BYTES) {
+    MU_RecSubmit();
+    if (n > first) {  // the other page was checked free above
+      pg = &MU_Rec.pages[MU_Rec.cur];
+      memcpy(pg->data, data + first, n - first);
+      pg->len = n - first;
+    }
+  }
+  MU_Rec.fileBytes += n;
+  MU_Rec.records.fetch_add(1, std::memory_order_relaxed);
+  MU_Rec.bytes.fetch_add(n, std::memory_order_relaxed);
+  return true;
+}
+
+// Hand the current page off and put a META record at the start of the next file. dt keeps running
+// across files, so playback stays continuous.
+static inline void MU_RecStartFile() {
+  if (MU_Rec.pages[MU_Rec.cur].len) MU_RecSubmit();
+  MU_Rec.file = (uint8_t)((MU_Rec.file + 1) % MU_REC_FILES);
+  MU_Rec.fileSeq++;
+  MU_Rec.fileBytes = 0;
+  MU_Rec.keyPending = true;  // every file starts with a keyframe
+  MU_Rec.pages[MU_Rec.cur].openFile = MU_Rec.file;
+  uint8_t* p = MU_Rec.rec + MU_PKT_HEADER + MU_REC_DT_BYTES;
+  memcpy(p, "MUR1", 4);
+  p[4] = (uint8_t)MATRIX_WIDTH; p[5] = (uint8_t)(MATRIX_WIDTH >> 8);
+  p[6] = (uint8_t)MATRIX_HEIGHT; p[7] = (uint8_t)(MATRIX_HEIGHT >> 8);
+  MU_RecPutU32(p + 8, MU_Rec.fileSeq);
+  int64_t now = MU_NowUs();
+  if (MU_RecPush(MU_Rec.rec, MU_RecFinish(MU_REC_META, 12, now)) && MU_Rec.lastUs) MU_Rec.lastUs = now;
+}
+
+// Make room for an n-byte record, moving to the next file when this one is full
+static inline bool MU_RecRoom(uint16_t n) {
+  if (MU_Rec.fileBytes + n <= MU_REC_FILE_BYTES) return true;
+  uint8_t next = MU_Rec.pages[MU_Rec.cur].len ? MU_Rec.cur ^ 1 : MU_Rec.cur;
+  if (MU_Rec.pages[next].full.load(std::memory_order_acquire)) {
+    MU_RecDrop();
+    return false;
+  }
+  MU_RecStartFile();
+  return true;
+}
+
+// Continue the ring after the newest recording; false if the file system is unavailable
+static inline bool MU_RecordBegin() {
+  if (MU_Rec.active) return true;
+#if defined(ESP32)
+  if (!LittleFS.begin(true)) return false;  // formats on first use
+#endif
+  uint8_t order[MU_REC_FILES];
+  uint32_t seqs[MU_REC_FILES];
+  uint8_t n = MU_RecFileOrder(order, seqs);
+  MU_Rec.file = n ? order[n - 1] : MU_REC_FILES - 1;  // MU_RecStartFile moves to the next one
+  MU_Rec.fileSeq = n ? seqs[n - 1] : 0;
+#if defined(ESP32)
+  if (!MU_RecTaskHandle) {
+    BaseType_t core = xPortGetCoreID() == 0 ? 1 : 0;
+    xTaskCreatePinnedToCore(MU_RecTask, "mu_rec", MU_REC_TASK_STACK, nullptr, MU_REC_TASK_PRIO,
+                            &MU_RecTaskHandle, core);
+  }
+#endif
+  MU_Rec.active = true;
+  MU_Rec.lastUs = 0;  // a new session starts at dt 0
+  MU_Rec.imuHave = false;
+  MU_RecStartFile();
+  return true;
+}
+
+// Flush the partial page and close the file; waits (up to ~1 s) for the writer to finish
+static inline void MU_RecordStop() {
+  if (!MU_Rec.active) return;
+  MU_Rec.active = false;
+  uint32_t t0 = millis();
+  while (MU_Rec.pages[MU_Rec.cur].full.load(std::memory_order_acquire) && millis() - t0 < 1000) delay(1);
+  MU_Rec.pages[MU_Rec.cur].close = true;
+  MU_RecSubmit();
+  while ((MU_Rec.pages[0].full.load(std::memory_order_acquire) || MU_Rec.pages[1].full.load(std::memory_order_acquire)) &&
+         millis() - t0 < 1000)
+    delay(1);
+}
+
+// Record `frame` (physical order, e.g. the back buffer right after MU_Present()) if it changed.
+// `dirty` as for MU_SendFrameDelta: optional, but must cover every change since the last call.
+static inline void MU_RecordFrame(const CRGB* frame, const uint32_t* dirty = nullptr) {
+  if (!MU_Rec.active || !MU_RecRoom(MU_REC_MAX_BYTES)) return;
+  int64_t now = MU_NowUs();
+  uint8_t* payload = MU_Rec.rec + MU_PKT_HEADER + MU_REC_DT_BYTES;
+  int32_t len = -1;
+  if (!MU_Rec.keyPending && MU_Rec.sinceKey < MU_REC_KEYFRAME_INTERVAL) {
+    len = MU_DeltaEncode(frame, MU_Rec.prev, dirty, payload);
+    if (len == 0) return;
+  }
+  uint8_t type = MU_REC_DELTA;
+  if (len < 0) {
+    uint8_t* p = payload;
+    for (uint16_t i = 0; i < MU_NUM_LEDS; ++i) {
+      const CRGB& c = frame[MU_XYIndex(i)];
+      MU_Rec.prev[i] = c;
+      *p++ = c.r; *p++ = c.g; *p++ = c.b;
+    }
+    len = MU_NUM_LEDS * 3;
+    type = MU_REC_KEY;
+  }
+  uint16_t n = MU_RecFinish(type, (uint16_t)len, now);
+  if (!MU_RecPush(MU_Rec.rec, n)) return;
+  MU_Rec.lastUs = now;
+  if (type == MU_REC_KEY) {
+    MU_Rec.keyPending = false;
+    MU_Rec.sinceKey = 0;
+  } else {
+    ++MU_Rec.sinceKey;
+  }
+}
+
+// Present step that also records: pass to MU_SchedBegin instead of MU_Present
+static inline void MU_RecordPresent() {
+  MU_Present();
+  MU_RecordFrame(MU_BackBuffer(), MU_Render.dirtyTracking ? MU_PresentedDirty() : nullptr);
+}
+
+static inline void MU_RecordInput(uint8_t kind, const void* data, uint8_t len) {
+  if (!MU_Rec.active || len > MU_REC_INPUT_MAX || !MU_RecRoom(MU_PKT_HEADER + MU_REC_DT_BYTES + len + 1 + MU_PKT_TRAILER))
+    return;
+  int64_t now = MU_NowUs();
+  uint8_t* p = MU_Rec.rec + MU_PKT_HEADER + MU_REC_DT_BYTES;
+  p[0] = kind;
+  memcpy(p + 1, data, len);
+  uint16_t n = MU_RecFinish(MU_REC_INPUT, (uint16_t)(len + 1), now);
+  if (MU_RecPush(MU_Rec.rec, n)) MU_Rec.lastUs = now;
+}
+
+// Call once per input step; only a sample that moved past the deadband (and no sooner than
+// MU_REC_IMU_MIN_MS after the last one) becomes a record
+static inline void MU_RecordImu(float ax, float ay, float az, float gx = 0, float gy = 0, float gz = 0) {
+  if (!MU_Rec.active) return;
+  float v[6] = { ax, ay, az, gx, gy, gz };
+  int64_t now = MU_NowUs();
+  if (MU_Rec.imuHave) {
+    if (now - MU_Rec.imuUs < (int64_t)MU_REC_IMU_MIN_MS * 1000) return;
+    bool moved = false;
+    for (uint8_t i = 0; i < 6 && !moved; ++i) {
+      float band = i < 3 ? MU_REC_IMU_DEADBAND : MU_REC_IMU_DEADBAND * 10;
+      moved = fabsf(v[i] - MU_Rec.imuLast[i]) > band;
+    }
+    if (!moved) return;
+  }
+  uint32_t before = MU_Rec.records.load(std::memory_order_relaxed);
+  MU_RecordInput(MU_REC_IN_IMU, v, sizeof(v));  // little-endian float32, as the ESP32 stores them
+  if (MU_Rec.records.load(std::memory_order_relaxed) == before) return;  // dropped: retry next step
+  memcpy(MU_Rec.imuLast, v, sizeof(v));
+  MU_Rec.imuHave = true;
+  MU_Rec.imuUs = now;
+}
+
+static inline void MU_RecordRssi(const uint8_t* bssid, int8_t rssi, uint8_t channel) {
+  uint8_t v[8];
+  memcpy(v, bssid, 6);
+  v[6] = (uint8_t)rssi;
+  v[7] = channel;
+  MU_RecordInput(MU_REC_IN_RSSI, v, sizeof(v));
+}
+
+// Send every ring file, oldest first, over MU_SerialWrite (the viewer plays the stream as it arrives)
+static inline void MU_RecordDump() {
+  bool was = MU_Rec.active;
+  MU_RecordStop();
+  uint8_t order[MU_REC_FILES];
+  uint8_t n = MU_RecFileOrder(order);
+  uint8_t buf[256];
+  for (uint8_t i = 0; i < n; ++i) {
+    FILE* f = MU_RecOpen(order[i], "rb");
+    if (!f) continue;
+    size_t got;
+    while ((got = fread(buf, 1, sizeof(buf), f)) > 0) MU_SerialWrite(buf, got);
+    fclose(f);
+  }
+  if (was) MU_RecordBegin();
+}
+
+// ---- Playback ----
+
+inline void (*MU_PlayInputHook)(uint8_t kind, const uint8_t* data, uint8_t len) = nullptr;
+
+struct MU_PlayState {
+  FILE* in = nullptr;
+  uint8_t order[MU_REC_FILES];
+  uint8_t files = 0;
+  uint8_t pos = 0;
+  bool active = false;
+  bool loop = false;
+  bool pending = false;                  // rec holds a record not applied yet
+  bool haveKey = false;                  // deltas wait for a keyframe
+  bool fresh = true;                     // first record: its dt points before the recording
+  uint8_t type = 0;
+  uint16_t len = 0;
+  int64_t startUs = 0;                   // playback time of the current file's first record
+  int64_t recUs = 0;                     // record time within the file
+  uint8_t rec[MU_REC_MAX_BYTES];
+};
+
+inline MU_PlayState MU_Play;
+
+// Next file continues the timeline where the previous one ended
+static inline bool MU_PlayOpenNext() {
+  if (MU_Play.in) fclose(MU_Play.in);
+  MU_Play.in = nullptr;
+  MU_Play.startUs += MU_Play.recUs;
+  MU_Play.recUs = 0;
+  while (MU_Play.pos < MU_Play.files) {
+    MU_Play.in = MU_RecOpen(MU_Play.order[MU_Play.pos++], "rb");
+    if (MU_Play.in) return true;
+  }
+  return false;
+}
+
+// Start replaying the ring; false if recording (MU_RecordStop() first) or nothing is recorded
+static inline bool MU_PlayBegin(bool loop = false) {
+  if (MU_Rec.active) return false;
+#if defined(ESP32)
+  if (!LittleFS.begin(false)) return false;
+#endif
+  MU_Play.files = MU_RecFileOrder(MU_Play.order);
+  MU_Play.pos = 0;
+  MU_Play.loop = loop;
+  MU_Play.pending = false;
+  MU_Play.haveKey = false;
+  MU_Play.fresh = true;
+  MU_Play.startUs = MU_NowUs();
+  MU_Play.recUs = 0;
+  MU_Play.active = MU_PlayOpenNext();
+  return MU_Play.active;
+}
+
+static inline void MU_PlayStop() {
+  if (MU_Play.in) fclose(MU_Play.in);
+  MU_Play.in = nullptr;
+  MU_Play.active = false;
+}
+
+static inline bool MU_PlayActive() {
+  return MU_Play.active;
+}
+
+// Fetch the next record (across files); false once the ring is exhausted
+static inline bool MU_PlayFetch() {
+  while (!MU_Play.pending) {
+    if (MU_Play.in && MU_RecRead(MU_Play.in, MU_Play.rec, MU_Play.type, MU_Play.len)) {
+      MU_Play.pending = true;
+      break;
+    }
+    if (MU_PlayOpenNext()) continue;
+    if (!MU_Play.loop || MU_Play.files == 0) return false;
+    MU_Play.pos = 0;
+    MU_Play.haveKey = false;
+    MU_Play.fresh = true;
+    if (!MU_PlayOpenNext()) return false;
+  }
+  return true;
+}
+
+static inline uint32_t MU_PlayDt() {
+  return MU_Play.fresh ? 0 : MU_RecU32(MU_Play.rec + MU_PKT_HEADER);
+}
+
+static inline void MU_PlayPut(CRGB* frame, uint16_t i, const uint8_t* rgb) {
+  CRGB c(rgb[0], rgb[1], rgb[2]);
+  CRGB& px = frame[MU_XYIndex(i)];
+  if (px == c) return;
+  px = c;
+  if (MU_Render.dirtyTracking) MU_MarkDirty((uint8_t)(i % MATRIX_WIDTH), (uint8_t)(i / MATRIX_WIDTH));
+}
+
+static inline void MU_PlayApply() {
+  const uint8_t* p = MU_Play.rec + MU_PKT_HEADER + MU_REC_DT_BYTES;
+  uint16_t n = MU_Play.len - MU_REC_DT_BYTES;
+  CRGB* frame = MU_BackBuffer();
+  if (MU_Play.type == MU_REC_KEY && n == MU_NUM_LEDS * 3) {
+    for (uint16_t i = 0; i < MU_NUM_LEDS; ++i) MU_PlayPut(frame, i, p + i * 3);
+    MU_Play.haveKey = true;
+  } else if (MU_Play.type == MU_REC_DELTA && MU_Play.haveKey) {
+    uint16_t k = 0;
+    while (k + MU_DELTA_RUN_HEADER <= n) {
+      uint16_t start = (uint16_t)(p[k] | (p[k + 1] << 8));
+      uint8_t count = p[k + 2];
+      k += MU_DELTA_RUN_HEADER;
+      if (k + count * 3u > n || start + count > MU_NUM_LEDS) break;
+      for (uint8_t j = 0; j < count; ++j, k += 3) MU_PlayPut(frame, start + j, p + k);
+    }
+  } else if (MU_Play.type == MU_REC_INPUT && n >= 1 && MU_PlayInputHook) {
+    MU_PlayInputHook(p[0], p + 1, (uint8_t)(n - 1));
+  }
+}
+
+// Time the next record is due (MU_NowUs clock); only valid while MU_PlayActive()
+static inline int64_t MU_PlayNextUs() {
+  if (!MU_Play.pending) return MU_NowUs();
+  return MU_Play.startUs + MU_Play.recUs + MU_PlayDt();
+}
+
+// Apply every record due by nowUs to the back buffer; true while playing (skip the normal drawing)
+static inline bool MU_PlayRender(int64_t nowUs = MU_NowUs()) {
+  if (!MU_Play.active) return false;
+  while (MU_PlayFetch()) {
+    if (MU_PlayNextUs() > nowUs) return true;
+    MU_Play.recUs += MU_PlayDt();
+    MU_Play.fresh = false;
+    MU_PlayApply();
+    MU_Play.pending = false;
+  }
+  MU_PlayStop();  // the last frame stays in the back buffer
+  return true;
+}
+
+// Replay the whole ring at the recorded timing, presenting each frame (blocks; setup() or a debug mode)
+static inline void MU_PlayRun(bool loop = false) {
+  if (!MU_PlayBegin(loop)) return;
+  while (MU_PlayRender()) {
+    MU_Present();
+    if (!MU_Play.active) break;
+    int64_t wait = MU_PlayNextUs() - MU_NowUs();
+    if (wait >= 1000) delay((uint32_t)(wait / 1000));
+    else if (wait > 0) delayMicroseconds((uint32_t)wait);
+  }
+}
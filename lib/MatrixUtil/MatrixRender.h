@@ -0,0 +1,255 @@
+// MatrixRender.h - Dual-core render pipeline for MatrixUtil sketches
+// Usage: include after MatrixUtil.h. Register LEDs as usual (MU_ADD_LEDS or a NeoPixel strip), then
+// call MU_RenderBegin(showFn) once in setup(). loop() draws into MU_BackBuffer() (physical LED order,
+// index with MU_XY) and calls MU_Present(); an output task on the other core pushes the frame to the
+// LEDs, so WS2812 transmission time is no longer charged to the game tick.
+// Provides:
+//  - MU_RenderBegin(show): starts the output task. The three frames are static, or allocated here in
+//    PSRAM when MU_FB_PSRAM (large tiled canvases, see MatrixCanvas.h): draw only after this call.
+//    False if those frames could not be allocated (nothing may be drawn) or the task could not be
+//    created (MU_Present() then shows on the caller, as on host builds).
+//  - MU_BackBuffer(): frame owned by loop(); starts as a copy of the last presented frame.
+//  - MU_Present(): publishes the back buffer without waiting for the LEDs; a frame identical to the
+//    last presented one is dropped (no LED transmission) unless MU_RenderInvalidate() was called.
+//  - MU_RenderInvalidate(): present the next frame even if unchanged (e.g. after MU_SetBrightness).
+//  - MU_SetPixel(x, y, c) / MU_MarkDirty(x, y) / MU_MarkAllDirty(): report changed pixels. Once a
+//    sketch marks pixels, MU_Present() trusts the marks instead of comparing frames: nothing
+//    marked = nothing sent. MU_PresentedDirty() is the mask of the last present, for
+//    MU_SendFrameDelta(frame, mask) so the LEDs and the serial stream share one diff.
+//  - MU_ShowLeds (MatrixUtil.h, FastLED) / MU_ShowNeoPixel<Strip, strip>: output callbacks for the
+//    two LED libraries; both go through the RMT driver instead when the board profile selects LED_BACKEND MU_BACKEND_RMT.
+//  - MU_RenderStats(): frames shown, superseded before output, skipped as unchanged, last show() duration.
+//  - MU_RenderIdle(): no frame waiting or being sent, e.g. before light sleep (MatrixIdle.h).
+//  - MU_RenderFilterHook: optional pass over each frame right before show(), on the output task; it
+//    returns the frame to send (its own buffer if it changed anything). MatrixPower.h installs one.
+
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <atomic>
+
+#ifndef MU_RENDER_TASK_PRIO
+#define MU_RENDER_TASK_PRIO 2
+#endif
+#ifndef MU_RENDER_TASK_STACK
+#define MU_RENDER_TASK_STACK 4096
+#endif
+#ifndef MU_RENDER_SKIP_UNCHANGED
+#define MU_RENDER_SKIP_UNCHANGED 1     // 0: every MU_Present() reaches the LEDs
+#endif
+
+// Output callback: push `count` LEDs (physical order) to the strip; may block, runs on the output task
+typedef void (*MU_ShowFn)(const CRGB* frame, uint16_t count);
+// Frame filter: returns `frame` itself or a buffer it owns holding the adjusted frame
+typedef const CRGB* (*MU_FilterFn)(const CRGB* frame, uint16_t count);
+
+// Three frames: back (loop draws), mailbox (latest presented, not yet shown) and front (on the wire).
+// Present and the output task only exchange indices, so neither side ever waits for the other.
+#define MU_RENDER_FRESH 0x80
+
+struct MU_RenderState {
+#if MU_FB_PSRAM
+  CRGB (*frames)[MU_NUM_LEDS] = nullptr; // 3 frames from MU_FrameAlloc() in MU_RenderBegin
+#else
+  CRGB frames[3][MU_NUM_LEDS];
+#endif
+  uint8_t back = 0;                      // owned by loop()
+  uint8_t front = 2;                     // owned by the output task
+  std::atomic<uint8_t> mailbox{1};       // index | MU_RENDER_FRESH when unseen
+  std::atomic<uint32_t> shown{0};
+  std::atomic<uint32_t> superseded{0};   // presented but replaced before the task could show them
+  std::atomic<uint32_t> skipped{0};      // presents dropped because the frame had not changed
+  std::atomic<uint32_t> lastShowUs{0};
+  std::atomic<bool> showing{false};      // output task between taking a frame and finishing show()
+  // Last presented frame: it stays in the mailbox or front slot, untouched, until the next present
+  uint8_t lastPresented = 0xFF;          // owned by loop(); 0xFF = none / invalidated
+  // Dirty marks (logical XY index bits, see MU_DIRTY_WORDS), all owned by loop()
+  uint32_t dirty[MU_DIRTY_WORDS] = {};          // marked since the last present
+  uint32_t presentedDirty[MU_DIRTY_WORDS] = {}; // what the last present changed
+  bool dirtyTracking = false;
+  MU_ShowFn show = nullptr;
+};
+
+inline MU_RenderState MU_Render;
+inline MU_FilterFn MU_RenderFilterHook = nullptr;  // set before MU_RenderBegin
+
+struct MU_RenderStatsData {
+  uint32_t shown;
+  uint32_t superseded;
+  uint32_t skipped;
+  uint32_t lastShowUs;
+};
+
+static inline MU_RenderStatsData MU_RenderStats() {
+  return { MU_Render.shown.load(std::memory_order_relaxed),
+           MU_Render.superseded.load(std::memory_order_relaxed),
+           MU_Render.skipped.load(std::memory_order_relaxed),
+           MU_Render.lastShowUs.load(std::memory_order_relaxed) };
+}
+
+static inline CRGB* MU_BackBuffer() {
+  return MU_Render.frames[MU_Render.back];
+}
+
+static inline void MU_MarkDirty(uint8_t x, uint8_t y) {
+  uint16_t i = (uint16_t)y * MATRIX_WIDTH + x;
+  MU_Render.dirty[i >> 5] |= (uint32_t)1 << (i & 31);
+  MU_Render.dirtyTracking = true;
+}
+
+static inline void MU_MarkAllDirty() {
+  for (uint16_t w = 0; w < MU_DIRTY_WORDS; ++w) MU_Render.dirty[w] = 0xFFFFFFFFu;
+  MU_Render.dirtyTracking = true;
+}
+
+// Draw one pixel into the back buffer, marking it only if the color actually changes
+static inline void MU_SetPixel(uint8_t x, uint8_t y, const CRGB& c) {
+  CRGB& px = MU_BackBuffer()[MU_XY(x, y)];
+  if (px == c) return;
+  px = c;
+  MU_MarkDirty(x, y);
+}
+
+static inline const uint32_t* MU_PresentedDirty() {
+  return MU_Render.presentedDirty;
+}
+
+static inline void MU_RenderInvalidate() {
+  MU_Render.lastPresented = 0xFF;
+  if (MU_Render.dirtyTracking) MU_MarkAllDirty();
+}
+
+// True when the back buffer equals the frame presented last (so presenting it again is pointless).
+// With dirty tracking the marks decide and move to presentedDirty; otherwise the frames are compared.
+static inline bool MU_RenderUnchanged() {
+  if (MU_Render.dirtyTracking) {
+    uint32_t any = 0;
+    for (uint16_t w = 0; w < MU_DIRTY_WORDS; ++w) {
+      any |= MU_Render.dirty[w];
+      MU_Render.presentedDirty[w] = MU_Render.dirty[w];
+      MU_Render.dirty[w] = 0;
+    }
+    if (any) return false;
+    MU_Render.skipped.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+#if MU_RENDER_SKIP_UNCHANGED
+  if (MU_Render.lastPresented == 0xFF) return false;
+  if (memcmp(MU_Render.frames[MU_Render.back], MU_Render.frames[MU_Render.lastPresented],
+             sizeof(MU_Render.frames[0])) != 0)
+    return false;
+  MU_Render.skipped.fetch_add(1, std::memory_order_relaxed);
+  return true;
+#else
+  return false;
+#endif
+}
+
+// False when the frames live on the heap and neither PSRAM nor internal RAM could hold them
+static inline bool MU_RenderAllocFrames() {
+#if MU_FB_PSRAM
+  if (!MU_Render.frames) MU_Render.frames = (CRGB(*)[MU_NUM_LEDS])MU_FrameAlloc(3 * sizeof(CRGB) * MU_NUM_LEDS);
+  return MU_Render.frames != nullptr;
+#else
+  return true;
+#endif
+}
+
+static inline void MU_RenderShowFront() {
+  MU_PROFILE_SCOPE("show");
+  uint32_t t0 = micros();
+  const CRGB* frame = MU_Render.frames[MU_Render.front];
+  if (MU_RenderFilterHook) frame = MU_RenderFilterHook(frame, MU_NUM_LEDS);
+  MU_Render.show(frame, MU_NUM_LEDS);
+  MU_Render.lastShowUs.store(micros() - t0, std::memory_order_relaxed);
+  MU_Render.shown.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Adafruit_NeoPixel-style output, e.g. MU_RenderBegin(MU_ShowNeoPixel<Adafruit_NeoPixel, pixels>).
+// With the RMT backend the strip object only supplies pin, length and brightness.
+template <class Strip, Strip& S>
+void MU_ShowNeoPixel(const CRGB* frame, uint16_t count) {
+#if LED_BACKEND == MU_BACKEND_RMT
+  if (MU_RmtStripCount == 0) MU_RmtBegin(S.getPin(), S.numPixels());
+  MU_RmtShow(frame, count, S.getBrightness());
+#else
+  for (uint16_t i = 0; i < count; ++i) S.setPixelColor(i, frame[i].r, frame[i].g, frame[i].b);
+  S.show();
+#endif
+}
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+inline TaskHandle_t MU_RenderTaskHandle = nullptr;
+
+// Show mailbox frames until none is fresh (the output task's loop body)
+static inline void MU_RenderDrain() {
+  // Only the consumer clears FRESH, so a fresh mailbox stays fresh until this exchange
+  while (MU_Render.mailbox.load(std::memory_order_acquire) & MU_RENDER_FRESH) {
+    MU_Render.showing.store(true);     // before the exchange clears FRESH, so MU_RenderIdle never sees a gap
+    uint8_t m = MU_Render.mailbox.exchange(MU_Render.front, std::memory_order_acq_rel);
+    MU_Render.front = m & ~MU_RENDER_FRESH;
+    MU_RenderShowFront();
+  }
+  MU_Render.showing.store(false);
+}
+
+static void MU_RenderTask(void*) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    MU_RenderDrain();
+  }
+}
+
+// Start the output task on the core loop() is NOT running on
+static inline bool MU_RenderBegin(MU_ShowFn show = MU_ShowLeds) {
+  if (MU_RenderTaskHandle) return true;
+  if (!MU_RenderAllocFrames()) return false;
+  MU_Render.show = show;
+  BaseType_t core = xPortGetCoreID() == 0 ? 1 : 0;
+  if (xTaskCreatePinnedToCore(MU_RenderTask, "mu_render", MU_RENDER_TASK_STACK, nullptr,
+                              MU_RENDER_TASK_PRIO, &MU_RenderTaskHandle, core) != pdPASS) {
+    MU_RenderTaskHandle = nullptr;
+    return false;                      // MU_Present() shows inline instead
+  }
+  return true;
+}
+
+// Publish the back buffer; the next back buffer starts as a copy of it so incremental drawing works
+static inline void MU_Present() {
+  if (MU_RenderUnchanged()) return;
+  uint8_t presented = MU_Render.back;
+  MU_Render.lastPresented = presented;
+  uint8_t old = MU_Render.mailbox.exchange(presented | MU_RENDER_FRESH, std::memory_order_acq_rel);
+  if (old & MU_RENDER_FRESH) MU_Render.superseded.fetch_add(1, std::memory_order_relaxed);
+  MU_Render.back = old & ~MU_RENDER_FRESH;
+  memcpy(MU_Render.frames[MU_Render.back], MU_Render.frames[presented], sizeof(MU_Render.frames[0]));
+  if (MU_RenderTaskHandle) xTaskNotifyGive(MU_RenderTaskHandle);
+  else if (MU_Render.show) MU_RenderDrain();  // no output task: show on the caller
+}
+
+static inline bool MU_RenderIdle() {
+  return !(MU_Render.mailbox.load() & MU_RENDER_FRESH) && !MU_Render.showing.load();
+}
+#else
+// No RTOS (host builds): present shows synchronously
+static inline bool MU_RenderBegin(MU_ShowFn show = MU_ShowLeds) {
+  if (!MU_RenderAllocFrames()) return false;
+  MU_Render.show = show;
+  return true;
+}
+
+static inline void MU_Present() {
+  if (MU_RenderUnchanged()) return;
+  MU_Render.lastPresented = MU_Render.front;
+  memcpy(MU_Render.frames[MU_Render.front], MU_Render.frames[MU_Render.back], sizeof(MU_Render.frames[0]));
+  MU_RenderShowFront();
+}
+
+static inline bool MU_RenderIdle() {
+  return true;
+}
+#endif
@@ -0,0 +1,75 @@
+// MatrixRing.h - Lock-free hand-off primitives between the sensor/output tasks and loop()
+// Provides:
+//  - MU_SpscRing<T, N>: single-producer single-consumer queue of N (power of two) items.
+//    push() never blocks (returns false when full), pop() returns false when empty.
+//  - MU_Latest<T>: triple-buffered "newest value" slot. publish() and take() never wait for each
+//    other; take() only reports values that have not been taken yet.
+// Both sides may run on different cores; neither uses a lock or disables interrupts.
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+template <class T, uint16_t N>
+class MU_SpscRing {
+  static_assert((N & (N - 1)) == 0 && N >= 2, "MU_SpscRing size must be a power of two");
+
+ public:
+  bool push(const T& v) {
+    uint16_t h = head_.load(std::memory_order_relaxed);
+    if ((uint16_t)(h - tail_.load(std::memory_order_acquire)) >= N) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    items_[h & (N - 1)] = v;
+    head_.store((uint16_t)(h + 1), std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T& out) {
+    uint16_t t = tail_.load(std::memory_order_relaxed);
+    if (t == head_.load(std::memory_order_acquire)) return false;
+    out = items_[t & (N - 1)];
+    tail_.store((uint16_t)(t + 1), std::memory_order_release);
+    return true;
+  }
+
+  uint16_t size() const {
+    return (uint16_t)(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+  }
+
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  T items_[N];
+  std::atomic<uint16_t> head_{0};      // written by the producer only
+  std::atomic<uint16_t> tail_{0};      // written by the consumer only
+  std::atomic<uint32_t> dropped_{0};
+};
+
+// Same index-exchange scheme as the render mailbox (MatrixRender.h), for any copyable T
+template <class T>
+class MU_Latest {
+ public:
+  void publish(const T& v) {
+    slots_[write_] = v;
+    uint8_t old = mailbox_.exchange(write_ | kFresh, std::memory_order_acq_rel);
+    write_ = old & ~kFresh;
+  }
+
+  bool take(T& out) {
+    if (!(mailbox_.load(std::memory_order_acquire) & kFresh)) return false;
+    uint8_t m = mailbox_.exchange(read_, std::memory_order_acq_rel);
+    read_ = m & ~kFresh;
+    out = slots_[read_];
+    return true;
+  }
+
+ private:
+  static constexpr uint8_t kFresh = 0x80;
+  T slots_[3];
+  uint8_t write_ = 0;                  // owned by the producer
+  uint8_t read_ = 2;                   // owned by the consumer
+  std::atomic<uint8_t> mailbox_{1};
+};
@@ -0,0 +1,251 @@
+// MatrixSched.h - Frame-pacing scheduler with frame-time instrumentation
+// Usage: include after MatrixUtil.h (and MatrixRender.h when MU_Present is the present step). In setup() call
+// MU_SchedBegin(updateUs, update, renderUs, render, present); loop() then only calls MU_SchedRun().
+// update() runs at a fixed timestep (catching up at most MU_SCHED_MAX_CATCHUP steps; the rest is
+// dropped and counted as missed); render()+present() run when their deadline is due. Between
+// deadlines the loop task sleeps with vTaskDelayUntil, so nothing busy-waits or calls delay().
+// Provides:
+//  - MU_NowUs(): monotonic microseconds (esp_timer on ESP32).
+//  - MU_SchedBegin / MU_SchedRun: configure, run one pass (the whole of loop()).
+//  - MU_SchedSetUpdateUs(us) / MU_SchedSetRenderUs(us) / MU_SchedSetCatchUp(steps): retime update or
+//    render (periods clamped to MU_SCHED_MIN_PERIOD_US), limit catch-up after stalls.
+//  - MU_SchedPrintStats(): one STATS: line with per-phase duration histograms (also on host 'S').
+//  - MU_Hist / MU_HistAdd / MU_HistPercentile: log2 microsecond histogram used for the stats.
+// With MU_PROFILE the three phases are also MU_PROFILE_SCOPE sections, and MU_SchedRun() services the
+// PROFILE: report (MatrixProfile.h).
+
+#pragma once
+
+#include <Arduino.h>
+
+#if defined(ESP32)
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#ifndef MU_SCHED_MAX_CATCHUP
+#define MU_SCHED_MAX_CATCHUP 4        // update steps run back-to-back after a stall
+#endif
+#ifndef MU_SCHED_MIN_PERIOD_US
+#define MU_SCHED_MIN_PERIOD_US 1000   // shorter (or 0) periods are raised to this: waits are whole ticks
+#endif
+#ifndef MU_SCHED_HOST_STATS_REQ
+#define MU_SCHED_HOST_STATS_REQ 1     // a host 'S' on Serial prints a STATS line
+#endif
+#ifndef MU_SCHED_STATS_INTERVAL_MS
+#define MU_SCHED_STATS_INTERVAL_MS 0  // >0: also print STATS periodically
+#endif
+
+static inline int64_t MU_NowUs() {
+#if defined(ESP32)
+  return esp_timer_get_time();
+#else
+  return (int64_t)micros();
+#endif
+}
+
+// Bucket b counts durations in [2^(b-1), 2^b) us; bucket 0 is < 1 us, the last one is open-ended.
+#define MU_HIST_BUCKETS 16
+
+struct MU_Hist {
+  uint32_t bucket[MU_HIST_BUCKETS];
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t sumUs;
+};
+
+static inline void MU_HistAdd(MU_Hist& h, uint32_t us) {
+  uint8_t b = us ? (uint8_t)(32 - __builtin_clz(us)) : 0;
+  if (b >= MU_HIST_BUCKETS) b = MU_HIST_BUCKETS - 1;
+  h.bucket[b]++;
+  h.count++;
+  h.sumUs += us;
+  if (us > h.maxUs) h.maxUs = us;
+}
+
+// Upper bound of the bucket holding the pct-th percentile (capped at the observed max)
+static inline uint32_t MU_HistPercentile(const MU_Hist& h, uint8_t pct) {
+  if (!h.count) return 0;
+  uint32_t rank = ((uint64_t)h.count * pct + 99) / 100, seen = 0;
+  for (uint8_t b = 0; b < MU_HIST_BUCKETS; ++b) {
+    seen += h.bucket[b];
+    if (seen >= rank) return b == MU_HIST_BUCKETS - 1 ? h.maxUs : min((uint32_t)1u << b, h.maxUs);
+  }
+  return h.maxUs;
+}
+
+struct MU_SchedState {
+  void (*update)() = nullptr;
+  void (*render)() = nullptr;
+  void (*present)() = nullptr;
+  uint32_t updateUs = 0;
+  uint32_t renderUs = 0;
+  uint8_t maxCatchUp = MU_SCHED_MAX_CATCHUP;
+  int64_t nextUpdate = 0;
+  int64_t nextRender = 0;
+  int64_t statsSince = 0;
+  uint32_t missedUpdates = 0;  // steps dropped after falling more than MU_SCHED_MAX_CATCHUP behind
+  uint32_t missedRenders = 0;  // render deadlines that passed a whole period late
+  MU_Hist upd, ren, pre, late; // late = update start minus its deadline
+};
+
+inline MU_SchedState MU_Sched;
+
+static inline void MU_SchedResetStats() {
+  MU_Sched.upd = MU_Hist{};
+  MU_Sched.ren = MU_Hist{};
+  MU_Sched.pre = MU_Hist{};
+  MU_Sched.late = MU_Hist{};
+  MU_Sched.missedUpdates = 0;
+  MU_Sched.missedRenders = 0;
+  MU_Sched.statsSince = MU_NowUs();
+}
+
+// Update/render period, clamped: a 0 would divide by zero and a sub-tick one only runs in catch-up bursts
+static inline uint32_t MU_SchedPeriod(uint32_t us) {
+  return us < MU_SCHED_MIN_PERIOD_US ? MU_SCHED_MIN_PERIOD_US : us;
+}
+
+// renderUs defaults to the board's FRAME_RATE_MS; render/present may be null. Periods below
+// MU_SCHED_MIN_PERIOD_US (including 0) are raised to it.
+static inline void MU_SchedBegin(uint32_t updateUs, void (*update)(),
+                                 uint32_t renderUs = (uint32_t)FRAME_RATE_MS * 1000,
+                                 void (*render)() = nullptr, void (*present)() = nullptr) {
+  MU_Sched.update = update;
+  MU_Sched.render = render;
+  MU_Sched.present = present;
+  MU_Sched.updateUs = MU_SchedPeriod(updateUs);
+  MU_Sched.renderUs = MU_SchedPeriod(renderUs);
+  int64_t now = MU_NowUs();
+  MU_Sched.nextUpdate = now;
+  MU_Sched.nextRender = now;
+  MU_SchedResetStats();
+}
+
+// Change the update period from now on (e.g. game speed-up); the next step keeps its deadline.
+// Clamped as in MU_SchedBegin.
+static inline void MU_SchedSetUpdateUs(uint32_t us) {
+  MU_Sched.updateUs = MU_SchedPeriod(us);
+}
+
+static inline void MU_SchedSetRenderUs(uint32_t us) {
+  MU_Sched.renderUs = MU_SchedPeriod(us);
+}
+
+// Steps allowed back-to-back after a stall; 1 for updates that are themselves slow (e.g. WiFi scans)
+static inline void MU_SchedSetCatchUp(uint8_t steps) {
+  MU_Sched.maxCatchUp = steps ? steps : 1;
+}
+
+static inline int MU_HistFormat(char* out, size_t cap, const char* name, const MU_Hist& h) {
+  int n = snprintf(out, cap, ",%s=%lu/%lu/%lu/%lu/%lu,%s_h=", name, (unsigned long)h.count,
+                   (unsigned long)(h.count ? h.sumUs / h.count : 0),
+                   (unsigned long)MU_HistPercentile(h, 50), (unsigned long)MU_HistPercentile(h, 99),
+                   (unsigned long)h.maxUs, name);
+  int last = MU_HIST_BUCKETS - 1;
+  while (last > 0 && !h.bucket[last]) --last;
+  for (int b = 0; b <= last && n > 0 && (size_t)n < cap; ++b)
+    n += snprintf(out + n, cap - n, b ? ".%lu" : "%lu", (unsigned long)h.bucket[b]);
+  return n;
+}
+
+// STATS:ms=<window>,upd=n/avg/p50/p99/max,upd_h=<bucket counts>,...,miss_upd=..,miss_ren=..
+// All durations in us; p50/p99 are histogram bucket upper bounds. Resets the window by default.
+static inline void MU_SchedPrintStats(bool reset = true) {
+  char buf[512];
+  int n = snprintf(buf, sizeof(buf), "STATS:ms=%lu",
+                   (unsigned long)((MU_NowUs() - MU_Sched.statsSince) / 1000));
+  const char* names[4] = { "upd", "ren", "pre", "late" };
+  const MU_Hist* hists[4] = { &MU_Sched.upd, &MU_Sched.ren, &MU_Sched.pre, &MU_Sched.late };
+  for (uint8_t i = 0; i < 4 && n > 0 && (size_t)n < sizeof(buf); ++i)
+    n += MU_HistFormat(buf + n, sizeof(buf) - n, names[i], *hists[i]);
+  if (n > 0 && (size_t)n < sizeof(buf))
+    n += snprintf(buf + n, sizeof(buf) - n, ",miss_upd=%lu,miss_ren=%lu\r\n",
+                  (unsigned long)MU_Sched.missedUpdates, (unsigned long)MU_Sched.missedRenders);
+  if (n > 0) MU_SerialWrite((const uint8_t*)buf, (size_t)min(n, (int)sizeof(buf) - 1));
+  if (reset) MU_SchedResetStats();
+}
+
+#if MU_SCHED_HOST_STATS_REQ
+static inline void MU_SchedHostStats() {
+  MU_SchedPrintStats();
+}
+static const bool MU_SchedHostStatsCmd = MU_HostOn('S', MU_SchedHostStats);
+#endif
+
+// Block until `deadline`; rounds up to the next RTOS tick so wake-ups are never early
+static inline void MU_SchedSleepUntil(int64_t deadline) {
+  int64_t remain = deadline - MU_NowUs();
+  if (remain <= 0) return;
+#if defined(ESP32)
+  const int64_t tickUs = 1000LL * portTICK_PERIOD_MS;
+  TickType_t wake = xTaskGetTickCount();
+  vTaskDelayUntil(&wake, (TickType_t)((remain + tickUs - 1) / tickUs));
+#else
+  delayMicroseconds((unsigned int)remain);
+#endif
+}
+
+// One scheduler pass: due updates, due render/present, then sleep until the next deadline
+static inline void MU_SchedRun() {
+  MU_HostService();
+  #if MU_SCHED_STATS_INTERVAL_MS > 0
+    if (MU_NowUs() - MU_Sched.statsSince >= (int64_t)MU_SCHED_STATS_INTERVAL_MS * 1000) MU_SchedPrintStats();
+  #endif
+  MU_ProfileService();
+
+  int64_t now = MU_NowUs();
+  if (MU_Sched.update) {
+    uint8_t steps = 0;
+    while (now >= MU_Sched.nextUpdate && steps < MU_Sched.maxCatchUp) {
+      MU_HistAdd(MU_Sched.late, (uint32_t)(now - MU_Sched.nextUpdate));
+      {
+        MU_PROFILE_SCOPE("upd");
+        MU_Sched.update();
+      }
+      int64_t t1 = MU_NowUs();
+      MU_HistAdd(MU_Sched.upd, (uint32_t)(t1 - now));
+      MU_Sched.nextUpdate += MU_Sched.updateUs;
+      now = t1;
+      ++steps;
+    }
+    if (now >= MU_Sched.nextUpdate) {
+      // Too far behind to catch up: drop the backlog instead of spiralling
+      uint32_t behind = (uint32_t)((now - MU_Sched.nextUpdate) / MU_Sched.updateUs) + 1;
+      MU_Sched.missedUpdates += behind;
+      MU_Sched.nextUpdate += (int64_t)behind * MU_Sched.updateUs;
+    }
+  }
+
+  if ((MU_Sched.render || MU_Sched.present) && now >= MU_Sched.nextRender) {
+    if (MU_Sched.render) {
+      {
+        MU_PROFILE_SCOPE("ren");
+        MU_Sched.render();
+      }
+      int64_t t1 = MU_NowUs();
+      MU_HistAdd(MU_Sched.ren, (uint32_t)(t1 - now));
+      now = t1;
+    }
+    if (MU_Sched.present) {
+      {
+        MU_PROFILE_SCOPE("pre");
+        MU_Sched.present();
+      }
+      int64_t t1 = MU_NowUs();
+      MU_HistAdd(MU_Sched.pre, (uint32_t)(t1 - now));
+      now = t1;
+    }
+    MU_Sched.nextRender += MU_Sched.renderUs;
+    if (now >= MU_Sched.nextRender) {
+      MU_Sched.missedRenders += (uint32_t)((now - MU_Sched.nextRender) / MU_Sched.renderUs) + 1;
+      MU_Sched.nextRender = now + MU_Sched.renderUs;
+    }
+  }
+
+  int64_t next = MU_Sched.nextUpdate;
+  if ((MU_Sched.render || MU_Sched.present) && (!MU_Sched.update || MU_Sched.nextRender < next))
+    next = MU_Sched.nextRender;
+  MU_SchedSleepUntil(next);
+}
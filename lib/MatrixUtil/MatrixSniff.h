@@ -0,0 +1,145 @@
+// MatrixSniff.h - Promiscuous-mode RSSI sampling of one access point
+// Usage: after WiFi.mode(WIFI_STA), call MU_SniffBegin(channel, ssid) and MU_SniffWatch(bssid) for
+// each AP of interest. The radio stays on that channel and every beacon/data frame a watched AP
+// transmits (802.11 addr2 == bssid), plus any beacon advertising `ssid`, becomes a
+// (timestamp, bssid, rssi) sample in a lock-free ring - ~10 beacons/s per AP plus whatever data
+// traffic it sends, with no scan gaps. Drain it from loop() with MU_SniffPoll().
+// Provides:
+//  - MU_SniffBegin(channel, ssid) / MU_SniffEnd(): start/stop sampling (stop it before scanning).
+//  - MU_SniffWatch(bssid): also accept non-beacon frames from bssid (up to MU_SNIFF_MAX_BSSID).
+//  - MU_SniffPoll(sample): next queued sample, false when empty.
+//  - MU_SniffLastUs(): timestamp of the newest matching frame (0 = none yet), for loss detection.
+//  - MU_SniffActive() / MU_SniffDropped(): running state, samples lost to a full ring.
+// The RX callback runs in the WiFi driver task; it is the ring's only producer. On host builds
+// MU_SniffBegin() returns false so sketches fall back to scanning.
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "MatrixRing.h"
+
+#if defined(ESP32)
+#include <esp_timer.h>
+#include <esp_wifi.h>
+#endif
+
+#ifndef MU_SNIFF_RING
+#define MU_SNIFF_RING 256   // samples buffered between polls, power of two
+#endif
+
+#ifndef MU_SNIFF_MAX_BSSID
+#define MU_SNIFF_MAX_BSSID 8
+#endif
+
+#define MU_SNIFF_MGMT 0
+#define MU_SNIFF_DATA 1
+
+struct MU_SniffSample {
+  int64_t tUs;
+  uint8_t bssid[6];         // transmitter (addr2)
+  int8_t rssi;
+  uint8_t kind;             // MU_SNIFF_MGMT / MU_SNIFF_DATA
+};
+
+struct MU_SniffState {
+  uint8_t bssid[MU_SNIFF_MAX_BSSID][6];
+  std::atomic<uint8_t> watched{0};  // entries [0, watched) are complete
+  char ssid[33];
+  uint8_t ssidLen = 0;
+  uint8_t channel = 0;
+  bool active = false;
+  std::atomic<int64_t> lastUs{0};
+};
+
+inline MU_SniffState MU_Sniff;
+inline MU_SpscRing<MU_SniffSample, MU_SNIFF_RING> MU_SniffQueue;
+
+#if defined(ESP32)
+static void MU_SniffRx(void* buf, wifi_promiscuous_pkt_type_t type) {
+  if (type != WIFI_PKT_MGMT && type != WIFI_PKT_DATA) return;
+  const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)buf;
+  const uint8_t* f = pkt->payload;
+  uint16_t len = pkt->rx_ctrl.sig_len;
+  if (len < 24) return;  // shorter than a 3-address header
+  // addr2 (transmitter) at offset 10: frames sent by the AP itself, not by its clients
+  bool match = false;
+  uint8_t n = MU_Sniff.watched.load(std::memory_order_acquire);
+  for (uint8_t i = 0; i < n && !match; ++i) match = memcmp(f + 10, MU_Sniff.bssid[i], 6) == 0;
+  // Beacon (0x80): fixed fields end at 36, the SSID element comes first
+  if (!match && MU_Sniff.ssidLen && f[0] == 0x80 && len >= 38 && f[36] == 0 && f[37] == MU_Sniff.ssidLen &&
+      len >= 38 + MU_Sniff.ssidLen)
+    match = memcmp(f + 38, MU_Sniff.ssid, MU_Sniff.ssidLen) == 0;
+  if (!match) return;
+  MU_SniffSample s;
+  s.tUs = esp_timer_get_time();
+  memcpy(s.bssid, f + 10, 6);
+  s.rssi = (int8_t)pkt->rx_ctrl.rssi;
+  s.kind = type == WIFI_PKT_DATA ? MU_SNIFF_DATA : MU_SNIFF_MGMT;
+  MU_SniffQueue.push(s);
+  MU_Sniff.lastUs.store(s.tUs, std::memory_order_relaxed);
+}
+#endif
+
+// ssid may be null (watched BSSIDs only); the watch list starts empty
+static inline bool MU_SniffBegin(uint8_t channel, const char* ssid = nullptr) {
+#if defined(ESP32)
+  esp_wifi_set_promiscuous(false);
+  MU_Sniff.watched.store(0, std::memory_order_relaxed);
+  MU_Sniff.ssidLen = ssid ? (uint8_t)min(strlen(ssid), sizeof(MU_Sniff.ssid) - 1) : 0;
+  if (ssid) memcpy(MU_Sniff.ssid, ssid, MU_Sniff.ssidLen);
+  MU_Sniff.channel = channel;
+  MU_Sniff.lastUs.store(0, std::memory_order_relaxed);
+  MU_SniffSample stale;
+  while (MU_SniffQueue.pop(stale)) {}
+  wifi_promiscuous_filter_t filter = { WIFI_PROMIS_FILTER_MASK_MGMT | WIFI_PROMIS_FILTER_MASK_DATA };
+  if (esp_wifi_set_promiscuous_filter(&filter) != ESP_OK ||
+      esp_wifi_set_promiscuous_rx_cb(MU_SniffRx) != ESP_OK ||
+      esp_wifi_set_promiscuous(true) != ESP_OK)
+    return false;
+  if (esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE) != ESP_OK) {
+    esp_wifi_set_promiscuous(false);
+    return false;
+  }
+  MU_Sniff.active = true;
+  return true;
+#else
+  (void)channel;
+  (void)ssid;
+  return false;
+#endif
+}
+
+// Safe while sniffing: the entry is written before the count that publishes it
+static inline bool MU_SniffWatch(const uint8_t bssid[6]) {
+  uint8_t n = MU_Sniff.watched.load(std::memory_order_relaxed);
+  for (uint8_t i = 0; i < n; ++i)
+    if (memcmp(MU_Sniff.bssid[i], bssid, 6) == 0) return true;
+  if (n >= MU_SNIFF_MAX_BSSID) return false;
+  memcpy(MU_Sniff.bssid[n], bssid, 6);
+  MU_Sniff.watched.store((uint8_t)(n + 1), std::memory_order_release);
+  return true;
+}
+
+static inline void MU_SniffEnd() {
+#if defined(ESP32)
+  if (MU_Sniff.active) esp_wifi_set_promiscuous(false);
+#endif
+  MU_Sniff.active = false;
+}
+
+static inline bool MU_SniffPoll(MU_SniffSample& out) {
+  return MU_SniffQueue.pop(out);
+}
+
+static inline int64_t MU_SniffLastUs() {
+  return MU_Sniff.lastUs.load(std::memory_order_relaxed);
+}
+
+static inline bool MU_SniffActive() {
+  return MU_Sniff.active;
+}
+
+static inline uint32_t MU_SniffDropped() {
+  return MU_SniffQueue.dropped();
+}
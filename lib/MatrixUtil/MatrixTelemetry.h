@@ -0,0 +1,167 @@
+// MatrixTelemetry.h - Non-blocking serial telemetry for MatrixUtil sketches
+// Usage: include after MatrixUtil.h and call MU_TelemetryBegin() once in setup(), after Serial.begin().
+// From then on MU_SerialWrite() (META, frame dumps) and MU_Log*() only memcpy into a RAM ring;
+// a low-priority task pinned to the other core drains it to Serial, so a full USB-CDC TX buffer
+// stalls that task instead of loop().
+// Provides:
+//  - MU_TelemetryBegin(): installs the ring as MU_TxHook and starts the drain task.
+//  - MU_LogWrite(data,len) / MU_Log(str) / MU_Logf(fmt,...): queue raw bytes / a string / formatted text.
+//  - MU_TelemetryDroppedBytes(): bytes discarded by drop-oldest backpressure so far.
+// The ring is single-producer: log from one task only (normally the Arduino loop task).
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdarg.h>
+
+#ifndef MU_TELEMETRY_BUF_BYTES
+#define MU_TELEMETRY_BUF_BYTES 8192   // ring size, power of two
+#endif
+#ifndef MU_TELEMETRY_MAX_RECORD
+#define MU_TELEMETRY_MAX_RECORD 1024  // larger writes are split into several records
+#endif
+#ifndef MU_TELEMETRY_TASK_PRIO
+#define MU_TELEMETRY_TASK_PRIO 1
+#endif
+#ifndef MU_TELEMETRY_TASK_STACK
+#define MU_TELEMETRY_TASK_STACK 3072
+#endif
+
+static_assert((MU_TELEMETRY_BUF_BYTES & (MU_TELEMETRY_BUF_BYTES - 1)) == 0, "MU_TELEMETRY_BUF_BYTES must be a power of two");
+static_assert(MU_TELEMETRY_MAX_RECORD + 2 <= MU_TELEMETRY_BUF_BYTES / 2, "MU_TELEMETRY_MAX_RECORD too large for the ring");
+
+// Records are [len u16][len bytes]. head/tail are free-running byte counters.
+// The producer owns head; tail is advanced by the consumer after a drain and by
+// the producer when it drops the oldest record, so both move it with a CAS.
+struct MU_TelemetryRing {
+  uint8_t buf[MU_TELEMETRY_BUF_BYTES];
+  std::atomic<uint32_t> head{0};
+  std::atomic<uint32_t> tail{0};
+  std::atomic<uint32_t> droppedBytes{0};
+};
+
+inline MU_TelemetryRing MU_TxRing;
+
+static inline void MU_RingCopyIn(uint32_t pos, const uint8_t* src, size_t len) {
+  uint32_t at = pos & (MU_TELEMETRY_BUF_BYTES - 1);
+  size_t first = min(len, (size_t)(MU_TELEMETRY_BUF_BYTES - at));
+  memcpy(MU_TxRing.buf + at, src, first);
+  memcpy(MU_TxRing.buf, src + first, len - first);
+}
+
+static inline void MU_RingCopyOut(uint32_t pos, uint8_t* dst, size_t len) {
+  uint32_t at = pos & (MU_TELEMETRY_BUF_BYTES - 1);
+  size_t first = min(len, (size_t)(MU_TELEMETRY_BUF_BYTES - at));
+  memcpy(dst, MU_TxRing.buf + at, first);
+  memcpy(dst + first, MU_TxRing.buf, len - first);
+}
+
+static inline uint16_t MU_RingRecordLen(uint32_t pos) {
+  uint8_t b[2];
+  MU_RingCopyOut(pos, b, 2);
+  return (uint16_t)(b[0] | (b[1] << 8));
+}
+
+// Producer side: queue one record, dropping the oldest records if the ring is full
+static inline void MU_RingPush(const uint8_t* data, uint16_t len) {
+  const uint32_t need = 2u + len;
+  uint32_t h = MU_TxRing.head.load(std::memory_order_relaxed);
+  for (;;) {
+    uint32_t t = MU_TxRing.tail.load(std::memory_order_acquire);
+    if (MU_TELEMETRY_BUF_BYTES - (h - t) >= need) break;
+    uint16_t oldest = MU_RingRecordLen(t);
+    if (MU_TxRing.tail.compare_exchange_weak(t, t + 2u + oldest, std::memory_order_acq_rel)) {
+      MU_TxRing.droppedBytes.fetch_add(oldest, std::memory_order_relaxed);
+    }
+  }
+  uint8_t hdr[2] = { (uint8_t)(len & 0xFF), (uint8_t)(len >> 8) };
+  MU_RingCopyIn(h + 2u, data, len);
+  MU_RingCopyIn(h, hdr, 2);
+  MU_TxRing.head.store(h + need, std::memory_order_release);
+}
+
+// Consumer side: copy whole records into out[] (cap >= MU_TELEMETRY_MAX_RECORD), claiming each
+// with a CAS on tail. A failed CAS means the producer dropped that record while we copied it;
+// the copy is discarded.
+static inline size_t MU_TelemetryDrain(uint8_t* out, size_t cap) {
+  size_t n = 0;
+  for (;;) {
+    uint32_t t = MU_TxRing.tail.load(std::memory_order_acquire);
+    uint32_t h = MU_TxRing.head.load(std::memory_order_acquire);
+    if (t == h) break;
+    uint16_t len = MU_RingRecordLen(t);
+    if (len > MU_TELEMETRY_MAX_RECORD) continue;  // torn read of a record being dropped; retry
+    if (n + len > cap) break;
+    MU_RingCopyOut(t + 2u, out + n, len);
+    if (MU_TxRing.tail.compare_exchange_strong(t, t + 2u + len, std::memory_order_acq_rel)) {
+      n += len;
+    }
+  }
+  return n;
+}
+
+static inline void MU_LogWrite(const void* data, size_t len) {
+  const uint8_t* p = (const uint8_t*)data;
+  while (len) {
+    uint16_t chunk = (uint16_t)min(len, (size_t)MU_TELEMETRY_MAX_RECORD);
+    MU_RingPush(p, chunk);
+    p += chunk;
+    len -= chunk;
+  }
+}
+
+static inline void MU_TelemetryHook(const uint8_t* data, size_t len) {
+  MU_LogWrite(data, len);
+}
+
+static inline void MU_Log(const char* s) {
+  MU_SerialWrite((const uint8_t*)s, strlen(s));
+}
+
+// Formats on the caller's stack, then queues; prefer MU_LogWrite() with prebuilt data in hot loops
+static inline void MU_Logf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+static inline void MU_Logf(const char* fmt, ...) {
+  char buf[192];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n > 0) MU_SerialWrite((const uint8_t*)buf, (size_t)min(n, (int)sizeof(buf) - 1));
+}
+
+static inline uint32_t MU_TelemetryDroppedBytes() {
+  return MU_TxRing.droppedBytes.load(std::memory_order_relaxed);
+}
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+inline TaskHandle_t MU_TelemetryTaskHandle = nullptr;
+inline uint8_t MU_TelemetryChunk[MU_TELEMETRY_MAX_RECORD];
+
+static void MU_TelemetryTask(void*) {
+  for (;;) {
+    size_t n = MU_TelemetryDrain(MU_TelemetryChunk, sizeof(MU_TelemetryChunk));
+    if (n) {
+      MU_PROFILE_SCOPE("tx_serial");
+      Serial.write(MU_TelemetryChunk, n);  // may block on USB-CDC; only this task waits
+    } else {
+      vTaskDelay(1);
+    }
+  }
+}
+
+// Start draining on the core the caller is NOT running on (loop() runs on core 1 by default)
+static inline void MU_TelemetryBegin() {
+  if (MU_TelemetryTaskHandle) return;
+  BaseType_t core = xPortGetCoreID() == 0 ? 1 : 0;
+  xTaskCreatePinnedToCore(MU_TelemetryTask, "mu_tx", MU_TELEMETRY_TASK_STACK, nullptr,
+                          MU_TELEMETRY_TASK_PRIO, &MU_TelemetryTaskHandle, core);
+  MU_TxHook = MU_TelemetryHook;
+}
+#else
+// No RTOS (host builds): writes stay synchronous through Serial.write
+static inline void MU_TelemetryBegin() {}
+#endif
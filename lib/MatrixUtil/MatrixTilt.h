@@ -0,0 +1,166 @@
+// MatrixTilt.h - Fixed-point tilt fusion with debounced direction events
+// Usage: include after MatrixIMU.h; call MU_TiltBegin(cfg) before MU_ImuTaskBegin() so every FIFO
+// sample (full ODR, in the sensor task) goes through a complementary filter: gyro rates integrate
+// the tilt, the accelerometer angle pulls it back with time constant tauUs. Game code then reads
+// MU_TiltRead() for the angles or pops MU_TiltPoll() events, independent of how often loop() runs.
+// Provides:
+//  - MU_TiltBegin(cfg): adds MU_TiltUpdate to the IMU sample hooks (false with the list full).
+//  - MU_TiltUpdate(sample): one filter step (dt from sample timestamps).
+//  - MU_TiltRead(state): newest angles (centidegrees) and debounced per-axis direction.
+//  - MU_TiltPoll(event): next direction event; tilting past onCd for holdUs fires one, dropping
+//    below offCd releases the axis, optional auto-repeat every repeatUs while held.
+//  - MU_Atan2Cd(y, x): integer atan2 in centidegrees (max error ~0.25 deg).
+// Tilt X follows +accel X and tilt Y follows +accel Y (the same signs the games used on Accel.x/y).
+
+#pragma once
+
+#include <Arduino.h>
+#include "MatrixIMU.h"
+#include "MatrixRing.h"
+
+#define MU_TILT_X 0
+#define MU_TILT_Y 1
+
+struct MU_TiltConfig {
+  int16_t onCd = 1000;        // tilt (0.01 deg) that engages a direction
+  int16_t offCd = 600;        // tilt below which it releases (hysteresis)
+  uint32_t holdUs = 20000;    // must stay engaged this long before the event fires
+  uint32_t repeatUs = 0;      // >0: repeat the event while held
+  uint32_t tauUs = 250000;    // accelerometer correction time constant
+};
+
+struct MU_TiltState {
+  int64_t tUs;
+  int16_t tiltCd[2];          // MU_TILT_X / MU_TILT_Y
+  int8_t dir[2];              // debounced -1 / 0 / +1
+};
+
+struct MU_TiltEvent {
+  int64_t tUs;
+  uint8_t axis;               // MU_TILT_X / MU_TILT_Y
+  int8_t dir;                 // -1 / +1
+  bool repeat;
+};
+
+struct MU_TiltAxis {
+  int32_t angleQ8 = 0;        // centidegrees << 8
+  int8_t state = 0;
+  int8_t pending = 0;
+  int64_t pendingSince = 0;
+  int64_t lastEmit = 0;
+};
+
+struct MU_TiltFilter {
+  MU_TiltConfig cfg;
+  MU_TiltAxis axis[2];
+  int64_t lastUs = 0;
+  bool primed = false;
+};
+
+inline MU_TiltFilter MU_Tilt;
+inline MU_Latest<MU_TiltState> MU_TiltLatest;
+inline MU_SpscRing<MU_TiltEvent, 16> MU_TiltEvents;
+
+static inline uint32_t MU_Isqrt32(uint32_t v) {
+  uint32_t r = 0, bit = 1UL << 30;
+  while (bit > v) bit >>= 2;
+  while (bit) {
+    if (v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; }
+    else r >>= 1;
+    bit >>= 2;
+  }
+  return r;
+}
+
+// atan(z) ~ 45 deg * z + 15.64 deg * z * (1 - z) on the first octant, then folded by symmetry
+static inline int16_t MU_Atan2Cd(int32_t y, int32_t x) {
+  if (x == 0 && y == 0) return 0;
+  uint32_t ax = (uint32_t)abs(x), ay = (uint32_t)abs(y);
+  bool steep = ay > ax;
+  int32_t z = steep ? (int32_t)(((uint64_t)ax << 15) / ay) : (int32_t)(((uint64_t)ay << 15) / ax);
+  int32_t a = ((4500 * z) >> 15) + (int32_t)((1564LL * z * (32768 - z)) >> 30);
+  if (steep) a = 9000 - a;
+  if (x < 0) a = 18000 - a;
+  return (int16_t)(y < 0 ? -a : a);
+}
+
+static inline void MU_TiltEmit(int64_t tUs, uint8_t axis, int8_t dir, bool repeat) {
+  MU_TiltEvents.push({ tUs, axis, dir, repeat });
+  MU_Tilt.axis[axis].lastEmit = tUs;
+}
+
+static inline void MU_TiltDebounce(uint8_t i, int32_t cd, int64_t t) {
+  const MU_TiltConfig& c = MU_Tilt.cfg;
+  MU_TiltAxis& a = MU_Tilt.axis[i];
+  int8_t want = a.state;
+  if (cd > c.onCd) want = 1;
+  else if (cd < -c.onCd) want = -1;
+  else if ((a.state > 0 && cd < c.offCd) || (a.state < 0 && cd > -c.offCd)) want = 0;
+
+  if (want == a.state) {
+    a.pending = a.state;
+  } else {
+    if (a.pending != want) { a.pending = want; a.pendingSince = t; }
+    // Releasing is immediate; engaging has to hold
+    if (want == 0 || t - a.pendingSince >= (int64_t)c.holdUs) {
+      a.state = want;
+      if (want) MU_TiltEmit(t, i, want, false);
+    }
+  }
+  if (a.state && c.repeatUs && t - a.lastEmit >= (int64_t)c.repeatUs) MU_TiltEmit(t, i, a.state, true);
+}
+
+static inline void MU_TiltUpdate(const MU_ImuSample& s) {
+  int32_t ax = s.ax, ay = s.ay, az = s.az;
+  uint32_t mag = MU_Isqrt32((uint32_t)(ax * ax) + (uint32_t)(ay * ay) + (uint32_t)(az * az));
+  if (mag == 0) return;
+  int32_t accCd[2] = {
+    MU_Atan2Cd(ax, (int32_t)MU_Isqrt32((uint32_t)(ay * ay) + (uint32_t)(az * az))),
+    MU_Atan2Cd(ay, (int32_t)MU_Isqrt32((uint32_t)(ax * ax) + (uint32_t)(az * az))),
+  };
+
+  if (!MU_Tilt.primed) {
+    for (uint8_t i = 0; i < 2; ++i) MU_Tilt.axis[i].angleQ8 = accCd[i] << 8;
+    MU_Tilt.lastUs = s.tUs;
+    MU_Tilt.primed = true;
+  }
+  int64_t dt = s.tUs - MU_Tilt.lastUs;
+  if (dt < 0 || dt > 50000) dt = 0;  // clock jump or long gap: trust the accelerometer step only
+  MU_Tilt.lastUs = s.tUs;
+
+  // The gravity vector turns as a x w in the sensor frame, so the tilt rates are
+  // dX/dt = -w_y * a_z/|a| and dY/dt = w_x * a_z/|a| (components near level)
+  int32_t gxCd = s.gx * 100 / MU_IMU_GYR_LSB_PER_DPS;
+  int32_t gyCd = s.gy * 100 / MU_IMU_GYR_LSB_PER_DPS;
+  int32_t rateCd[2] = { (int32_t)(-(int64_t)gyCd * az / (int32_t)mag),
+                        (int32_t)((int64_t)gxCd * az / (int32_t)mag) };
+  int64_t kQ16 = (dt << 16) / ((int64_t)MU_Tilt.cfg.tauUs + dt);
+
+  MU_TiltState st;
+  st.tUs = s.tUs;
+  for (uint8_t i = 0; i < 2; ++i) {
+    MU_TiltAxis& a = MU_Tilt.axis[i];
+    a.angleQ8 += (int32_t)(((int64_t)rateCd[i] * dt * 256) / 1000000);
+    a.angleQ8 += (int32_t)((((int64_t)(accCd[i] << 8) - a.angleQ8) * kQ16) >> 16);
+    int32_t cd = a.angleQ8 >> 8;
+    MU_TiltDebounce(i, cd, s.tUs);
+    st.tiltCd[i] = (int16_t)cd;
+    st.dir[i] = a.state;
+  }
+  MU_TiltLatest.publish(st);
+}
+
+static inline bool MU_TiltBegin(const MU_TiltConfig& cfg = MU_TiltConfig()) {
+  MU_Tilt.cfg = cfg;
+  MU_Tilt.primed = false;
+  return MU_ImuAddSampleHook(MU_TiltUpdate);
+}
+
+// Newest filter output; false if no sample arrived since the last call
+static inline bool MU_TiltRead(MU_TiltState& out) {
+  return MU_TiltLatest.take(out);
+}
+
+static inline bool MU_TiltPoll(MU_TiltEvent& out) {
+  return MU_TiltEvents.pop(out);
+}
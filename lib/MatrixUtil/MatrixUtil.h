@@ -1,10 +1,16 @@
 // MatrixUtil.h - Shared helpers for LED matrix games
 // Usage: include your board profile first (config/BoardConfig.h), then include this header.
 // Provides:
-//  - MU_XY(x,y): stable XY->index mapping honoring rotation, flips and wiring.
+//  - MU_XY(x,y): stable XY->index mapping honoring rotation, flips and wiring,
+//    served from a compile-time lookup table (MU_XY_TABLES) with an inverse (MU_LedToXY).
 //  - MU_PrintMeta(): prints a single META line describing mapping for host tools.
 //  - MU_SendFrameCSV(leds): emits one CSV-hex frame (FRAME:...) in XY scan order.
+//  - MU_SendFrameBinary(leds): emits one binary frame packet (sync, seq, len, CRC).
+//  - MU_SendFrameDelta(leds): emits only pixels changed since the last call (periodic keyframes).
+//  - MU_SendFrame(leds): emits one frame in the MU_FRAME_FORMAT chosen by the sketch.
 //  - MU_DrawCalibration(leds): draws corner markers (TL=G, TR=R, BL=B, BR=W).
+// Multi-panel walls: MATRIX_TILES in the board profile (see MatrixCanvas.h) makes the same mapping
+// cover every tile, and MU_ADD_LEDS / MU_ShowLeds drive one data pin per chain in parallel.
 
 #pragma once
 
@@ -35,8 +41,25 @@
 #define PANEL_FLIP_Y 0
 #endif
 
-// XY mapping honoring rotation, flips and wiring
-static inline uint16_t MU_XY(uint8_t x, uint8_t y) {
+#define MU_NUM_LEDS (MATRIX_WIDTH * MATRIX_HEIGHT)
+
+#if !defined(MATRIX_TILES) && (PANEL_ROTATION == 90 || PANEL_ROTATION == 270)
+static_assert(MATRIX_WIDTH == MATRIX_HEIGHT, "PANEL_ROTATION 90/270 requires a square panel");
+#endif
+
+#include "MatrixCanvas.h"
+
+// Reference XY mapping honoring rotation, flips and wiring (branchy).
+// Only evaluated at compile time to build MU_XY_TABLES; kept callable so
+// bench sketches can compare it against the table lookup.
+#ifdef MATRIX_TILES
+static constexpr uint16_t MU_XYCompute(uint8_t x, uint8_t y) {
+  if (x >= MATRIX_WIDTH)  x = MATRIX_WIDTH  - 1;
+  if (y >= MATRIX_HEIGHT) y = MATRIX_HEIGHT - 1;
+  return MU_CanvasCompute(MU_TILES, x, y);
+}
+#else
+static constexpr uint16_t MU_XYCompute(uint8_t x, uint8_t y) {
   if (x >= MATRIX_WIDTH)  x = MATRIX_WIDTH  - 1;
   if (y >= MATRIX_HEIGHT) y = MATRIX_HEIGHT - 1;
 
@@ -73,6 +96,61 @@ static inline uint16_t MU_XY(uint8_t x, uint8_t y) {
     return (y * MATRIX_WIDTH) + x;
   #endif
 }
+#endif
+
+// Logical <-> physical lookup tables, indexed by (y*MATRIX_WIDTH + x) and by LED index.
+struct MU_XYTables {
+  uint16_t fwd[MU_NUM_LEDS];  // logical (y*W+x) -> physical LED index
+  uint16_t inv[MU_NUM_LEDS];  // physical LED index -> logical (y*W+x)
+};
+
+static constexpr MU_XYTables MU_BuildXYTables() {
+  MU_XYTables t{};
+  for (uint16_t y = 0; y < MATRIX_HEIGHT; ++y) {
+    for (uint16_t x = 0; x < MATRIX_WIDTH; ++x) {
+      uint16_t logical  = y * MATRIX_WIDTH + x;
+      uint16_t physical = MU_XYCompute((uint8_t)x, (uint8_t)y);
+      t.fwd[logical]  = physical;
+      if (physical < MU_NUM_LEDS) t.inv[physical] = logical;  // else rejected by MU_XYTablesValid
+    }
+  }
+  return t;
+}
+
+// Built once at compile time from the PANEL_* macros; lives in flash (.rodata).
+inline constexpr MU_XYTables MU_XY_TABLES = MU_BuildXYTables();
+
+static constexpr bool MU_XYTablesValid() {
+  for (uint16_t i = 0; i < MU_NUM_LEDS; ++i) {
+    if (MU_XY_TABLES.fwd[i] >= MU_NUM_LEDS) return false;
+    if (MU_XY_TABLES.inv[MU_XY_TABLES.fwd[i]] != i) return false;
+  }
+  return true;
+}
+static_assert(MU_XYTablesValid(), "PANEL_* / MATRIX_TILES settings do not produce a 1:1 LED mapping");
+
+// XY mapping honoring rotation, flips and wiring: clamp + one table load
+static inline uint16_t MU_XY(uint8_t x, uint8_t y) {
+  if (x >= MATRIX_WIDTH)  x = MATRIX_WIDTH  - 1;
+  if (y >= MATRIX_HEIGHT) y = MATRIX_HEIGHT - 1;
+  return MU_XY_TABLES.fwd[y * MATRIX_WIDTH + x];
+}
+
+// Unclamped lookup by logical index (y*MATRIX_WIDTH + x), for scan-order loops
+static inline uint16_t MU_XYIndex(uint16_t logical) {
+  return MU_XY_TABLES.fwd[logical];
+}
+
+// Physical LED index -> logical index (y*MATRIX_WIDTH + x)
+static inline uint16_t MU_LedToXY(uint16_t led) {
+  return MU_XY_TABLES.inv[led];
+}
+
+// Legacy names formerly defined in config/BoardConfig.h; both now go through the table.
+// Define MU_NO_LEGACY_XY before including this header if a sketch has its own XY().
+#ifndef MU_NO_LEGACY_XY
+static inline uint16_t XY(uint8_t x, uint8_t y) { return MU_XY(x, y); }
+#endif
 
 // Compile-time color order string for META line
 static inline const char* MU_ColorOrderStr() {
@@ -93,35 +171,309 @@ static inline const char* MU_ColorOrderStr() {
   #endif
 }
 
+// Frame streaming format for MU_SendFrame(); override before including this header.
+//  - MU_FMT_CSV: "FRAME:RRGGBB,..." text line (human readable, ~7 bytes/pixel)
+//  - MU_FMT_BIN: binary packet, see MU_SendFrameBinary() (3 bytes/pixel + 9 bytes framing)
+//  - MU_FMT_DELTA: binary packets carrying only changed pixels, see MU_SendFrameDelta()
+#define MU_FMT_CSV   0
+#define MU_FMT_BIN   1
+#define MU_FMT_DELTA 2
+#ifndef MU_FRAME_FORMAT
+#define MU_FRAME_FORMAT MU_FMT_CSV
+#endif
+
+// Optional redirect for MU_SerialWrite (installed by MatrixTelemetry.h to queue instead of block)
+inline void (*MU_TxHook)(const uint8_t* data, size_t len) = nullptr;
+
+// Every serial byte the helpers emit goes through here as one bulk write
+static inline void MU_SerialWrite(const uint8_t* data, size_t len) {
+  if (MU_TxHook) MU_TxHook(data, len);
+  else Serial.write(data, len);
+}
+
+// ---- Host commands ----
+// Single-byte requests from the host tools: 'K' keyframe (below), 'S' stats (MatrixSched.h), 'P'
+// profile (MatrixProfile.h). Each header serving one registers it with MU_HostOn() at static init;
+// MU_HostService() reads every byte waiting on Serial and routes it, so a byte nobody serves is
+// dropped instead of blocking the ones queued behind it. MU_SchedRun() and MU_SendFrameDelta() call
+// it; other sketches call it from loop(). A sketch reading Serial itself registers its bytes too.
+#ifndef MU_HOST_MAX_CMDS
+#define MU_HOST_MAX_CMDS 8
+#endif
+
+struct MU_HostCmd {
+  uint8_t c;
+  void (*fn)();
+};
+
+inline MU_HostCmd MU_HostCmds[MU_HOST_MAX_CMDS];
+inline uint8_t MU_HostCmdCount = 0;
+
+// Serve byte c with fn (replaces an earlier handler for c); false with the table full
+static inline bool MU_HostOn(uint8_t c, void (*fn)()) {
+  for (uint8_t i = 0; i < MU_HostCmdCount; ++i)
+    if (MU_HostCmds[i].c == c) {
+      MU_HostCmds[i].fn = fn;
+      return true;
+    }
+  if (MU_HostCmdCount >= MU_HOST_MAX_CMDS) return false;
+  MU_HostCmds[MU_HostCmdCount++] = { c, fn };
+  return true;
+}
+
+static inline void MU_HostService() {
+  for (int n = Serial.available(); n > 0; --n) {
+    int c = Serial.read();
+    if (c < 0) break;
+    for (uint8_t i = 0; i < MU_HostCmdCount; ++i)
+      if (MU_HostCmds[i].c == (uint8_t)c) {
+        MU_HostCmds[i].fn();
+        break;
+      }
+  }
+}
+
+// MU_PROFILE_SCOPE sections and the PROFILE: report (print through MU_SerialWrite above)
+#include "MatrixProfile.h"
+
 // Print one-time mapping meta for host tools (e.g., led_matrix_viz.py)
 static inline void MU_PrintMeta() {
-  Serial.print("META:W="); Serial.print(MATRIX_WIDTH);
-  Serial.print(",H="); Serial.print(MATRIX_HEIGHT);
-  Serial.print(",ORDER=xy");
-  Serial.print(",WIRING="); Serial.print(PANEL_WIRING_SERPENTINE ? "serpentine" : "progressive");
-  Serial.print(",ROT="); Serial.print(PANEL_ROTATION);
-  Serial.print(",FLIPX="); Serial.print((int)PANEL_FLIP_X);
-  Serial.print(",FLIPY="); Serial.print((int)PANEL_FLIP_Y);
-  Serial.print(",COLOR="); Serial.println(MU_ColorOrderStr());
+  char buf[128];
+  int n = snprintf(buf, sizeof(buf),
+                   "META:W=%d,H=%d,ORDER=xy,WIRING=%s,ROT=%d,FLIPX=%d,FLIPY=%d,COLOR=%s,FMT=%s\r\n",
+                   MATRIX_WIDTH, MATRIX_HEIGHT,
+                   PANEL_WIRING_SERPENTINE ? "serpentine" : "progressive",
+                   PANEL_ROTATION, (int)PANEL_FLIP_X, (int)PANEL_FLIP_Y,
+                   MU_ColorOrderStr(),
+                   MU_FRAME_FORMAT == MU_FMT_DELTA ? "delta" :
+                   MU_FRAME_FORMAT == MU_FMT_BIN   ? "bin"   : "csv");
+  if (n > 0) MU_SerialWrite((const uint8_t*)buf, (size_t)min(n, (int)sizeof(buf) - 1));
 }
 
+// ---- CSV-hex frames ----
+
+#define MU_CSV_FRAME_BYTES (6 + MU_NUM_LEDS * 7 + 2)  // "FRAME:" + "RRGGBB," per pixel + "\r\n"
+
+// Format one frame as CSV hex in XY scan order; returns bytes written (no terminator)
+static inline size_t MU_FormatFrameCSV(char* out, const CRGB* leds, bool newline) {
+  static const char hex[] = "0123456789ABCDEF";
+  char* p = out;
+  memcpy(p, "FRAME:", 6); p += 6;
+  for (uint16_t i = 0; i < MU_NUM_LEDS; ++i) {
+    const CRGB& c = leds[MU_XYIndex(i)];
+    *p++ = hex[c.r >> 4]; *p++ = hex[c.r & 0x0F];
+    *p++ = hex[c.g >> 4]; *p++ = hex[c.g & 0x0F];
+    *p++ = hex[c.b >> 4]; *p++ = hex[c.b & 0x0F];
+    *p++ = ',';
+  }
+  if (newline) { *p++ = '\r'; *p++ = '\n'; }
+  return (size_t)(p - out);
+}
+
+inline char MU_CsvTxBuf[MU_CSV_FRAME_BYTES];
+
 // Emit one CSV-hex frame in XY scan order
 static inline void MU_SendFrameCSV(const CRGB* leds) {
-  Serial.print("FRAME:");
-  for (int y = 0; y < MATRIX_HEIGHT; ++y) {
-    for (int x = 0; x < MATRIX_WIDTH; ++x) {
-      CRGB c = leds[MU_XY((uint8_t)x, (uint8_t)y)];
-      char buf[8];
-      sprintf(buf, "%02X%02X%02X,", c.r, c.g, c.b);
-      Serial.print(buf);
+  MU_PROFILE_SCOPE("frame_tx");
+  size_t n = MU_FormatFrameCSV(MU_CsvTxBuf, leds, true);
+  MU_SerialWrite((const uint8_t*)MU_CsvTxBuf, n);
+}
+
+#ifndef MU_NO_LEGACY_XY
+// Legacy frame dump formerly in config/BoardConfig.h (no trailing newline)
+static inline void sendFrameData(CRGB* leds) {
+  size_t n = MU_FormatFrameCSV(MU_CsvTxBuf, leds, false);
+  MU_SerialWrite((const uint8_t*)MU_CsvTxBuf, n);
+}
+#endif
+
+// ---- Binary frames ----
+// Packet layout (multi-byte fields little-endian):
+//   [0]    0xA5  sync
+//   [1]    0x5A  sync
+//   [2]    type  (MU_PKT_FULL: payload is W*H RGB triplets in XY scan order,
+//                 MU_PKT_DELTA: payload is runs of [start u16][count u8][count RGB triplets])
+//   [3..4] seq   (increments per packet, wraps)
+//   [5..6] len   (payload bytes)
+//   [7..]  payload
+//   [7+len..8+len] CRC-16/CCITT-FALSE over bytes [2 .. 7+len)
+#define MU_PKT_SYNC0   0xA5
+#define MU_PKT_SYNC1   0x5A
+#define MU_PKT_FULL    0x01
+#define MU_PKT_DELTA   0x02
+#define MU_PKT_HEADER  7
+#define MU_PKT_TRAILER 2
+#define MU_BIN_FRAME_BYTES (MU_PKT_HEADER + MU_NUM_LEDS * 3 + MU_PKT_TRAILER)
+
+struct MU_Crc16Table {
+  uint16_t v[256];
+};
+
+static constexpr MU_Crc16Table MU_BuildCrc16Table() {
+  MU_Crc16Table t{};
+  for (uint16_t i = 0; i < 256; ++i) {
+    uint16_t crc = (uint16_t)(i << 8);
+    for (uint8_t b = 0; b < 8; ++b)
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    t.v[i] = crc;
+  }
+  return t;
+}
+
+inline constexpr MU_Crc16Table MU_CRC16_TABLE = MU_BuildCrc16Table();
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF); matches Python binascii.crc_hqx(data, 0xFFFF)
+static inline uint16_t MU_Crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+  while (len--) crc = (uint16_t)((crc << 8) ^ MU_CRC16_TABLE.v[((crc >> 8) ^ *data++) & 0xFF]);
+  return crc;
+}
+
+inline uint8_t  MU_BinTxBuf[MU_BIN_FRAME_BYTES];
+inline uint16_t MU_BinTxSeq = 0;
+
+// Wrap `len` payload bytes already placed at buf[MU_PKT_HEADER] into a packet; returns packet size
+static inline size_t MU_FinishPacketSeq(uint8_t* buf, uint8_t type, uint16_t seq, uint16_t len) {
+  buf[0] = MU_PKT_SYNC0;
+  buf[1] = MU_PKT_SYNC1;
+  buf[2] = type;
+  buf[3] = (uint8_t)(seq & 0xFF);
+  buf[4] = (uint8_t)(seq >> 8);
+  buf[5] = (uint8_t)(len & 0xFF);
+  buf[6] = (uint8_t)(len >> 8);
+  uint16_t crc = MU_Crc16(buf + 2, (size_t)(MU_PKT_HEADER - 2) + len);
+  buf[MU_PKT_HEADER + len]     = (uint8_t)(crc & 0xFF);
+  buf[MU_PKT_HEADER + len + 1] = (uint8_t)(crc >> 8);
+  return (size_t)MU_PKT_HEADER + len + MU_PKT_TRAILER;
+}
+
+static inline size_t MU_FinishPacket(uint8_t* buf, uint8_t type, uint16_t len) {
+  return MU_FinishPacketSeq(buf, type, MU_BinTxSeq++, len);
+}
+
+// Emit one binary frame: raw RGB in XY scan order, no text formatting, one bulk write
+static inline void MU_WriteFrameBinary(const CRGB* leds) {
+  uint8_t* p = MU_BinTxBuf + MU_PKT_HEADER;
+  for (uint16_t i = 0; i < MU_NUM_LEDS; ++i) {
+    const CRGB& c = leds[MU_XYIndex(i)];
+    *p++ = c.r; *p++ = c.g; *p++ = c.b;
+  }
+  size_t n = MU_FinishPacket(MU_BinTxBuf, MU_PKT_FULL, (uint16_t)(MU_NUM_LEDS * 3));
+  MU_SerialWrite(MU_BinTxBuf, n);
+}
+
+static inline void MU_SendFrameBinary(const CRGB* leds) {
+  MU_PROFILE_SCOPE("frame_tx");
+  MU_WriteFrameBinary(leds);
+}
+
+// ---- Delta frames ----
+// Keeps the last frame sent (XY order) and emits only changed runs. A keyframe
+// (MU_PKT_FULL) goes out every MU_KEYFRAME_INTERVAL frames, when a delta would
+// not be smaller than a full frame, after MU_RequestKeyframe(), or when the host
+// sends 'K' (the visualizer does this when it sees a sequence gap).
+#ifndef MU_KEYFRAME_INTERVAL
+#define MU_KEYFRAME_INTERVAL 60
+#endif
+#ifndef MU_HOST_KEYFRAME_REQ
+#define MU_HOST_KEYFRAME_REQ 1
+#endif
+#define MU_DELTA_RUN_HEADER 3
+// Dirty masks (MatrixRender.h): one bit per pixel, logical XY index y * MATRIX_WIDTH + x
+#define MU_DIRTY_WORDS ((MU_NUM_LEDS + 31) / 32)
+#define MU_DELTA_MERGE_GAP  1   // merge runs split by at most this many unchanged pixels
+
+inline CRGB     MU_DeltaPrev[MU_NUM_LEDS];
+inline uint16_t MU_DeltaSinceKey = 0;
+inline bool     MU_DeltaKeyPending = true;
+
+static inline void MU_RequestKeyframe() {
+  MU_DeltaKeyPending = true;
+}
+
+#if MU_HOST_KEYFRAME_REQ
+static const bool MU_HostKeyframeCmd = MU_HostOn('K', MU_RequestKeyframe);
+#endif
+
+static inline void MU_SendKeyframe(const CRGB* leds) {
+  for (uint16_t i = 0; i < MU_NUM_LEDS; ++i) MU_DeltaPrev[i] = leds[MU_XYIndex(i)];
+  MU_WriteFrameBinary(leds);
+  MU_DeltaSinceKey = 0;
+  MU_DeltaKeyPending = false;
+}
+
+static inline bool MU_DeltaChanged(const CRGB* leds, const CRGB* prev, uint16_t i, const uint32_t* dirty) {
+  if (dirty && !((dirty[i >> 5] >> (i & 31)) & 1)) return false;
+  return leds[MU_XYIndex(i)] != prev[i];
+}
+
+// Encode the runs of `leds` that differ from `prev` (XY order) into `out` and update `prev`.
+// Returns the payload length (0 = unchanged), or -1 when the delta would not be smaller than a
+// keyframe (`prev` is then partly updated: follow with a keyframe).
+static inline int32_t MU_DeltaEncode(const CRGB* leds, CRGB* prev, const uint32_t* dirty, uint8_t* out) {
+  const uint16_t fullLen = MU_NUM_LEDS * 3;
+  uint16_t len = 0;
+  uint16_t i = 0;
+  while (i < MU_NUM_LEDS) {
+    if (dirty && !dirty[i >> 5]) { i = (i | 31) + 1; continue; }  // whole word clean
+    if (!MU_DeltaChanged(leds, prev, i, dirty)) { ++i; continue; }
+    // Grow [start, end) over changed pixels, bridging short unchanged gaps
+    uint16_t start = i, end = i + 1, j = i + 1;
+    while (j < MU_NUM_LEDS && j - start < 255) {
+      if (MU_DeltaChanged(leds, prev, j, dirty)) end = ++j;
+      else if (j - end + 1 > MU_DELTA_MERGE_GAP) break;
+      else ++j;
+    }
+    uint16_t count = end - start;
+    if (len + MU_DELTA_RUN_HEADER + count * 3 >= fullLen) return -1;
+    out[len++] = (uint8_t)(start & 0xFF);
+    out[len++] = (uint8_t)(start >> 8);
+    out[len++] = (uint8_t)count;
+    for (uint16_t k = start; k < end; ++k) {
+      const CRGB& c = leds[MU_XYIndex(k)];
+      prev[k] = c;
+      out[len++] = c.r; out[len++] = c.g; out[len++] = c.b;
     }
+    i = end;
+  }
+  return len;
+}
+
+// Emit the pixels that changed since the previous call; nothing is sent if none did.
+// `dirty` (optional) is a mask of the pixels that may have changed, e.g. MU_PresentedDirty(); only
+// those are compared, so a quiet frame costs a few word tests instead of a full scan.
+// Every change since the last call must be marked in it.
+static inline void MU_SendFrameDelta(const CRGB* leds, const uint32_t* dirty = nullptr) {
+  MU_PROFILE_SCOPE("frame_tx");
+  MU_HostService();
+  if (MU_DeltaKeyPending || MU_DeltaSinceKey >= MU_KEYFRAME_INTERVAL) {
+    MU_SendKeyframe(leds);
+    return;
   }
-  Serial.println();
+  int32_t len = MU_DeltaEncode(leds, MU_DeltaPrev, dirty, MU_BinTxBuf + MU_PKT_HEADER);
+  if (len < 0) {
+    MU_SendKeyframe(leds);  // delta would not be smaller than a keyframe
+    return;
+  }
+  ++MU_DeltaSinceKey;
+  if (len == 0) return;
+  size_t n = MU_FinishPacket(MU_BinTxBuf, MU_PKT_DELTA, (uint16_t)len);
+  MU_SerialWrite(MU_BinTxBuf, n);
+}
+
+// Emit one frame in the format selected by MU_FRAME_FORMAT (announced as FMT= in META)
+static inline void MU_SendFrame(const CRGB* leds) {
+  #if MU_FRAME_FORMAT == MU_FMT_DELTA
+    MU_SendFrameDelta(leds);
+  #elif MU_FRAME_FORMAT == MU_FMT_BIN
+    MU_SendFrameBinary(leds);
+  #else
+    MU_SendFrameCSV(leds);
+  #endif
 }
 
 // Draw static corner markers for quick alignment
 static inline void MU_DrawCalibration(CRGB* leds) {
-  for (int i = 0; i < MATRIX_WIDTH * MATRIX_HEIGHT; ++i) leds[i] = CRGB::Black;
+  for (int i = 0; i < MU_NUM_LEDS; ++i) leds[i] = CRGB::Black;
   leds[MU_XY(0, 0)]                           = CRGB(0, 100, 0);
   leds[MU_XY(MATRIX_WIDTH-1, 0)]              = CRGB(100, 0, 0);
   leds[MU_XY(0, MATRIX_HEIGHT-1)]             = CRGB(0, 0, 100);
@@ -134,6 +486,68 @@ static inline void MU_DrawCalibration(CRGB* leds) {
 #define MU_CHIPSET WS2812B
 #endif
 
+// Output backend from the board profile (LED_BACKEND in config/BoardConfig.h)
+#define MU_BACKEND_LIB 0
+#define MU_BACKEND_RMT 1
+#ifndef LED_BACKEND
+#define LED_BACKEND MU_BACKEND_LIB
+#endif
+
+inline uint8_t MU_Brightness = 255;
+
+// With several tile chains MU_ADD_LEDS ignores DATA_PIN/COUNT and registers every chain on its
+// MATRIX_CHAIN_PINS pin, LED_ARRAY split at the MU_CHAINS boundaries
+#if LED_BACKEND == MU_BACKEND_RMT
+#include "MatrixOutput.h"
+static inline int MU_AddChains(int pin, uint16_t count) {
+  if (MU_CHAINS.n == 1) return MU_RmtBegin(pin, count);
+#ifdef MATRIX_CHAIN_PINS
+  for (uint8_t c = 0; c < MU_CHAINS.n; ++c)
+    if (MU_RmtBegin(MU_CHAIN_PINS[c], MU_CHAINS.count[c]) < 0) return -1;
+#endif
+  return 0;
+}
+#define MU_ADD_LEDS(DATA_PIN, LED_ARRAY, COUNT) MU_AddChains(DATA_PIN, COUNT)
+#elif defined(MATRIX_CHAIN_PINS)
+#include <utility>
+// FastLED pins are template arguments, so the controllers are unrolled over the constexpr pin list
+template <size_t... I>
+static inline void MU_AddChainLeds(CRGB* leds, std::index_sequence<I...>) {
+  (FastLED.addLeds<MU_CHIPSET, MU_CHAIN_PINS[I], COLOR_ORDER>(leds + MU_CHAINS.start[I], MU_CHAINS.count[I]), ...);
+}
+#define MU_ADD_LEDS(DATA_PIN, LED_ARRAY, COUNT) \
+  MU_AddChainLeds(LED_ARRAY, std::make_index_sequence<sizeof(MU_CHAIN_PINS)>())
+#else
 #define MU_ADD_LEDS(DATA_PIN, LED_ARRAY, COUNT) \
   FastLED.addLeds<MU_CHIPSET, DATA_PIN, COLOR_ORDER>(LED_ARRAY, COUNT)
+#endif
+
+// Global brightness for whichever backend is active
+static inline void MU_SetBrightness(uint8_t b) {
+  MU_Brightness = b;
+  FastLED.setBrightness(b);
+}
+
+// Push `count` LEDs (physical order) through the board's backend. With RMT this returns as soon as
+// the transfer has started; with FastLED it blocks for the whole frame.
+// Chains go out together: RMT starts each strip and returns, FastLED's show() drives all controllers.
+static inline void MU_ShowLeds(const CRGB* frame, uint16_t count) {
+#if LED_BACKEND == MU_BACKEND_RMT
+  if (MU_CHAINS.n == 1) {
+    MU_RmtShow(frame, count, MU_Brightness);
+    return;
+  }
+  for (uint8_t c = 0; c < MU_CHAINS.n && MU_CHAINS.start[c] < count; ++c)
+    MU_RmtShow(frame + MU_CHAINS.start[c], min(MU_CHAINS.count[c], (uint16_t)(count - MU_CHAINS.start[c])),
+               MU_Brightness, c);
+#else
+  if (MU_CHAINS.n == 1) {
+    FastLED[0].setLeds(const_cast<CRGB*>(frame), count);
+  } else {
+    for (uint8_t c = 0; c < MU_CHAINS.n; ++c)
+      FastLED[c].setLeds(const_cast<CRGB*>(frame) + MU_CHAINS.start[c], MU_CHAINS.count[c]);
+  }
+  FastLED.show();
+#endif
+}
 
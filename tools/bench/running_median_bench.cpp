@@ -0,0 +1,80 @@
+// running_median_bench.cpp - Host benchmark: MU_RunningMedian vs the copy + bubble sort median
+// that wifi-slam used (getMedian). Both filters see the same synthetic RSSI stream (slow drift,
+// noise and multipath spikes); the bench checks they agree sample for sample and prints ns/sample.
+// Build and run from the repo root:
+//   g++ -O2 -std=c++17 -I. tools/bench/running_median_bench.cpp -o /tmp/running_median_bench
+//   /tmp/running_median_bench [samples]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "lib/MatrixUtil/MatrixMedian.h"
+
+// The old path: copy the window, bubble sort it, take element size/2
+template <int N>
+struct BubbleMedian {
+  int buf[N];
+  int index = 0;
+  bool full = false;
+
+  int push(int v) {
+    buf[index] = v;
+    index = (index + 1) % N;
+    if (!full && index == 0) full = true;
+    int size = full ? N : index;
+    int temp[N];
+    for (int i = 0; i < size; i++) temp[i] = buf[i];
+    for (int i = 0; i < size - 1; i++)
+      for (int j = 0; j < size - i - 1; j++)
+        if (temp[j] > temp[j + 1]) { int s = temp[j]; temp[j] = temp[j + 1]; temp[j + 1] = s; }
+    return temp[size / 2];
+  }
+};
+
+static std::vector<int> makeStream(size_t n) {
+  std::vector<int> v(n);
+  uint32_t x = 0x12345678;
+  auto rnd = [&x]() { x ^= x << 13; x ^= x >> 17; x ^= x << 5; return x; };
+  for (size_t i = 0; i < n; ++i) {
+    int base = -60 + (int)(15 * ((i / 2000) % 3)) - 15;  // steps between -75 / -60 / -45 dBm
+    int noise = (int)(rnd() % 7) - 3;
+    int spike = (rnd() % 50 == 0) ? ((int)(rnd() % 40) - 20) : 0;
+    v[i] = base + noise + spike;
+  }
+  return v;
+}
+
+template <class F>
+static double timeNs(F&& f, const std::vector<int>& in, long long& sink) {
+  auto t0 = std::chrono::steady_clock::now();
+  for (int v : in) sink += f(v);
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / in.size();
+}
+
+template <int N>
+static bool run(const std::vector<int>& in) {
+  long long sinkA = 0, sinkB = 0;
+  BubbleMedian<N> bubble;
+  MU_RunningMedian<int, N> running;
+  double a = timeNs([&](int v) { return bubble.push(v); }, in, sinkA);
+  double b = timeNs([&](int v) { return running.push(v); }, in, sinkB);
+
+  BubbleMedian<N> check;
+  MU_RunningMedian<int, N> checkR;
+  size_t mismatch = 0;
+  for (int v : in) mismatch += check.push(v) != checkR.push(v);
+
+  printf("N=%-3d bubble %8.1f ns/sample   running %6.1f ns/sample   x%.1f   %s\n", N, a, b, a / b,
+         mismatch || sinkA != sinkB ? "MISMATCH" : "match");
+  return mismatch == 0 && sinkA == sinkB;
+}
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? (size_t)atol(argv[1]) : 200000;
+  std::vector<int> in = makeStream(n);
+  printf("%zu samples\n", n);
+  bool ok = run<5>(in) & run<15>(in) & run<31>(in) & run<63>(in);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+// snake_bench.cpp - Host benchmark of the Snake game core: the original shifting-array body
+// (SnakeCoreArray) vs the ring buffer + occupancy bitmap (SnakeCore), on the 8x8 board and on
+// larger chained-panel sizes. Per variant it prints the state size and steps/s for
+//  - cycle:    the pure Hamiltonian cycle-follower (the core alone; every game fills the board),
+//  - hamilton: the shortcutting Hamiltonian auto-player,
+//  - bfs:      the BFS auto-player (its occupancy queries hit the core's collision test).
+// Games are seeded 1..N, so runs are repeatable.
+// Build and run from the repo root:
+//   g++ -O2 -std=c++17 -I. tools/bench/snake_bench.cpp -o /tmp/snake_bench
+//   /tmp/snake_bench [games]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "examples/Snake/SnakeCore.h"
+#include "examples/Snake/SnakeAI.h"
+
+#define POLICY_CYCLE 0
+#define POLICY_HAMILTON 1
+#define POLICY_BFS 2
+
+static const char* const kPolicyName[] = { "cycle", "hamilton", "bfs" };
+
+struct Result {
+  uint64_t steps = 0;
+  uint64_t apples = 0;
+  uint32_t cleared = 0;  // games that filled the board
+  double seconds = 0;
+};
+
+template <class Core, int R, int C>
+static Result run(uint8_t policy, uint32_t games) {
+  static Core g;
+  static SnakeAutoPlayer<R, C> cycle(SNAKE_AI_HAMILTON);
+  static SnakeAutoPlayer<R, C> bfs(SNAKE_AI_BFS);
+  const uint32_t maxSteps = (uint32_t)R * C * R * C * 2;  // BFS can circle an unreachable apple
+  Result r;
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t seed = 1; seed <= games; ++seed) {
+    g.reset(seed);
+    for (uint32_t s = 0; s < maxSteps && !g.gameOver() && g.food().x >= 0; ++s) {
+      uint8_t dir = policy == POLICY_CYCLE      ? cycle.cycleDirection(g.head())
+                    : policy == POLICY_HAMILTON ? cycle.nextMove(g)
+                                                : bfs.nextMove(g);
+      if (g.step(dir) == SNAKE_ATE) r.apples++;
+      r.steps++;
+    }
+    if (g.food().x < 0) r.cleared++;
+  }
+  r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  return r;
+}
+
+template <int R, int C>
+static void board(uint32_t games) {
+  printf("%dx%d board, %u games per policy\n", R, C, games);
+  printf("  %-6s %6s  %-8s %12s %10s %8s %14s\n", "core", "bytes", "policy", "steps", "apples/g", "cleared",
+         "steps/s");
+  for (uint8_t p = POLICY_CYCLE; p <= POLICY_BFS; ++p) {
+    Result a = run<SnakeCoreArray<R, C>, R, C>(p, games);
+    Result b = run<SnakeCore<R, C>, R, C>(p, games);
+    printf("  %-6s %6zu  %-8s %12llu %10.1f %8u %14.0f\n", "array", sizeof(SnakeCoreArray<R, C>),
+           kPolicyName[p], (unsigned long long)a.steps, (double)a.apples / games, a.cleared, a.steps / a.seconds);
+    printf("  %-6s %6zu  %-8s %12llu %10.1f %8u %14.0f  (%.2fx)\n", "ring", sizeof(SnakeCore<R, C>),
+           kPolicyName[p], (unsigned long long)b.steps, (double)b.apples / games, b.cleared, b.steps / b.seconds,
+           (b.steps / b.seconds) / (a.steps / a.seconds));
+  }
+  printf("  auto-player state: %zu bytes\n\n", sizeof(SnakeAutoPlayer<R, C>));
+}
+
+int main(int argc, char** argv) {
+  uint32_t games = argc > 1 ? (uint32_t)atoi(argv[1]) : 200;
+  if (games == 0) games = 1;
+  board<8, 8>(games);
+  board<16, 16>(games / 4 + 1);
+  board<32, 32>(games / 40 + 1);
+  return 0;
+}
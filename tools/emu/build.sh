@@ -0,0 +1,67 @@
+#!/usr/bin/env bash
+# build.sh - Build an example sketch for the host emulator (no ESP32, no arduino-cli)
+# Usage (from anywhere):
+#   tools/emu/build.sh examples/Snake [-DAUTO_PLAY=1 ...]   # extra args go to the compiler
+#   build/emu/Snake/Snake [--speed 0 --duration 60] | python3 tools/led_matrix_viz.py --stdin
+# Like the Arduino builder, the sketch's .ino files are joined into one translation unit (the one named
+# after the folder first) and compiled with its .cpp files, the repo root on the include path and the
+# shims in tools/emu/shim standing in for the Arduino core, FastLED, Adafruit_NeoPixel, Wire,
+# SensorQMI8658 and WiFi. ESP32 is not defined, so lib/MatrixUtil takes its host paths (no FreeRTOS tasks).
+# Output: build/emu/<sketch>/<sketch> (override the directory with EMU_OUT). CXX, CXXFLAGS are honored.
+
+set -euo pipefail
+
+root="$(cd "$(dirname "${BASH_SOURCE[0]}")/../.." && pwd)"
+if [ $# -lt 1 ] || [ ! -d "$1" ]; then
+  echo "usage: $0 <sketch dir> [compiler flags...]" >&2
+  exit 2
+fi
+sketch="$(cd "$1" && pwd)"
+shift
+name="$(basename "$sketch")"
+out="${EMU_OUT:-$root/build/emu}/$name"
+mkdir -p "$out"
+
+inos=()
+[ -f "$sketch/$name.ino" ] && inos+=("$sketch/$name.ino")
+for f in "$sketch"/*.ino; do
+  [ -f "$f" ] && [ "$f" != "$sketch/$name.ino" ] && inos+=("$f")
+done
+if [ ${#inos[@]} -eq 0 ]; then
+  echo "$0: no .ino in $sketch" >&2
+  exit 2
+fi
+
+gen="$out/$name.ino.cpp"
+: > "$gen"
+for f in "${inos[@]}"; do
+  printf '#line 1 "%s"\n' "$f" >> "$gen"
+  cat "$f" >> "$gen"
+  printf '\n' >> "$gen"
+done
+
+cxx="${CXX:-g++}"
+flags=(-std=gnu++17 -O2 -g -Wall
+       -I"$root/tools/emu/shim" -I"$root" -I"$sketch" ${CXXFLAGS:-} "$@")
+
+srcs=("$gen" "$root/tools/emu/emu.cpp" "$root/tools/emu/emu_devices.cpp" "$root/tools/emu/emu_frames.cpp")
+for f in "$sketch"/*.cpp; do
+  [ -f "$f" ] && srcs+=("$f")
+done
+
+objs=()
+pids=()
+for src in "${srcs[@]}"; do
+  obj="$out/$(basename "$src").o"
+  objs+=("$obj")
+  "$cxx" "${flags[@]}" -c "$src" -o "$obj" &
+  pids+=($!)
+done
+status=0
+for pid in "${pids[@]}"; do
+  wait "$pid" || status=1
+done
+[ $status -eq 0 ] || exit 1
+
+"$cxx" "${objs[@]}" -o "$out/$name" -lpthread
+echo "$out/$name"
@@ -0,0 +1,379 @@
+// emu.cpp - Host emulator runtime: virtual clock, Serial on stdout/stdin, Arduino core, main()
+// Built together with a sketch by tools/emu/build.sh; run the result with --help for the options.
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <thread>
+#include "emu_internal.h"
+#include "shim/Arduino.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+EmuOptions EmuOpt;
+EmuCounters EmuCount;
+
+void setup();
+void loop();
+
+// ---- Clock ----
+
+static uint64_t emuNowNs = 0;
+static std::chrono::steady_clock::time_point emuWall0;
+static uint64_t emuNextPollNs = 0;
+
+static double EmuWallSeconds() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - emuWall0).count();
+}
+
+uint64_t EmuNowNs() {
+  return emuNowNs;
+}
+
+void EmuAdvanceNs(uint64_t ns) {
+  emuNowNs += ns;
+  if (EmuOpt.durationNs && emuNowNs >= EmuOpt.durationNs) EmuExit(0);
+  if (EmuFramePending) EmuFramesService();
+  if (emuNowNs >= emuNextPollNs) {
+    emuNextPollNs = emuNowNs + 1000000;  // stdin at most once per virtual ms
+    EmuPollInput();
+  }
+  if (EmuOpt.speed <= 0) return;
+  // Stay at speed x wall time; sleeping in >= 1 ms steps keeps the syscall rate sane
+  double ahead = emuNowNs / 1e9 / EmuOpt.speed - EmuWallSeconds();
+  if (ahead > 0.001) std::this_thread::sleep_for(std::chrono::duration<double>(ahead));
+}
+
+unsigned long millis() {
+  EmuAdvanceNs(EMU_CLOCK_READ_NS);
+  return (unsigned long)(emuNowNs / 1000000);
+}
+
+unsigned long micros() {
+  EmuAdvanceNs(EMU_CLOCK_READ_NS);
+  return (unsigned long)(emuNowNs / 1000);
+}
+
+void delay(unsigned long ms) {
+  EmuAdvanceNs((uint64_t)ms * 1000000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  EmuAdvanceNs((uint64_t)us * 1000);
+}
+
+void yield() {
+  EmuAdvanceNs(EMU_CLOCK_READ_NS);
+}
+
+uint32_t getCpuFrequencyMhz() {
+  return EMU_CPU_MHZ;
+}
+
+uint32_t EspClass::getCycleCount() {
+  EmuAdvanceNs(EMU_CLOCK_READ_NS);
+  return (uint32_t)(emuNowNs * EMU_CPU_MHZ / 1000);
+}
+
+void EspClass::restart() {
+  fprintf(stderr, "EMU: ESP.restart()\n");
+  EmuExit(0);
+}
+
+// ---- Random (seeded, so a run repeats) ----
+
+static std::mt19937 emuRng(1);
+
+long random(long max) {
+  if (max <= 0) return 0;
+  return (long)(emuRng() % (unsigned long)max);
+}
+
+long random(long min, long max) {
+  return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+  emuRng.seed((uint32_t)seed);
+}
+
+// ---- GPIO ----
+
+static uint8_t emuPins[64];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin < sizeof(emuPins)) emuPins[pin] = val ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < sizeof(emuPins) ? emuPins[pin] : LOW;
+}
+
+void attachInterrupt(int irq, void (*fn)(void), int mode) {
+  (void)irq;
+  (void)fn;
+  (void)mode;
+}
+
+void detachInterrupt(int irq) {
+  (void)irq;
+}
+
+// ---- Print / String ----
+
+String::String(long v, int base) {
+  char buf[40];
+  if (base == HEX) snprintf(buf, sizeof(buf), "%lx", v);
+  else snprintf(buf, sizeof(buf), "%ld", v);
+  s_ = buf;
+}
+
+static size_t EmuPrintUnsigned(Print& p, unsigned long v, int base) {
+  char buf[8 * sizeof(long) + 1];
+  char* s = buf + sizeof(buf) - 1;
+  *s = 0;
+  if (base < 2) base = DEC;
+  do {
+    unsigned d = (unsigned)(v % (unsigned)base);
+    *--s = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+    v /= (unsigned)base;
+  } while (v);
+  return p.write(s);
+}
+
+size_t Print::print(long v, int base) {
+  if (base == DEC && v < 0) return write((uint8_t)'-') + EmuPrintUnsigned(*this, 0ul - (unsigned long)v, DEC);
+  return EmuPrintUnsigned(*this, (unsigned long)v, base);
+}
+
+size_t Print::print(unsigned long v, int base) {
+  return EmuPrintUnsigned(*this, v, base);
+}
+
+size_t Print::print(double v, int digits) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return write(buf);
+}
+
+int Print::printf(const char* fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n > 0) write((const uint8_t*)buf, min((size_t)n, sizeof(buf) - 1));
+  return n;
+}
+
+// ---- Serial ----
+
+static std::deque<uint8_t> emuRx;
+static bool emuStdinOpen = true;
+static bool emuRawTty = false;
+static struct termios emuTtySaved;
+static uint8_t emuEsc = 0;             // arrow-key escape sequence state
+
+size_t EmuSerialWrite(const uint8_t* data, size_t len) {
+  EmuCount.serialBytes += len;
+  return fwrite(data, 1, len, stdout);
+}
+
+void EmuSerialFlush() {
+  fflush(stdout);
+}
+
+int EmuSerialAvailable() {
+  EmuPollInput();
+  return (int)emuRx.size();
+}
+
+int EmuSerialPeek() {
+  EmuPollInput();
+  return emuRx.empty() ? -1 : emuRx.front();
+}
+
+int EmuSerialRead() {
+  EmuPollInput();
+  if (emuRx.empty()) return -1;
+  int c = emuRx.front();
+  emuRx.pop_front();
+  return c;
+}
+
+// --keys: w/a/s/d or the arrows tilt the board, q quits, anything else goes to Serial
+static bool EmuKey(uint8_t c) {
+  if (emuEsc == 1) {
+    emuEsc = c == '[' ? 2 : 0;
+    return true;
+  }
+  if (emuEsc == 2) {
+    emuEsc = 0;
+    if (c == 'A') c = 'w';
+    else if (c == 'B') c = 's';
+    else if (c == 'C') c = 'd';
+    else if (c == 'D') c = 'a';
+    else return true;
+  } else if (c == 0x1B) {
+    emuEsc = 1;
+    return true;
+  }
+  switch (c) {
+    case 'w': EmuKeyTilt(0, -1); return true;
+    case 's': EmuKeyTilt(0, 1); return true;
+    case 'a': EmuKeyTilt(-1, 0); return true;
+    case 'd': EmuKeyTilt(1, 0); return true;
+    case 'q':
+    case 0x03: EmuExit(0); return true;
+    default: return false;
+  }
+}
+
+void EmuPollInput() {
+  if (!emuStdinOpen) return;
+  struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+  while (poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLIN | POLLHUP))) {
+    uint8_t buf[256];
+    ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) continue;
+      emuStdinOpen = false;  // EOF: nothing more will arrive
+      return;
+    }
+    for (ssize_t i = 0; i < n; ++i)
+      if (!EmuOpt.keys || !EmuKey(buf[i])) emuRx.push_back(buf[i]);
+  }
+}
+
+static void EmuRestoreTty() {
+  if (emuRawTty) tcsetattr(STDIN_FILENO, TCSANOW, &emuTtySaved);
+  emuRawTty = false;
+}
+
+static void EmuRawTty() {
+  if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &emuTtySaved) != 0) return;
+  struct termios raw = emuTtySaved;
+  raw.c_lflag &= ~(ICANON | ECHO | ISIG);
+  raw.c_cc[VMIN] = 0;
+  raw.c_cc[VTIME] = 0;
+  if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0) emuRawTty = true;
+}
+
+// ---- Run ----
+
+static void EmuSummary() {
+  if (EmuOpt.quiet) return;
+  double wall = EmuWallSeconds();
+  double virt = emuNowNs / 1e9;
+  fprintf(stderr,
+          "EMU: %.3f s virtual in %.3f s wall (%.1fx)  loops=%llu  shows=%llu  serial=%.1f kB  i2c=%.1f kB  scans=%llu\n",
+          virt, wall, wall > 0 ? virt / wall : 0.0, (unsigned long long)EmuCount.loops,
+          (unsigned long long)EmuCount.shows, EmuCount.serialBytes / 1024.0, EmuCount.i2cBytes / 1024.0,
+          (unsigned long long)EmuCount.scans);
+}
+
+void EmuExit(int code) {
+  fflush(stdout);
+  EmuRestoreTty();
+  EmuSummary();
+  _exit(code);
+}
+
+static void EmuSignal(int) {
+  EmuExit(0);
+}
+
+static void EmuUsage(const char* argv0) {
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  --speed S         virtual time runs at S x real time (default 1); 0 = as fast as possible\n"
+          "  --duration SEC    stop after SEC seconds of virtual time (default: run until q / Ctrl-C / EOF)\n"
+          "  --seed N          random() seed (default 1)\n"
+          "  --imu PATH        IMU trace: text 't_ms ax ay az [gx gy gz]' (g, deg/s), or MatrixRecord\n"
+          "                    recordings (mu_rec*.bin files or a directory of them)\n"
+          "  --rssi PATH       RSSI trace: text 't_ms bssid channel rssi [ssid]', or MatrixRecord recordings\n"
+          "  --ssid NAME       SSID for recorded RSSI inputs and text lines without one (default HIDER)\n"
+          "  --no-imu          no QMI8658 on the bus (sketches' missing-sensor path)\n"
+          "  --loop            repeat the traces\n"
+          "  --keys            w/a/s/d or arrows tilt the board (q quits); other keys go to Serial\n"
+          "  --show-frames     stream the LEDs as CSV frames every FRAME_RATE_MS, for sketches that don't\n"
+          "  --quiet           no summary line on exit\n",
+          argv0);
+}
+
+static bool EmuParseArgs(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    auto value = [&](const char* name) -> const char* {
+      if (i + 1 >= argc) {
+        fprintf(stderr, "EMU: %s needs a value\n", name);
+        return nullptr;
+      }
+      return argv[++i];
+    };
+    const char* v = nullptr;
+    if (!strcmp(a, "--speed")) {
+      if (!(v = value(a))) return false;
+      EmuOpt.speed = atof(v);
+    } else if (!strcmp(a, "--duration")) {
+      if (!(v = value(a))) return false;
+      EmuOpt.durationNs = (uint64_t)(atof(v) * 1e9);
+    } else if (!strcmp(a, "--seed")) {
+      if (!(v = value(a))) return false;
+      EmuOpt.seed = strtoul(v, nullptr, 0);
+    } else if (!strcmp(a, "--imu")) {
+      if (!(v = value(a))) return false;
+      EmuOpt.imuPath = v;
+    } else if (!strcmp(a, "--rssi")) {
+      if (!(v = value(a))) return false;
+      EmuOpt.rssiPath = v;
+    } else if (!strcmp(a, "--ssid")) {
+      if (!(v = value(a))) return false;
+      EmuOpt.ssid = v;
+    } else if (!strcmp(a, "--no-imu")) {
+      EmuOpt.noImu = true;
+    } else if (!strcmp(a, "--loop")) {
+      EmuOpt.loop = true;
+    } else if (!strcmp(a, "--keys")) {
+      EmuOpt.keys = true;
+    } else if (!strcmp(a, "--show-frames")) {
+      EmuOpt.showFrames = true;
+    } else if (!strcmp(a, "--quiet")) {
+      EmuOpt.quiet = true;
+    } else {
+      EmuUsage(argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (!EmuParseArgs(argc, argv)) return 2;
+  emuRng.seed((uint32_t)EmuOpt.seed);
+  if (!EmuDevicesBegin()) return 2;
+  if (EmuOpt.keys) EmuRawTty();
+  signal(SIGINT, EmuSignal);
+  signal(SIGTERM, EmuSignal);
+  signal(SIGPIPE, EmuSignal);  // the viewer went away
+  emuWall0 = std::chrono::steady_clock::now();
+
+  setup();
+  for (;;) {
+    loop();
+    EmuCount.loops++;
+    EmuAdvanceNs(EMU_LOOP_NS);
+  }
+}
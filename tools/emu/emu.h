@@ -0,0 +1,64 @@
+// emu.h - Host emulator runtime shared by the shims in tools/emu/shim
+// Virtual clock: every delay()/delayMicroseconds() advances it, a clock read costs EMU_CLOCK_READ_NS and
+// each loop() pass EMU_LOOP_NS, so polling loops terminate. With --speed S > 0 the emulator sleeps to keep
+// virtual time at S x wall time; --speed 0 runs as fast as the host allows.
+// Devices: a QMI8658 register model on the I2C bus (FIFO, data registers, temperature) fed from an IMU
+// trace, a WiFi scanner fed from an RSSI trace, and the LED strips (frames counted, optionally streamed).
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef EMU_CLOCK_READ_NS
+#define EMU_CLOCK_READ_NS 100         // cost of one millis()/micros() read
+#endif
+#ifndef EMU_LOOP_NS
+#define EMU_LOOP_NS 1000              // Arduino loop() wrapper overhead per pass
+#endif
+#ifndef EMU_CPU_MHZ
+#define EMU_CPU_MHZ 240               // reported by getCpuFrequencyMhz(), ESP.getCycleCount() rate
+#endif
+#ifndef EMU_I2C_HZ
+#define EMU_I2C_HZ 400000             // bus time charged per I2C byte (9 clocks)
+#endif
+
+// ---- Clock ----
+uint64_t EmuNowNs();
+void EmuAdvanceNs(uint64_t ns);       // moves virtual time forward (paced by --speed)
+
+// ---- Serial (stdout / stdin) ----
+size_t EmuSerialWrite(const uint8_t* data, size_t len);
+void EmuSerialFlush();
+int EmuSerialAvailable();
+int EmuSerialPeek();
+int EmuSerialRead();
+
+// ---- IMU ----
+struct EmuMotion {
+  float accel[3];                     // g
+  float gyro[3];                      // deg/s
+};
+EmuMotion EmuImuAt(uint64_t tUs);     // trace (or keyboard tilt) at virtual time tUs; level board by default
+float EmuImuTemperatureC();
+
+// I2C bus: true if a device answers at `addr`
+bool EmuI2cProbe(uint8_t addr);
+// Register write / read on the device at `addr` (auto-increment, except the QMI8658 FIFO_DATA port)
+bool EmuI2cWrite(uint8_t addr, uint8_t reg, const uint8_t* data, size_t len);
+bool EmuI2cRead(uint8_t addr, uint8_t reg, uint8_t* data, size_t len);
+
+// ---- WiFi ----
+struct EmuAp {
+  uint8_t bssid[6];
+  char ssid[33];
+  uint8_t channel;
+  int8_t rssi;
+};
+// APs a scan sees at the current virtual time: on `channel` (0 = all), matching `ssid` (null = any)
+int EmuWifiScan(uint8_t channel, const char* ssid, EmuAp* out, int max);
+
+// ---- LEDs ----
+// One show() of the LED library: `rgb` holds `count` RGB triplets in physical order (every chain, back
+// to back), before `brightness` is applied. Charges the WS2812 wire time (30 us per LED + reset).
+void EmuShowLeds(const uint8_t* rgb, uint16_t count, uint8_t brightness);
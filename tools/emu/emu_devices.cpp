@@ -0,0 +1,743 @@
+// emu_devices.cpp - Emulated peripherals: QMI8658 on I2C, WiFi scanner, LED output, and their traces
+// Traces are loaded once at start (EmuDevicesBegin) and indexed by virtual time:
+//  - IMU: text lines "t_ms ax ay az [gx gy gz]" (g, deg/s; '#' comments, spaces or commas), linearly
+//    interpolated; or MatrixRecord recordings, whose MU_REC_IN_IMU inputs (recorded on change) each
+//    hold until the next one.
+//  - RSSI: text lines "t_ms bssid channel rssi [ssid]", each AP holding its last value (rssi 0 = gone);
+//    or the MU_REC_IN_RSSI inputs of recordings.
+// Without an IMU trace the board lies flat (+1 g on Z); without an RSSI trace scans find nothing.
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <string>
+#include <vector>
+#include "emu_internal.h"
+#include "shim/Arduino.h"
+#include "shim/FastLED.h"
+#include "shim/SensorQMI8658.hpp"
+#include "shim/WiFi.h"
+#include "shim/Wire.h"
+
+TwoWire Wire;
+TwoWire Wire1;
+WiFiClass WiFi;
+CFastLED FastLED;
+
+#ifndef EMU_IMU_TEMP_C
+#define EMU_IMU_TEMP_C 30.0f          // die temperature reported without a trace
+#endif
+#ifndef EMU_KEY_TILT_G
+#define EMU_KEY_TILT_G 0.5f           // --keys tilt (sin of the angle)
+#endif
+#ifndef EMU_KEY_HOLD_MS
+#define EMU_KEY_HOLD_MS 250           // a key press holds the tilt this long (key repeat extends it)
+#endif
+
+// ---- Traces ----
+
+struct EmuImuPoint {
+  uint64_t tUs;
+  EmuMotion m;
+};
+
+struct EmuRssiPoint {
+  uint64_t tUs;
+  uint16_t ap;                        // index into emuAps
+  int8_t rssi;                        // 0 = out of range
+};
+
+static std::vector<EmuImuPoint> emuImu;
+static std::vector<EmuRssiPoint> emuRssi;
+static std::vector<EmuAp> emuAps;     // every AP the trace mentions, rssi = 0
+
+static uint16_t EmuApIndex(const uint8_t bssid[6], uint8_t channel, const char* ssid) {
+  for (size_t i = 0; i < emuAps.size(); ++i)
+    if (memcmp(emuAps[i].bssid, bssid, 6) == 0) return (uint16_t)i;
+  EmuAp ap = {};
+  memcpy(ap.bssid, bssid, 6);
+  snprintf(ap.ssid, sizeof(ap.ssid), "%s", ssid);
+  ap.channel = channel;
+  emuAps.push_back(ap);
+  return (uint16_t)(emuAps.size() - 1);
+}
+
+static bool EmuParseBssid(const char* s, uint8_t out[6]) {
+  unsigned v[6];
+  if (sscanf(s, "%x:%x:%x:%x:%x:%x", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) != 6) return false;
+  for (int i = 0; i < 6; ++i) out[i] = (uint8_t)v[i];
+  return true;
+}
+
+static bool EmuIsDir(const char* path) {
+  struct stat st;
+  return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static bool EmuIsRecording(const char* path) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  uint8_t b[2] = { 0, 0 };
+  bool rec = fread(b, 1, 2, f) == 2 && b[0] == 0xA5 && b[1] == 0x5A;
+  fclose(f);
+  return rec;
+}
+
+// CRC-16/CCITT-FALSE, as MU_Crc16 in MatrixUtil.h
+static uint16_t EmuCrc16(const uint8_t* p, size_t n) {
+  uint16_t crc = 0xFFFF;
+  while (n--) {
+    crc ^= (uint16_t)(*p++ << 8);
+    for (int k = 0; k < 8; ++k) crc = (uint16_t)(crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1);
+  }
+  return crc;
+}
+
+struct EmuRecord {
+  uint8_t type;
+  std::vector<uint8_t> payload;       // after the dt field
+  uint32_t dtUs;
+};
+
+// Every CRC-valid record of one recording file
+static std::vector<EmuRecord> EmuReadRecords(const char* path) {
+  std::vector<EmuRecord> out;
+  FILE* f = fopen(path, "rb");
+  if (!f) return out;
+  std::vector<uint8_t> d;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) d.insert(d.end(), buf, buf + n);
+  fclose(f);
+  size_t i = 0;
+  while (i + 9 <= d.size()) {
+    if (d[i] != 0xA5 || d[i + 1] != 0x5A) {
+      ++i;
+      continue;
+    }
+    uint16_t len = (uint16_t)(d[i + 5] | (d[i + 6] << 8));
+    if (i + 7 + len + 2 > d.size()) break;
+    uint16_t crc = (uint16_t)(d[i + 7 + len] | (d[i + 8 + len] << 8));
+    if (len < 4 || EmuCrc16(&d[i + 2], 5 + len) != crc) {
+      ++i;
+      continue;
+    }
+    const uint8_t* p = &d[i + 7];
+    EmuRecord r;
+    r.type = d[i + 2];
+    r.dtUs = (uint32_t)(p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+    r.payload.assign(p + 4, p + len);
+    out.push_back(std::move(r));
+    i += 9 + len;
+  }
+  return out;
+}
+
+// Recording files for `path` (a file or a directory of mu_rec*.bin), oldest first by META file sequence
+static std::vector<std::string> EmuRecordingFiles(const char* path) {
+  std::vector<std::string> files;
+  if (EmuIsDir(path)) {
+    if (DIR* dir = opendir(path)) {
+      while (struct dirent* e = readdir(dir))
+        if (!strncmp(e->d_name, "mu_rec", 6)) files.push_back(std::string(path) + "/" + e->d_name);
+      closedir(dir);
+    }
+  } else {
+    files.push_back(path);
+  }
+  auto seq = [](const std::string& f) -> uint32_t {
+    std::vector<EmuRecord> r = EmuReadRecords(f.c_str());
+    if (r.empty() || r[0].type != 0x10 || r[0].payload.size() < 12) return 0xFFFFFFFFu;
+    const uint8_t* p = r[0].payload.data() + 8;
+    return (uint32_t)(p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+  };
+  std::vector<std::pair<uint32_t, std::string>> keyed;
+  for (const std::string& f : files) keyed.push_back({ seq(f), f });
+  std::sort(keyed.begin(), keyed.end());
+  files.clear();
+  for (auto& k : keyed) files.push_back(k.second);
+  return files;
+}
+
+// MU_REC_INPUT records of the recordings at `path` into the IMU and/or RSSI traces
+static bool EmuLoadRecordings(const char* path, bool imu, bool rssi) {
+  std::vector<std::string> files = EmuRecordingFiles(path);
+  uint64_t t = 0;
+  bool first = true;                  // the first record's dt points before the recording
+  size_t inputs = 0;
+  for (const std::string& f : files) {
+    for (const EmuRecord& r : EmuReadRecords(f.c_str())) {
+      if (!first) t += r.dtUs;
+      first = false;
+      if (r.type != 0x13 || r.payload.empty()) continue;
+      const uint8_t* p = r.payload.data();
+      size_t n = r.payload.size();
+      if (imu && p[0] == 1 && n >= 1 + 24) {
+        EmuImuPoint pt;
+        pt.tUs = t;
+        float v[6];
+        memcpy(v, p + 1, sizeof(v));
+        for (int k = 0; k < 3; ++k) {
+          pt.m.accel[k] = v[k];
+          pt.m.gyro[k] = v[k + 3];
+        }
+        if (!emuImu.empty() && t > emuImu.back().tUs + 1) {  // hold, don't ramp, up to this sample
+          EmuImuPoint hold = emuImu.back();
+          hold.tUs = t - 1;
+          emuImu.push_back(hold);
+        }
+        emuImu.push_back(pt);
+        ++inputs;
+      } else if (rssi && p[0] == 2 && n >= 1 + 8) {
+        emuRssi.push_back({ t, EmuApIndex(p + 1, p[8], EmuOpt.ssid), (int8_t)p[7] });
+        ++inputs;
+      }
+    }
+  }
+  if (inputs == 0) {
+    fprintf(stderr, "EMU: no %s inputs in %s\n", imu ? "IMU" : "RSSI", path);
+    return false;
+  }
+  return true;
+}
+
+// Trace text lines, '#' comments and blanks skipped, commas read as spaces
+static bool EmuReadLines(const char* path, std::vector<std::string>& lines) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "EMU: cannot open %s\n", path);
+    return false;
+  }
+  char buf[256];
+  while (fgets(buf, sizeof(buf), f)) {
+    for (char* c = buf; *c; ++c)
+      if (*c == ',' || *c == '\t' || *c == '\r' || *c == '\n') *c = ' ';
+    char* hash = strchr(buf, '#');
+    if (hash) *hash = 0;
+    std::string s(buf);
+    if (s.find_first_not_of(' ') != std::string::npos) lines.push_back(s);
+  }
+  fclose(f);
+  return true;
+}
+
+static bool EmuLoadImuText(const char* path) {
+  std::vector<std::string> lines;
+  if (!EmuReadLines(path, lines)) return false;
+  for (const std::string& l : lines) {
+    double tMs;
+    float v[6] = { 0, 0, 0, 0, 0, 0 };
+    int n = sscanf(l.c_str(), "%lf %f %f %f %f %f %f", &tMs, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]);
+    if (n != 4 && n != 7) {
+      fprintf(stderr, "EMU: %s: bad IMU line '%s'\n", path, l.c_str());
+      return false;
+    }
+    EmuImuPoint pt;
+    pt.tUs = (uint64_t)(tMs * 1000);
+    for (int k = 0; k < 3; ++k) {
+      pt.m.accel[k] = v[k];
+      pt.m.gyro[k] = v[k + 3];
+    }
+    emuImu.push_back(pt);
+  }
+  return true;
+}
+
+static bool EmuLoadRssiText(const char* path) {
+  std::vector<std::string> lines;
+  if (!EmuReadLines(path, lines)) return false;
+  for (const std::string& l : lines) {
+    double tMs;
+    char bssid[32], ssid[64] = "";
+    int ch, rssi;
+    int n = sscanf(l.c_str(), "%lf %31s %d %d %63s", &tMs, bssid, &ch, &rssi, ssid);
+    uint8_t mac[6];
+    if (n < 4 || !EmuParseBssid(bssid, mac)) {
+      fprintf(stderr, "EMU: %s: bad RSSI line '%s'\n", path, l.c_str());
+      return false;
+    }
+    emuRssi.push_back({ (uint64_t)(tMs * 1000), EmuApIndex(mac, (uint8_t)ch, n >= 5 ? ssid : EmuOpt.ssid),
+                        (int8_t)constrain(rssi, -127, 0) });
+  }
+  return true;
+}
+
+bool EmuDevicesBegin() {
+  if (EmuOpt.imuPath) {
+    bool ok = EmuIsDir(EmuOpt.imuPath) || EmuIsRecording(EmuOpt.imuPath)
+                  ? EmuLoadRecordings(EmuOpt.imuPath, true, false)
+                  : EmuLoadImuText(EmuOpt.imuPath);
+    if (!ok) return false;
+    std::stable_sort(emuImu.begin(), emuImu.end(),
+                     [](const EmuImuPoint& a, const EmuImuPoint& b) { return a.tUs < b.tUs; });
+  }
+  if (EmuOpt.rssiPath) {
+    bool ok = EmuIsDir(EmuOpt.rssiPath) || EmuIsRecording(EmuOpt.rssiPath)
+                  ? EmuLoadRecordings(EmuOpt.rssiPath, false, true)
+                  : EmuLoadRssiText(EmuOpt.rssiPath);
+    if (!ok) return false;
+    std::stable_sort(emuRssi.begin(), emuRssi.end(),
+                     [](const EmuRssiPoint& a, const EmuRssiPoint& b) { return a.tUs < b.tUs; });
+  }
+  return true;
+}
+
+// Trace time for virtual time tUs (wrapped with --loop)
+static uint64_t EmuTraceTime(uint64_t tUs, uint64_t endUs) {
+  return EmuOpt.loop && endUs > 0 ? tUs % (endUs + 1) : tUs;
+}
+
+// ---- IMU ----
+
+static int emuKeyX = 0, emuKeyY = 0;
+static uint64_t emuKeyUntilNs = 0;
+
+void EmuKeyTilt(int x, int y) {
+  if (x) emuKeyX = x;
+  if (y) emuKeyY = y;
+  if (x && !y) emuKeyY = 0;
+  if (y && !x) emuKeyX = 0;
+  emuKeyUntilNs = EmuNowNs() + (uint64_t)EMU_KEY_HOLD_MS * 1000000;
+}
+
+EmuMotion EmuImuAt(uint64_t tUs) {
+  EmuMotion m = { { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } };
+  if (!emuImu.empty()) {
+    uint64_t t = EmuTraceTime(tUs, emuImu.back().tUs);
+    auto it = std::upper_bound(emuImu.begin(), emuImu.end(), t,
+                               [](uint64_t v, const EmuImuPoint& p) { return v < p.tUs; });
+    if (it == emuImu.begin()) {
+      m = it->m;
+    } else if (it == emuImu.end()) {
+      m = emuImu.back().m;
+    } else {
+      const EmuImuPoint& a = *(it - 1);
+      const EmuImuPoint& b = *it;
+      float f = (float)(t - a.tUs) / (float)(b.tUs - a.tUs);
+      for (int k = 0; k < 3; ++k) {
+        m.accel[k] = a.m.accel[k] + (b.m.accel[k] - a.m.accel[k]) * f;
+        m.gyro[k] = a.m.gyro[k] + (b.m.gyro[k] - a.m.gyro[k]) * f;
+      }
+    }
+  }
+  if (EmuNowNs() < emuKeyUntilNs) {
+    m.accel[0] = emuKeyX * EMU_KEY_TILT_G;
+    m.accel[1] = emuKeyY * EMU_KEY_TILT_G;
+    m.accel[2] = sqrtf(1.0f - (m.accel[0] * m.accel[0] + m.accel[1] * m.accel[1]));
+  }
+  return m;
+}
+
+float EmuImuTemperatureC() {
+  return EMU_IMU_TEMP_C;
+}
+
+// QMI8658 register model: enough of the datasheet for the SensorLib driver calls MatrixQMI.h makes and
+// MatrixIMU.h's FIFO path (CTRL9 handshake, stream FIFO, sample counter, burst reads, temperature), plus
+// the wake-on-motion engine (CAL1 threshold, STATUS1 event bit; no interrupt lines).
+#define EMU_QMI_WHO_AM_I    0x00
+#define EMU_QMI_REVISION    0x01
+#define EMU_QMI_CTRL2       0x03
+#define EMU_QMI_CTRL3       0x04
+#define EMU_QMI_CTRL7       0x08
+#define EMU_QMI_CTRL9       0x0A
+#define EMU_QMI_CAL1_L      0x0B
+#define EMU_QMI_CAL1_H      0x0C
+#define EMU_QMI_FIFO_CTRL   0x14
+#define EMU_QMI_FIFO_CNT    0x15
+#define EMU_QMI_FIFO_STATUS 0x16
+#define EMU_QMI_FIFO_DATA   0x17
+#define EMU_QMI_STATUSINT   0x2D
+#define EMU_QMI_STATUS0     0x2E
+#define EMU_QMI_STATUS1     0x2F
+#define EMU_QMI_TIMESTAMP   0x30
+#define EMU_QMI_TEMP_L      0x33
+#define EMU_QMI_AX_L        0x35
+
+struct EmuQmi {
+  uint8_t regs[0x80] = {};
+  std::deque<std::array<uint8_t, 12>> fifo;
+  size_t fifoPos = 0;                 // bytes of fifo.front() already read
+  size_t fifoBytes = 12;              // per sample: 6 with the gyroscope off
+  bool womArmed = false;              // CTRL_CMD_WRITE_WOM_SETTING issued
+  int16_t womRef[3] = {};             // accelerometer counts at the last event
+  uint8_t womBlank = 0;               // samples still ignored after arming (CAL1_H[5:0])
+  uint8_t status1 = 0;
+  uint64_t nextSampleUs = 0;
+  uint32_t timestamp = 0;             // sample counter (TIMESTAMP registers)
+  bool fresh = false;                 // STATUS0 data ready
+  uint8_t latest[12] = {};
+};
+
+static EmuQmi emuQmi;
+
+static const float kEmuAccOdr[] = { 8000, 4000, 2000, 1000, 500, 250, 125, 62.5f, 31.25f,
+                                    0, 0, 0, 128, 21, 11, 3 };  // 12..15: low-power modes
+static const float kEmuGyrOdr[] = { 7174.4f, 3587.2f, 1793.6f, 896.8f, 448.4f, 224.2f, 112.1f, 56.05f, 28.025f };
+
+static float EmuQmiOdr() {
+  uint8_t en = emuQmi.regs[EMU_QMI_CTRL7] & 0x03;
+  if (en & 0x02) return kEmuGyrOdr[min(emuQmi.regs[EMU_QMI_CTRL3] & 0x0F, 8)];  // 6DOF: gyro ODR
+  if (en & 0x01) return kEmuAccOdr[emuQmi.regs[EMU_QMI_CTRL2] & 0x0F];
+  return 0;
+}
+
+static float EmuQmiAccLsb() { return 16384.0f / (float)(1 << ((emuQmi.regs[EMU_QMI_CTRL2] >> 4) & 0x07)); }
+static float EmuQmiGyrLsb() { return 2048.0f / (float)(1 << ((emuQmi.regs[EMU_QMI_CTRL3] >> 4) & 0x07)); }
+
+static size_t EmuQmiFifoCap() {
+  return (size_t)16 << ((emuQmi.regs[EMU_QMI_FIFO_CTRL] >> 2) & 0x03);
+}
+
+static void EmuPut16(uint8_t* p, float v) {
+  int16_t s = (int16_t)constrain(lrintf(v), -32768L, 32767L);
+  p[0] = (uint8_t)s;
+  p[1] = (uint8_t)(s >> 8);
+}
+
+// Produce every sample due up to now (at most one FIFO's worth after a long gap)
+static void EmuQmiAdvance() {
+  float odr = EmuQmiOdr();
+  uint64_t now = EmuNowNs() / 1000;
+  if (odr <= 0) {
+    emuQmi.nextSampleUs = now;
+    return;
+  }
+  double period = 1e6 / odr;
+  if (emuQmi.nextSampleUs + 128 * period < now) emuQmi.nextSampleUs = now - (uint64_t)(128 * period);
+  bool streaming = (emuQmi.regs[EMU_QMI_FIFO_CTRL] & 0x03) != 0;
+  for (; emuQmi.nextSampleUs <= now; emuQmi.nextSampleUs += (uint64_t)period) {
+    EmuMotion m = EmuImuAt(emuQmi.nextSampleUs);
+    std::array<uint8_t, 12> s;
+    for (int k = 0; k < 3; ++k) {
+      EmuPut16(&s[k * 2], m.accel[k] * EmuQmiAccLsb());
+      EmuPut16(&s[6 + k * 2], m.gyro[k] * EmuQmiGyrLsb());
+    }
+    memcpy(emuQmi.latest, s.data(), 12);
+    emuQmi.fresh = true;
+    emuQmi.timestamp++;
+    if (emuQmi.womArmed) {
+      // Motion: any axis moved more than the CAL1_L threshold (mg) from the last event's reading
+      float lsbPerMg = EmuQmiAccLsb() / 1000.0f;
+      bool moved = false;
+      for (int k = 0; k < 3; ++k) {
+        int16_t a = (int16_t)(s[k * 2] | (s[k * 2 + 1] << 8));
+        if (abs(a - emuQmi.womRef[k]) > emuQmi.regs[EMU_QMI_CAL1_L] * lsbPerMg) moved = true;
+      }
+      if (emuQmi.womBlank) {
+        emuQmi.womBlank--;
+        moved = true;                 // settling: follow the reading without an event
+      } else if (moved) {
+        emuQmi.status1 |= 0x04;
+      }
+      if (moved) {
+        for (int k = 0; k < 3; ++k) emuQmi.womRef[k] = (int16_t)(s[k * 2] | (s[k * 2 + 1] << 8));
+      }
+    }
+    if (streaming) {
+      if (emuQmi.fifo.size() >= EmuQmiFifoCap()) {  // stream mode: the oldest sample goes
+        emuQmi.fifo.pop_front();
+        emuQmi.fifoPos = 0;
+      }
+      emuQmi.fifo.push_back(s);
+    }
+  }
+}
+
+static void EmuQmiWriteReg(uint8_t reg, uint8_t v) {
+  if (reg >= sizeof(emuQmi.regs)) return;
+  if (reg == EMU_QMI_CTRL9) {
+    if (v == 0x00) {
+      emuQmi.regs[EMU_QMI_STATUSINT] &= 0x7F;  // host ack clears CmdDone
+    } else {
+      if (v == 0x04) {                         // CTRL_CMD_RST_FIFO
+        emuQmi.fifo.clear();
+        emuQmi.fifoPos = 0;
+      } else if (v == 0x05) {                  // CTRL_CMD_REQ_FIFO: FIFO_DATA reads pop samples
+        emuQmi.regs[EMU_QMI_FIFO_CTRL] |= 0x80;
+      } else if (v == 0x08) {                  // CTRL_CMD_WRITE_WOM_SETTING: arm with the current reading
+        emuQmi.womArmed = emuQmi.regs[EMU_QMI_CAL1_L] != 0;
+        emuQmi.womBlank = (uint8_t)(emuQmi.regs[EMU_QMI_CAL1_H] & 0x3F) + 1;  // +1: the reference sample
+      }
+      emuQmi.regs[EMU_QMI_STATUSINT] |= 0x80;
+    }
+    emuQmi.regs[reg] = v;
+    return;
+  }
+  if (reg == EMU_QMI_CTRL7) {
+    if ((v & 0x03) && !(emuQmi.regs[reg] & 0x03)) emuQmi.nextSampleUs = EmuNowNs() / 1000;
+    size_t bytes = (v & 0x02) ? 12 : 6;  // accelerometer-only FIFO samples are half size
+    if (bytes != emuQmi.fifoBytes) {
+      emuQmi.fifo.clear();
+      emuQmi.fifoPos = 0;
+      emuQmi.fifoBytes = bytes;
+    }
+  }
+  emuQmi.regs[reg] = v;
+}
+
+static uint8_t EmuQmiReadReg(uint8_t reg) {
+  switch (reg) {
+    case EMU_QMI_WHO_AM_I: return 0x05;
+    case EMU_QMI_REVISION: return 0x7C;
+    case EMU_QMI_FIFO_CNT:
+    case EMU_QMI_FIFO_STATUS: {
+      uint16_t words = (uint16_t)(emuQmi.fifo.size() * emuQmi.fifoBytes / 2);
+      if (reg == EMU_QMI_FIFO_CNT) return (uint8_t)words;
+      uint8_t st = (uint8_t)((words >> 8) & 0x03);
+      if (!emuQmi.fifo.empty()) st |= 0x10;
+      if (emuQmi.fifo.size() >= EmuQmiFifoCap()) st |= 0x80;
+      return st;
+    }
+    case EMU_QMI_STATUS0: {
+      uint8_t st = emuQmi.fresh ? 0x03 : 0x00;
+      return st;
+    }
+    case EMU_QMI_STATUS1: {            // read clears the WoM event
+      uint8_t st = emuQmi.status1;
+      emuQmi.status1 = 0;
+      return st;
+    }
+    case EMU_QMI_TIMESTAMP: return (uint8_t)emuQmi.timestamp;
+    case EMU_QMI_TIMESTAMP + 1: return (uint8_t)(emuQmi.timestamp >> 8);
+    case EMU_QMI_TIMESTAMP + 2: return (uint8_t)(emuQmi.timestamp >> 16);
+    case EMU_QMI_TEMP_L:
+    case EMU_QMI_TEMP_L + 1: {
+      int16_t raw = (int16_t)lrintf(EmuImuTemperatureC() * 256.0f);
+      return reg == EMU_QMI_TEMP_L ? (uint8_t)raw : (uint8_t)(raw >> 8);
+    }
+    default:
+      if (reg >= EMU_QMI_AX_L && reg < EMU_QMI_AX_L + 12) {
+        if (reg == EMU_QMI_AX_L + 11) emuQmi.fresh = false;
+        return emuQmi.latest[reg - EMU_QMI_AX_L];
+      }
+      return reg < sizeof(emuQmi.regs) ? emuQmi.regs[reg] : 0;
+  }
+}
+
+bool EmuI2cProbe(uint8_t addr) {
+  if (EmuOpt.noImu) return false;
+  return addr == QMI8658_L_SLAVE_ADDRESS || addr == QMI8658_H_SLAVE_ADDRESS;
+}
+
+bool EmuI2cWrite(uint8_t addr, uint8_t reg, const uint8_t* data, size_t len) {
+  if (!EmuI2cProbe(addr)) return false;
+  EmuCount.i2cBytes += len + 1;
+  EmuQmiAdvance();
+  for (size_t i = 0; i < len; ++i) EmuQmiWriteReg((uint8_t)(reg + i), data[i]);
+  return true;
+}
+
+bool EmuI2cRead(uint8_t addr, uint8_t reg, uint8_t* data, size_t len) {
+  if (!EmuI2cProbe(addr)) return false;
+  EmuCount.i2cBytes += len + 1;
+  EmuQmiAdvance();
+  if (reg == EMU_QMI_FIFO_DATA) {
+    // Burst port: sample bytes in FIFO order, zeros once empty
+    for (size_t i = 0; i < len; ++i) {
+      if (emuQmi.fifo.empty()) {
+        data[i] = 0;
+        continue;
+      }
+      data[i] = emuQmi.fifo.front()[emuQmi.fifoPos++];
+      if (emuQmi.fifoPos == emuQmi.fifoBytes) {
+        emuQmi.fifo.pop_front();
+        emuQmi.fifoPos = 0;
+      }
+    }
+    return true;
+  }
+  for (size_t i = 0; i < len; ++i) data[i] = EmuQmiReadReg((uint8_t)(reg + i));
+  return true;
+}
+
+// ---- SensorQMI8658 (driver API over the register model) ----
+
+uint8_t SensorQMI8658::reg(uint8_t r) {
+  uint8_t v = 0;
+  EmuI2cRead(addr_, r, &v, 1);
+  return v;
+}
+
+void SensorQMI8658::setReg(uint8_t r, uint8_t v) {
+  EmuI2cWrite(addr_, r, &v, 1);
+}
+
+bool SensorQMI8658::begin(TwoWire& wire, uint8_t addr, int sda, int scl) {
+  (void)wire;
+  (void)sda;
+  (void)scl;
+  if (!EmuI2cProbe(addr)) return false;
+  addr_ = addr;
+  setReg(0x02, 0x60);                 // CTRL1: address auto-increment, little endian
+  return getChipID() == 0x05;
+}
+
+uint8_t SensorQMI8658::getChipID() {
+  return reg(EMU_QMI_WHO_AM_I);
+}
+
+int SensorQMI8658::configAccelerometer(AccelRange range, AccelODR odr, LpfMode lpf) {
+  (void)lpf;
+  setReg(EMU_QMI_CTRL2, (uint8_t)((range << 4) | (odr & 0x0F)));
+  accLsb_ = 16384.0f / (float)(1 << range);
+  return 0;
+}
+
+int SensorQMI8658::configGyroscope(GyroRange range, GyroODR odr, LpfMode lpf) {
+  (void)lpf;
+  setReg(EMU_QMI_CTRL3, (uint8_t)((range << 4) | (odr & 0x0F)));
+  gyrLsb_ = 2048.0f / (float)(1 << range);
+  return 0;
+}
+
+bool SensorQMI8658::enableAccelerometer() {
+  setReg(EMU_QMI_CTRL7, reg(EMU_QMI_CTRL7) | 0x01);
+  return true;
+}
+
+bool SensorQMI8658::enableGyroscope() {
+  setReg(EMU_QMI_CTRL7, reg(EMU_QMI_CTRL7) | 0x02);
+  return true;
+}
+
+bool SensorQMI8658::disableAccelerometer() {
+  setReg(EMU_QMI_CTRL7, reg(EMU_QMI_CTRL7) & ~0x01);
+  return true;
+}
+
+bool SensorQMI8658::disableGyroscope() {
+  setReg(EMU_QMI_CTRL7, reg(EMU_QMI_CTRL7) & ~0x02);
+  return true;
+}
+
+bool SensorQMI8658::getDataReady() {
+  return (reg(EMU_QMI_STATUS0) & 0x03) != 0;
+}
+
+bool SensorQMI8658::readAxes(uint8_t first, float lsb, float& x, float& y, float& z) {
+  uint8_t b[6];
+  if (!EmuI2cRead(addr_, first, b, 6)) return false;
+  x = (int16_t)(b[0] | (b[1] << 8)) / lsb;
+  y = (int16_t)(b[2] | (b[3] << 8)) / lsb;
+  z = (int16_t)(b[4] | (b[5] << 8)) / lsb;
+  return true;
+}
+
+bool SensorQMI8658::getAccelerometer(float& x, float& y, float& z) {
+  return readAxes(EMU_QMI_AX_L, accLsb_, x, y, z);
+}
+
+bool SensorQMI8658::getGyroscope(float& x, float& y, float& z) {
+  return readAxes(EMU_QMI_AX_L + 6, gyrLsb_, x, y, z);  // reading GZ_H clears data ready
+}
+
+uint32_t SensorQMI8658::getTimestamp() {
+  uint8_t b[3];
+  EmuI2cRead(addr_, EMU_QMI_TIMESTAMP, b, 3);
+  return (uint32_t)(b[0] | (b[1] << 8) | (b[2] << 16));
+}
+
+float SensorQMI8658::getTemperature_C() {
+  uint8_t b[2];
+  EmuI2cRead(addr_, EMU_QMI_TEMP_L, b, 2);
+  return (int16_t)(b[0] | (b[1] << 8)) / 256.0f;
+}
+
+void SensorQMI8658::dumpCtrlRegister() {
+  printf("EMU QMI8658:");
+  for (uint8_t r = 0x02; r <= 0x0A; ++r) printf(" CTRL%u=0x%02X", r - 1, reg(r));
+  printf("\r\n");
+}
+
+// ---- WiFi ----
+
+int EmuWifiScan(uint8_t channel, const char* ssid, EmuAp* out, int max) {
+  EmuCount.scans++;
+  if (emuRssi.empty()) return 0;
+  uint64_t t = EmuTraceTime(EmuNowNs() / 1000, emuRssi.back().tUs);
+  std::vector<int8_t> rssi(emuAps.size(), 0);
+  for (const EmuRssiPoint& p : emuRssi) {
+    if (p.tUs > t) break;
+    rssi[p.ap] = p.rssi;
+  }
+  int n = 0;
+  for (size_t i = 0; i < emuAps.size() && n < max; ++i) {
+    const EmuAp& ap = emuAps[i];
+    if (!rssi[i] || (channel && ap.channel != channel) || (ssid && *ssid && strcmp(ap.ssid, ssid))) continue;
+    out[n] = ap;
+    out[n].rssi = rssi[i];
+    ++n;
+  }
+  // Strongest first, like the IDF scan list
+  std::sort(out, out + n, [](const EmuAp& a, const EmuAp& b) { return a.rssi > b.rssi; });
+  return n;
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool showHidden, bool passive, uint32_t maxMsPerChan, uint8_t channel,
+                                const char* ssid, const uint8_t* bssid) {
+  (void)showHidden;
+  (void)passive;
+  (void)bssid;
+  if (mode_ == WIFI_OFF || running_) return WIFI_SCAN_FAILED;
+  scanDelete();
+  scanChannel_ = channel;
+  scanFiltered_ = ssid != nullptr;
+  snprintf(scanSsid_, sizeof(scanSsid_), "%s", ssid ? ssid : "");
+  uint64_t dwellNs = (uint64_t)maxMsPerChan * 1000000 * (channel ? 1 : 13);
+  if (async) {
+    running_ = true;
+    doneNs_ = EmuNowNs() + dwellNs;
+    return WIFI_SCAN_RUNNING;
+  }
+  EmuAdvanceNs(dwellNs);
+  count_ = (int16_t)EmuWifiScan(scanChannel_, scanFiltered_ ? scanSsid_ : nullptr, results_, EMU_WIFI_MAX_RESULTS);
+  return count_;
+}
+
+int16_t WiFiClass::scanComplete() {
+  if (running_) {
+    if (EmuNowNs() < doneNs_) return WIFI_SCAN_RUNNING;
+    running_ = false;
+    count_ = (int16_t)EmuWifiScan(scanChannel_, scanFiltered_ ? scanSsid_ : nullptr, results_, EMU_WIFI_MAX_RESULTS);
+  }
+  return count_;
+}
+
+void WiFiClass::scanDelete() {
+  count_ = 0;
+}
+
+String WiFiClass::BSSIDstr(uint8_t i) const {
+  if (i >= count_) return String();
+  char buf[18];
+  const uint8_t* b = results_[i].bssid;
+  snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", b[0], b[1], b[2], b[3], b[4], b[5]);
+  return String(buf);
+}
+
+// ---- LEDs ----
+
+// Every controller's LEDs back to back, as the chains sit in the sketch's array
+void CFastLED::show(uint8_t scale) {
+  static uint8_t frame[3 * 4096];
+  size_t n = 0;
+  for (int c = 0; c < count_; ++c) {
+    const CRGB* leds = controllers_[c].leds();
+    for (int i = 0; i < controllers_[c].size() && n < sizeof(frame) / 3; ++i, ++n) {
+      frame[n * 3] = leds[i].r;
+      frame[n * 3 + 1] = leds[i].g;
+      frame[n * 3 + 2] = leds[i].b;
+    }
+  }
+  EmuShowLeds(frame, (uint16_t)n, scale);
+}
+
+void EmuShowLeds(const uint8_t* rgb, uint16_t count, uint8_t brightness) {
+  (void)brightness;
+  EmuCount.shows++;
+  EmuAdvanceNs((uint64_t)count * 30000 + 50000);  // 24 bits x 1.25 us per LED, then the reset gap
+  if (EmuOpt.showFrames) EmuFramesShow(rgb, count);
+}
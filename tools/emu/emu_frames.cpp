@@ -0,0 +1,33 @@
+// emu_frames.cpp - --show-frames: stream what the LEDs show as META: + FRAME: lines for led_matrix_viz.py
+// Uses the board profile and MatrixUtil.h (MU_PrintMeta / MU_SendFrameCSV) like a sketch would, so the
+// physical-to-XY mapping, tiles and rotation match the firmware's own frame dumps.
+
+#include "emu_internal.h"
+#include "config/BoardConfig.h"
+#include "lib/MatrixUtil/MatrixUtil.h"
+
+bool EmuFramePending = false;
+
+static CRGB emuFrame[MU_NUM_LEDS];
+static uint64_t emuFrameLastNs = 0;
+static bool emuMetaSent = false;
+
+void EmuFramesShow(const uint8_t* rgb, uint16_t count) {
+  uint16_t n = min(count, (uint16_t)MU_NUM_LEDS);
+  for (uint16_t i = 0; i < n; ++i) emuFrame[i] = CRGB(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+  EmuFramePending = true;
+  EmuFramesService();
+}
+
+// Newest frame, at most one per FRAME_RATE_MS of virtual time; a frame shown in between goes out late
+void EmuFramesService() {
+  uint64_t now = EmuNowNs();
+  if (emuMetaSent && now - emuFrameLastNs < (uint64_t)FRAME_RATE_MS * 1000000) return;
+  EmuFramePending = false;  // before sending: the serial write may advance the clock
+  emuFrameLastNs = now;
+  if (!emuMetaSent) {
+    MU_PrintMeta();
+    emuMetaSent = true;
+  }
+  MU_SendFrameCSV(emuFrame);
+}
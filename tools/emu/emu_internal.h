@@ -0,0 +1,40 @@
+// emu_internal.h - Emulator runtime state shared by emu.cpp and emu_devices.cpp (not seen by sketches)
+
+#pragma once
+
+#include <stdint.h>
+#include "emu.h"
+
+struct EmuOptions {
+  double speed = 1.0;             // virtual / wall time; 0 = unpaced
+  uint64_t durationNs = 0;        // 0 = run until stopped
+  unsigned long seed = 1;
+  const char* imuPath = nullptr;
+  const char* rssiPath = nullptr;
+  const char* ssid = "HIDER";
+  bool noImu = false;             // nothing answers on I2C (missing / unwired sensor)
+  bool loop = false;
+  bool keys = false;
+  bool showFrames = false;
+  bool quiet = false;
+};
+
+struct EmuCounters {
+  uint64_t loops = 0;
+  uint64_t shows = 0;
+  uint64_t serialBytes = 0;
+  uint64_t i2cBytes = 0;
+  uint64_t scans = 0;
+};
+
+extern EmuOptions EmuOpt;
+extern EmuCounters EmuCount;
+
+bool EmuDevicesBegin();              // load the traces; false (with a message) on a bad file
+void EmuPollInput();                 // stdin -> Serial RX / --keys
+void EmuKeyTilt(int x, int y);       // --keys: tilt toward x/y (-1, 0, 1) for a moment
+[[noreturn]] void EmuExit(int code);
+// --show-frames (emu_frames.cpp): keep the newest frame, stream it FRAME_RATE_MS apart
+void EmuFramesShow(const uint8_t* rgb, uint16_t count);
+extern bool EmuFramePending;
+void EmuFramesService();
@@ -0,0 +1,77 @@
+// Adafruit_NeoPixel.h - Host emulator shim: pixel buffer + show() into the emulator
+// The buffer holds colors as set (RGB, unscaled); brightness travels with the frame like FastLED's.
+
+#pragma once
+
+#include "Arduino.h"
+
+#define NEO_RGB ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_RBG ((0 << 6) | (0 << 4) | (2 << 2) | (1))
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_GBR ((2 << 6) | (2 << 4) | (0 << 2) | (1))
+#define NEO_BRG ((1 << 6) | (1 << 4) | (2 << 2) | (0))
+#define NEO_BGR ((2 << 6) | (2 << 4) | (1 << 2) | (0))
+#define NEO_KHZ800 0x0000
+#define NEO_KHZ400 0x0100
+
+typedef uint16_t neoPixelType;
+
+class Adafruit_NeoPixel {
+ public:
+  Adafruit_NeoPixel(uint16_t n, int16_t pin = 6, neoPixelType type = NEO_GRB + NEO_KHZ800)
+      : n_(n), pin_(pin), type_(type), px_(new uint8_t[n * 3u]()) {}
+  ~Adafruit_NeoPixel() { delete[] px_; }
+  Adafruit_NeoPixel(const Adafruit_NeoPixel&) = delete;
+  Adafruit_NeoPixel& operator=(const Adafruit_NeoPixel&) = delete;
+
+  void begin() {}
+  void show() { EmuShowLeds(px_, n_, getBrightness()); }
+  bool canShow() const { return true; }
+  void clear() { memset(px_, 0, n_ * 3u); }
+  void fill(uint32_t c = 0, uint16_t first = 0, uint16_t count = 0) {
+    uint16_t end = count ? min<uint16_t>((uint16_t)(first + count), n_) : n_;
+    for (uint16_t i = first; i < end; ++i) setPixelColor(i, c);
+  }
+  void setPixelColor(uint16_t i, uint8_t r, uint8_t g, uint8_t b) {
+    if (i >= n_) return;
+    px_[i * 3] = r;
+    px_[i * 3 + 1] = g;
+    px_[i * 3 + 2] = b;
+  }
+  void setPixelColor(uint16_t i, uint32_t c) { setPixelColor(i, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c); }
+  uint32_t getPixelColor(uint16_t i) const {
+    return i < n_ ? Color(px_[i * 3], px_[i * 3 + 1], px_[i * 3 + 2]) : 0;
+  }
+  // Stored like the library does: 0 = full, otherwise brightness + 1
+  void setBrightness(uint8_t b) { brightness_ = (uint8_t)(b + 1); }
+  uint8_t getBrightness() const { return (uint8_t)(brightness_ - 1); }
+  uint8_t* getPixels() const { return px_; }
+  uint16_t numPixels() const { return n_; }
+  int16_t getPin() const { return pin_; }
+  neoPixelType getType() const { return type_; }
+
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+  static uint32_t ColorHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255);
+
+ private:
+  uint16_t n_;
+  int16_t pin_;
+  neoPixelType type_;
+  uint8_t* px_;
+  uint8_t brightness_ = 0;
+};
+
+inline uint32_t Adafruit_NeoPixel::ColorHSV(uint16_t hue, uint8_t sat, uint8_t val) {
+  uint32_t h6 = (uint32_t)hue * 6;
+  uint8_t sector = (uint8_t)(h6 >> 16), frac = (uint8_t)(h6 >> 8);
+  auto sc = [](uint8_t a, uint8_t b) { return (uint8_t)(((uint16_t)a * (b + 1)) >> 8); };
+  uint8_t p = sc(val, 255 - sat), q = sc(val, 255 - sc(sat, frac)), t = sc(val, 255 - sc(sat, 255 - frac));
+  switch (sector) {
+    case 0: return Color(val, t, p);
+    case 1: return Color(q, val, p);
+    case 2: return Color(p, val, t);
+    case 3: return Color(p, q, val);
+    case 4: return Color(t, p, val);
+    default: return Color(val, p, q);
+  }
+}
@@ -0,0 +1,164 @@
+// Arduino.h - Host emulator shim: the Arduino core subset the examples and lib/MatrixUtil use
+// Time is virtual (tools/emu/emu.h): millis()/micros() read the emulator clock, delay() advances it.
+// Serial goes to stdout (frames, META:, logs) and reads stdin without blocking.
+
+#pragma once
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include "../emu.h"
+
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PROGMEM
+#define IRAM_ATTR
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define F(s) (s)
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+static inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// GPIO: writes are remembered, inputs read LOW, interrupts never fire
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+static inline int digitalPinToInterrupt(int pin) { return pin; }
+void attachInterrupt(int irq, void (*fn)(void), int mode);
+void detachInterrupt(int irq);
+
+uint32_t getCpuFrequencyMhz();
+
+// Small Arduino String: enough for WiFi.SSID(i) == "name" and printing
+class String {
+ public:
+  String(const char* s = "") : s_(s ? s : "") {}
+  String(const std::string& s) : s_(s) {}
+  String(char c) : s_(1, c) {}
+  explicit String(long v, int base = DEC);
+  const char* c_str() const { return s_.c_str(); }
+  size_t length() const { return s_.size(); }
+  bool equals(const String& o) const { return s_ == o.s_; }
+  bool operator==(const String& o) const { return s_ == o.s_; }
+  bool operator==(const char* o) const { return s_ == (o ? o : ""); }
+  bool operator!=(const String& o) const { return s_ != o.s_; }
+  bool operator!=(const char* o) const { return !(*this == o); }
+  String& operator+=(const String& o) { s_ += o.s_; return *this; }
+  String& operator+=(const char* o) { s_ += o ? o : ""; return *this; }
+  String& operator+=(char c) { s_ += c; return *this; }
+  String operator+(const String& o) const { return String(s_ + o.s_); }
+  char operator[](size_t i) const { return i < s_.size() ? s_[i] : 0; }
+  bool startsWith(const String& p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+  int indexOf(char c, size_t from = 0) const {
+    size_t i = s_.find(c, from);
+    return i == std::string::npos ? -1 : (int)i;
+  }
+  String substring(size_t from, size_t to = std::string::npos) const {
+    if (from > s_.size()) return String();
+    return String(s_.substr(from, to == std::string::npos ? std::string::npos : to - from));
+  }
+  long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(s_.c_str(), nullptr); }
+
+ private:
+  std::string s_;
+};
+
+class Print {
+ public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* data, size_t len) {
+    size_t n = 0;
+    while (len--) n += write(*data++);
+    return n;
+  }
+  size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+  size_t write(const char* s, size_t len) { return write((const uint8_t*)s, len); }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC);
+  size_t print(unsigned long v, int base = DEC);
+  size_t print(long long v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned long long v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(double v, int digits = 2);
+
+  template <class T>
+  size_t println(const T& v) { return print(v) + println(); }
+  template <class T>
+  size_t println(const T& v, int fmt) { return print(v, fmt) + println(); }
+  size_t println() { return write("\r\n"); }
+
+  int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// USB-CDC Serial: stdout / stdin of the emulator process
+class HardwareSerial : public Print {
+ public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+  using Print::write;
+  size_t write(uint8_t c) override { return EmuSerialWrite(&c, 1); }
+  size_t write(const uint8_t* data, size_t len) override { return EmuSerialWrite(data, len); }
+  int available() { return EmuSerialAvailable(); }
+  int peek() { return EmuSerialPeek(); }
+  int read() { return EmuSerialRead(); }
+  int availableForWrite() { return 4096; }
+  void flush() { EmuSerialFlush(); }
+  explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+ public:
+  uint32_t getCycleCount();   // virtual time at getCpuFrequencyMhz()
+  uint32_t getFreeHeap() { return 256 * 1024; }
+  void restart();
+};
+
+extern EspClass ESP;
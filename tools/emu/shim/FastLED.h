@@ -0,0 +1,179 @@
+// FastLED.h - Host emulator shim: CRGB/CHSV, the 8-bit math helpers and FastLED.addLeds/show
+// show() hands every registered controller's LEDs (in registration order, i.e. chain order) to the
+// emulator as one frame; brightness is passed along, not applied to the buffers.
+
+#pragma once
+
+#include "Arduino.h"
+
+static inline uint8_t scale8(uint8_t i, uint8_t scale) { return (uint8_t)(((uint16_t)i * (1 + (uint16_t)scale)) >> 8); }
+static inline uint8_t scale8_video(uint8_t i, uint8_t scale) {
+  return (uint8_t)((((uint16_t)i * scale) >> 8) + ((i && scale) ? 1 : 0));
+}
+static inline uint8_t qadd8(uint8_t a, uint8_t b) { return (uint8_t)min(255, a + b); }
+static inline uint8_t qsub8(uint8_t a, uint8_t b) { return a > b ? (uint8_t)(a - b) : 0; }
+static inline uint8_t lerp8by8(uint8_t a, uint8_t b, uint8_t frac) {
+  return b > a ? (uint8_t)(a + scale8(b - a, frac)) : (uint8_t)(a - scale8(a - b, frac));
+}
+static inline uint8_t random8() { return (uint8_t)random(256); }
+static inline uint8_t random8(uint8_t lim) { return (uint8_t)random(lim); }
+static inline uint8_t random8(uint8_t lo, uint8_t hi) { return (uint8_t)random(lo, hi); }
+static inline uint16_t random16() { return (uint16_t)random(65536); }
+static inline uint16_t random16(uint16_t lim) { return (uint16_t)random(lim); }
+static inline uint8_t sin8(uint8_t theta) {
+  return (uint8_t)lrintf(127.5f + 127.5f * sinf(theta * (float)(2.0 * M_PI / 256.0)));
+}
+static inline uint8_t cos8(uint8_t theta) { return sin8((uint8_t)(theta + 64)); }
+static inline uint8_t beatsin8(uint8_t bpm, uint8_t lo = 0, uint8_t hi = 255) {
+  uint8_t beat = (uint8_t)(((uint64_t)millis() * bpm * 256) / 60000);
+  return (uint8_t)(lo + scale8(sin8(beat), hi - lo));
+}
+
+struct CHSV {
+  union {
+    struct { uint8_t h, s, v; };
+    uint8_t raw[3];
+  };
+  CHSV() = default;
+  constexpr CHSV(uint8_t H, uint8_t S, uint8_t V) : h(H), s(S), v(V) {}
+};
+
+struct CRGB {
+  union {
+    struct { uint8_t r, g, b; };
+    uint8_t raw[3];
+  };
+
+  enum HTMLColorCode : uint32_t {
+    Black = 0x000000, White = 0xFFFFFF, Red = 0xFF0000, Green = 0x008000, Lime = 0x00FF00, Blue = 0x0000FF,
+    Yellow = 0xFFFF00, Cyan = 0x00FFFF, Aqua = 0x00FFFF, Magenta = 0xFF00FF, Purple = 0x800080,
+    Orange = 0xFFA500, Pink = 0xFFC0CB, Gray = 0x808080, Grey = 0x808080, DarkGreen = 0x006400,
+    DarkBlue = 0x00008B, DarkRed = 0x8B0000, Gold = 0xFFD700, Navy = 0x000080, Teal = 0x008080,
+    Violet = 0xEE82EE, Brown = 0xA52A2A,
+  };
+
+  CRGB() = default;
+  constexpr CRGB(uint8_t R, uint8_t G, uint8_t B) : r(R), g(G), b(B) {}
+  constexpr CRGB(uint32_t c) : r((uint8_t)(c >> 16)), g((uint8_t)(c >> 8)), b((uint8_t)c) {}
+  constexpr CRGB(HTMLColorCode c) : CRGB((uint32_t)c) {}
+  CRGB(const CHSV& hsv);
+
+  uint8_t& operator[](uint8_t i) { return raw[i]; }
+  const uint8_t& operator[](uint8_t i) const { return raw[i]; }
+  bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+  bool operator!=(const CRGB& o) const { return !(*this == o); }
+  explicit operator bool() const { return r || g || b; }
+
+  CRGB& operator+=(const CRGB& o) { r = qadd8(r, o.r); g = qadd8(g, o.g); b = qadd8(b, o.b); return *this; }
+  CRGB& operator-=(const CRGB& o) { r = qsub8(r, o.r); g = qsub8(g, o.g); b = qsub8(b, o.b); return *this; }
+  CRGB& nscale8(uint8_t s) { r = scale8(r, s); g = scale8(g, s); b = scale8(b, s); return *this; }
+  CRGB& nscale8_video(uint8_t s) { r = scale8_video(r, s); g = scale8_video(g, s); b = scale8_video(b, s); return *this; }
+  CRGB& fadeToBlackBy(uint8_t amount) { return nscale8(255 - amount); }
+  CRGB& setRGB(uint8_t R, uint8_t G, uint8_t B) { r = R; g = G; b = B; return *this; }
+  CRGB& setHSV(uint8_t h, uint8_t s, uint8_t v) { return *this = CRGB(CHSV(h, s, v)); }
+  uint8_t getLuma() const { return (uint8_t)((r * 54 + g * 183 + b * 18) >> 8); }
+};
+
+static inline CRGB operator+(CRGB a, const CRGB& b) { return a += b; }
+static inline CRGB operator-(CRGB a, const CRGB& b) { return a -= b; }
+
+// Six-sector HSV (FastLED's "spectrum" flavour), h = 0..255 for a full turn
+static inline void hsv2rgb_spectrum(const CHSV& hsv, CRGB& out) {
+  uint16_t h6 = (uint16_t)hsv.h * 6;
+  uint8_t sector = (uint8_t)(h6 >> 8), frac = (uint8_t)h6;
+  uint8_t v = hsv.v, s = hsv.s;
+  uint8_t p = scale8(v, 255 - s);
+  uint8_t q = scale8(v, 255 - scale8(s, frac));
+  uint8_t t = scale8(v, 255 - scale8(s, 255 - frac));
+  switch (sector) {
+    case 0: out = CRGB(v, t, p); break;
+    case 1: out = CRGB(q, v, p); break;
+    case 2: out = CRGB(p, v, t); break;
+    case 3: out = CRGB(p, q, v); break;
+    case 4: out = CRGB(t, p, v); break;
+    default: out = CRGB(v, p, q); break;
+  }
+}
+static inline void hsv2rgb_rainbow(const CHSV& hsv, CRGB& out) { hsv2rgb_spectrum(hsv, out); }
+inline CRGB::CRGB(const CHSV& hsv) { hsv2rgb_spectrum(hsv, *this); }
+
+static inline CRGB blend(const CRGB& a, const CRGB& b, uint8_t amount) {
+  return CRGB(lerp8by8(a.r, b.r, amount), lerp8by8(a.g, b.g, amount), lerp8by8(a.b, b.b, amount));
+}
+static inline void fill_solid(CRGB* leds, int n, const CRGB& c) {
+  for (int i = 0; i < n; ++i) leds[i] = c;
+}
+static inline void fill_rainbow(CRGB* leds, int n, uint8_t hue, uint8_t delta = 5) {
+  for (int i = 0; i < n; ++i, hue += delta) leds[i] = CHSV(hue, 240, 255);
+}
+static inline void fadeToBlackBy(CRGB* leds, uint16_t n, uint8_t amount) {
+  for (uint16_t i = 0; i < n; ++i) leds[i].fadeToBlackBy(amount);
+}
+static inline void nscale8(CRGB* leds, uint16_t n, uint8_t scale) {
+  for (uint16_t i = 0; i < n; ++i) leds[i].nscale8(scale);
+}
+
+// FastLED's octal color orders (digit = source channel for each wire position)
+enum EOrder { RGB = 0012, RBG = 0021, GRB = 0102, GBR = 0120, BRG = 0201, BGR = 0210 };
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2812B {};
+template <uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2812 {};
+template <uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2811 {};
+template <uint8_t DATA_PIN, EOrder RGB_ORDER> class SK6812 {};
+template <uint8_t DATA_PIN> class NEOPIXEL {};
+
+class CLEDController {
+ public:
+  CLEDController& setLeds(CRGB* leds, int count) { leds_ = leds; count_ = count; return *this; }
+  CRGB* leds() { return leds_; }
+  int size() const { return count_; }
+  uint8_t pin = 0;
+
+ private:
+  CRGB* leds_ = nullptr;
+  int count_ = 0;
+};
+
+#ifndef EMU_FASTLED_MAX_CONTROLLERS
+#define EMU_FASTLED_MAX_CONTROLLERS 8
+#endif
+
+class CFastLED {
+ public:
+  template <template <uint8_t, EOrder> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
+  CLEDController& addLeds(CRGB* leds, int count, int offset = 0) {
+    return add(DATA_PIN, leds + offset, count);
+  }
+  template <template <uint8_t> class CHIPSET, uint8_t DATA_PIN>
+  CLEDController& addLeds(CRGB* leds, int count, int offset = 0) {
+    return add(DATA_PIN, leds + offset, count);
+  }
+
+  void show() { show(brightness_); }
+  void show(uint8_t scale);
+  void clear(bool writeData = false) {
+    for (int i = 0; i < count_; ++i) fill_solid(controllers_[i].leds(), controllers_[i].size(), CRGB::Black);
+    if (writeData) show();
+  }
+  void delay(unsigned long ms) { show(); ::delay(ms); }
+  void setBrightness(uint8_t b) { brightness_ = b; }
+  uint8_t getBrightness() const { return brightness_; }
+  void setMaxPowerInVoltsAndMilliamps(uint8_t, uint32_t) {}
+  void setMaxRefreshRate(uint16_t, bool = false) {}
+  int count() const { return count_; }
+  int size() const { return count_ ? controllers_[0].size() : 0; }
+  CRGB* leds() { return count_ ? controllers_[0].leds() : nullptr; }
+  CLEDController& operator[](int i) { return controllers_[i < count_ ? i : 0]; }
+
+ private:
+  CLEDController& add(uint8_t pin, CRGB* leds, int count) {
+    CLEDController& c = controllers_[count_ < EMU_FASTLED_MAX_CONTROLLERS ? count_++ : EMU_FASTLED_MAX_CONTROLLERS - 1];
+    c.pin = pin;
+    return c.setLeds(leds, count);
+  }
+  CLEDController controllers_[EMU_FASTLED_MAX_CONTROLLERS];
+  int count_ = 0;
+  uint8_t brightness_ = 255;
+};
+
+extern CFastLED FastLED;
@@ -0,0 +1,60 @@
+// SensorQMI8658.hpp - Host emulator shim of the SensorLib QMI8658 driver, on top of the emulator's
+// register model (tools/emu/emu_devices.cpp). Configuration goes to the same CTRL registers the real
+// driver writes, so MatrixIMU.h's raw FIFO path and this polled API see one device.
+
+#pragma once
+
+#include "Arduino.h"
+#include "Wire.h"
+
+#define QMI8658_L_SLAVE_ADDRESS 0x6B
+#define QMI8658_H_SLAVE_ADDRESS 0x6A
+
+typedef struct __IMUdata {
+  float x;
+  float y;
+  float z;
+} IMUdata;
+
+class SensorQMI8658 {
+ public:
+  enum AccelRange { ACC_RANGE_2G, ACC_RANGE_4G, ACC_RANGE_8G, ACC_RANGE_16G };
+  enum AccelODR {
+    ACC_ODR_8000Hz, ACC_ODR_4000Hz, ACC_ODR_2000Hz, ACC_ODR_1000Hz, ACC_ODR_500Hz, ACC_ODR_250Hz,
+    ACC_ODR_125Hz, ACC_ODR_62_5Hz, ACC_ODR_31_25Hz,
+    ACC_ODR_LOWPOWER_128Hz = 12, ACC_ODR_LOWPOWER_21Hz, ACC_ODR_LOWPOWER_11Hz, ACC_ODR_LOWPOWER_3Hz
+  };
+  enum GyroRange {
+    GYR_RANGE_16DPS, GYR_RANGE_32DPS, GYR_RANGE_64DPS, GYR_RANGE_128DPS, GYR_RANGE_256DPS,
+    GYR_RANGE_512DPS, GYR_RANGE_1024DPS
+  };
+  enum GyroODR {
+    GYR_ODR_7174_4Hz, GYR_ODR_3587_2Hz, GYR_ODR_1793_6Hz, GYR_ODR_896_8Hz, GYR_ODR_448_4Hz,
+    GYR_ODR_224_2Hz, GYR_ODR_112_1Hz, GYR_ODR_56_05Hz, GYR_ODR_28_025Hz
+  };
+  enum LpfMode { LPF_MODE_0, LPF_MODE_1, LPF_MODE_2, LPF_MODE_3, LPF_OFF };
+
+  bool begin(TwoWire& wire, uint8_t addr = QMI8658_L_SLAVE_ADDRESS, int sda = -1, int scl = -1);
+  uint8_t getChipID();
+  int configAccelerometer(AccelRange range, AccelODR odr, LpfMode lpf = LPF_MODE_0);
+  int configGyroscope(GyroRange range, GyroODR odr, LpfMode lpf = LPF_MODE_0);
+  bool enableAccelerometer();
+  bool enableGyroscope();
+  bool disableAccelerometer();
+  bool disableGyroscope();
+  bool getDataReady();
+  bool getAccelerometer(float& x, float& y, float& z);
+  bool getGyroscope(float& x, float& y, float& z);
+  uint32_t getTimestamp();
+  float getTemperature_C();
+  void dumpCtrlRegister();
+
+ private:
+  uint8_t reg(uint8_t r);
+  void setReg(uint8_t r, uint8_t v);
+  bool readAxes(uint8_t first, float lsb, float& x, float& y, float& z);
+
+  uint8_t addr_ = 0;
+  float accLsb_ = 8192.0f;   // LSB per g
+  float gyrLsb_ = 512.0f;    // LSB per deg/s
+};
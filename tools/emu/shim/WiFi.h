@@ -0,0 +1,58 @@
+// WiFi.h - Host emulator shim: station-mode scanning over the emulator's RSSI trace
+// A blocking scan takes maxMsPerChan per channel swept (13 for a full sweep) of virtual time; an async
+// scan returns at once and scanComplete() reports WIFI_SCAN_RUNNING until that time has passed.
+
+#pragma once
+
+#include "Arduino.h"
+
+#define WIFI_OFF 0
+#define WIFI_STA 1
+#define WIFI_AP 2
+#define WIFI_AP_STA 3
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+#define WL_IDLE_STATUS 0
+#define WL_DISCONNECTED 6
+
+#ifndef EMU_WIFI_MAX_RESULTS
+#define EMU_WIFI_MAX_RESULTS 32
+#endif
+
+class WiFiClass {
+ public:
+  bool mode(int m) { mode_ = m; return true; }
+  int getMode() const { return mode_; }
+  bool disconnect(bool wifiOff = false, bool eraseAp = false) {
+    (void)wifiOff;
+    (void)eraseAp;
+    return true;
+  }
+  int status() const { return WL_DISCONNECTED; }
+
+  int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false,
+                       uint32_t maxMsPerChan = 300, uint8_t channel = 0, const char* ssid = nullptr,
+                       const uint8_t* bssid = nullptr);
+  int16_t scanComplete();
+  void scanDelete();
+
+  String SSID(uint8_t i) const { return i < count_ ? String(results_[i].ssid) : String(); }
+  int32_t RSSI(uint8_t i) const { return i < count_ ? results_[i].rssi : 0; }
+  uint8_t* BSSID(uint8_t i) { return i < count_ ? results_[i].bssid : nullptr; }
+  String BSSIDstr(uint8_t i) const;
+  int32_t channel(uint8_t i) const { return i < count_ ? results_[i].channel : 0; }
+
+ private:
+  int mode_ = WIFI_OFF;
+  EmuAp results_[EMU_WIFI_MAX_RESULTS];
+  int16_t count_ = 0;
+  bool running_ = false;
+  uint64_t doneNs_ = 0;
+  uint8_t scanChannel_ = 0;
+  char scanSsid_[33] = "";
+  bool scanFiltered_ = false;
+};
+
+extern WiFiClass WiFi;
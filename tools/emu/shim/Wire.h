@@ -0,0 +1,83 @@
+// Wire.h - Host emulator shim: TwoWire over the emulator's I2C devices (a QMI8658 at 0x6B / 0x6A)
+// A write transaction is [reg, data...]; a single-byte write with endTransmission(false) sets the register
+// for the following requestFrom(). Each byte charges 9 bus clocks of virtual time.
+
+#pragma once
+
+#include "Arduino.h"
+
+#ifndef I2C_BUFFER_LENGTH
+#define I2C_BUFFER_LENGTH 128
+#endif
+
+class TwoWire {
+ public:
+  bool begin(int sda = -1, int scl = -1, uint32_t freq = 0) {
+    (void)sda;
+    (void)scl;
+    if (freq) hz_ = freq;
+    return true;
+  }
+  void end() {}
+  void setClock(uint32_t hz) { hz_ = hz ? hz : hz_; }
+  uint32_t getClock() const { return hz_; }
+
+  void beginTransmission(uint8_t addr) {
+    addr_ = addr;
+    txLen_ = 0;
+  }
+  size_t write(uint8_t b) {
+    if (txLen_ >= I2C_BUFFER_LENGTH) return 0;
+    tx_[txLen_++] = b;
+    return 1;
+  }
+  size_t write(const uint8_t* data, size_t len) {
+    size_t n = 0;
+    while (n < len && write(data[n])) ++n;
+    return n;
+  }
+  // 0 = ok, 2 = address NACK (no device)
+  uint8_t endTransmission(bool stop = true) {
+    busTime(txLen_ + 1);
+    if (!EmuI2cProbe(addr_)) return 2;
+    if (txLen_ == 0) return 0;
+    reg_ = tx_[0];
+    if (txLen_ > 1) EmuI2cWrite(addr_, reg_, tx_ + 1, txLen_ - 1);
+    (void)stop;
+    return 0;
+  }
+  size_t requestFrom(uint8_t addr, size_t len, bool stop = true) {
+    (void)stop;
+    rxLen_ = rxPos_ = 0;
+    if (len > I2C_BUFFER_LENGTH) len = I2C_BUFFER_LENGTH;
+    busTime(len + 1);
+    if (!EmuI2cProbe(addr) || !EmuI2cRead(addr, reg_, rx_, len)) return 0;
+    rxLen_ = len;
+    return len;
+  }
+  uint8_t requestFrom(uint8_t addr, uint8_t len) { return (uint8_t)requestFrom(addr, (size_t)len, true); }
+  uint8_t requestFrom(int addr, int len) { return (uint8_t)requestFrom((uint8_t)addr, (size_t)len, true); }
+  int available() const { return (int)(rxLen_ - rxPos_); }
+  int read() { return rxPos_ < rxLen_ ? rx_[rxPos_++] : -1; }
+  int peek() const { return rxPos_ < rxLen_ ? rx_[rxPos_] : -1; }
+  size_t readBytes(uint8_t* out, size_t len) {
+    size_t n = 0;
+    while (n < len && rxPos_ < rxLen_) out[n++] = rx_[rxPos_++];
+    return n;
+  }
+
+ private:
+  void busTime(size_t bytes) { EmuAdvanceNs((uint64_t)bytes * 9 * 1000000000ull / hz_); }
+
+  uint32_t hz_ = EMU_I2C_HZ;
+  uint8_t addr_ = 0;
+  uint8_t reg_ = 0;
+  uint8_t tx_[I2C_BUFFER_LENGTH];
+  size_t txLen_ = 0;
+  uint8_t rx_[I2C_BUFFER_LENGTH];
+  size_t rxLen_ = 0;
+  size_t rxPos_ = 0;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
@@ -5,6 +5,8 @@ Generic LED matrix terminal visualizer for microcontroller projects (e.g., ESP32
 Features
 - Reads frames from serial, stdin, or a file.
 - Accepts CSV hex frames (RRGGBB tokens), with or without a "FRAME:" prefix.
+- Accepts binary frame packets (sync + seq + len + CRC) interleaved with text lines;
+  the firmware announces FMT=bin|csv on its META line.
 - Configurable matrix size, input order, LED wiring (serpentine/progressive), and rotation.
 - Renders ANSI truecolor blocks or ASCII glyphs for portability.
 - Lightweight, single-file tool with minimal dependencies (pyserial optional).
@@ -19,6 +21,9 @@ Examples
 - From stdin (no pyserial needed):
   some_program | python3 tools/led_matrix_viz.py --stdin --width 8 --height 8
 
+- From a sketch running in the host emulator (tools/emu, no board needed):
+  build/emu/Snake/Snake | python3 tools/led_matrix_viz.py --stdin
+
 - From file with recorded frames:
   python3 tools/led_matrix_viz.py --file frames.txt --width 8 --height 8
 
@@ -31,6 +36,29 @@ Firmware CSV hex format
 - Example line:
   FRAME:000000,00FF00,00FF00,000000,000000,FF0000,FF0000,000000,...
 
+Firmware binary format (lib/MatrixUtil/MatrixUtil.h, MU_SendFrameBinary)
+- A5 5A | type u8 | seq u16le | len u16le | payload | crc16 u16le
+- CRC-16/CCITT-FALSE over type..payload; type 0x01 payload = W*H RGB triplets in XY order.
+- type 0x02 (FMT=delta) payload = runs of start u16le | count u8 | count RGB triplets,
+  applied to the last keyframe. On a sequence gap the viewer waits for the next
+  keyframe and, on serial, sends "K" to ask the firmware for one.
+- Text lines (META:, logs) may be interleaved between packets.
+
+Recordings (lib/MatrixUtil/MatrixRecord.h, files mu_rec<N>.bin or MU_RecordDump() output)
+- Same packets; each payload starts with dt_us u32le (time since the previous record).
+- type 0x10 META: "MUR1" | width u16 | height u16 | file seq u32 (first record of every file)
+- type 0x11 keyframe and 0x12 delta: as 0x01 / 0x02 after the dt field
+- type 0x13 input: kind u8 | data (1 = IMU, 6 x float32 accel g / gyro dps; 2 = RSSI, bssid[6] rssi i8 ch u8)
+- python3 tools/led_matrix_viz.py --replay /path/to/littlefs-dump/ [--speed 2]
+  plays every recording found (ordered by file seq) at the recorded timing.
+
+Profiler (lib/MatrixUtil/MatrixProfile.h, PROFILE_SECTIONS 1)
+- PROFILE:ms=<window>,mhz=<cpu>,<name>=calls/avg/min/max,... (cycles), once a second.
+- --profile (or --stats) overlays the busiest sections: avg/max in us and their share of the window.
+
+Startup (lib/MatrixUtil/MatrixBoot.h)
+- BOOT:frame=<ms>,<stage>=ok|fail|late/<ms>,...,ready=<ms>, once per boot (shown with --verbose, like other non-frame lines).
+
 Tip: In Arduino (FastLED)
   for (int y=0; y<H; y++) {
     for (int x=0; x<W; x++) {
@@ -48,8 +76,10 @@ License: MIT-like (keep this file within your project).
 from __future__ import annotations
 
 import argparse
+import binascii
 import os
 import re
+import struct
 import sys
 import time
 from typing import Iterable, List, Optional, Sequence, Tuple
@@ -94,6 +124,96 @@ def parse_csv_hex_line(line: str, expected_pixels: int) -> Optional[List[RGB]]:
     return None
 
 
+PKT_SYNC = b"\xa5\x5a"
+PKT_HEADER = 7
+PKT_TRAILER = 2
+PKT_FULL = 0x01
+PKT_DELTA = 0x02
+PKT_MAX_PAYLOAD = 3 * 128 * 128
+REC_META = 0x10
+REC_KEY = 0x11
+REC_DELTA = 0x12
+REC_INPUT = 0x13
+REC_IN_IMU = 1
+REC_IN_RSSI = 2
+
+
+class StreamDecoder:
+    """Splits a raw byte stream into text lines and CRC-checked binary packets.
+
+    feed() yields ("line", str) or ("packet", (type, seq, payload)) events.
+    Binary scanning can be disabled (binary=False) to treat everything as text.
+    """
+
+    def __init__(self, binary: bool = True) -> None:
+        self.buf = bytearray()
+        self.binary = binary
+        self.crc_errors = 0
+
+    def feed(self, data: bytes) -> Iterable[Tuple[str, object]]:
+        self.buf += data
+        buf = self.buf
+        while buf:
+            nl = buf.find(b"\n")
+            sync = buf.find(PKT_SYNC) if self.binary else -1
+            if sync != -1 and (nl == -1 or sync < nl):
+                if sync > 0:
+                    # Text without a newline right before a packet: flush it as a line
+                    yield ("line", buf[:sync].decode("utf-8", errors="ignore").strip())
+                    del buf[:sync]
+                if len(buf) < PKT_HEADER:
+                    return
+                ptype = buf[2]
+                seq = buf[3] | (buf[4] << 8)
+                length = buf[5] | (buf[6] << 8)
+                if length > PKT_MAX_PAYLOAD:
+                    del buf[:1]  # not a real packet start
+                    continue
+                end = PKT_HEADER + length + PKT_TRAILER
+                if len(buf) < end:
+                    return
+                crc = buf[end - 2] | (buf[end - 1] << 8)
+                if binascii.crc_hqx(bytes(buf[2 : PKT_HEADER + length]), 0xFFFF) != crc:
+                    self.crc_errors += 1
+                    del buf[:1]
+                    continue
+                payload = bytes(buf[PKT_HEADER : PKT_HEADER + length])
+                del buf[:end]
+                yield ("packet", (ptype, seq, payload))
+                continue
+            if nl == -1:
+                if len(buf) > 1 << 16:
+                    del buf[:]  # runaway garbage without newlines
+                return
+            line = buf[:nl].decode("utf-8", errors="ignore").strip()
+            del buf[: nl + 1]
+            yield ("line", line)
+
+
+def pixels_from_rgb_bytes(payload: bytes, expected_pixels: int) -> Optional[List[RGB]]:
+    if len(payload) != expected_pixels * 3:
+        return None
+    return [(payload[i], payload[i + 1], payload[i + 2]) for i in range(0, len(payload), 3)]
+
+
+def apply_delta_runs(frame: List[RGB], payload: bytes) -> bool:
+    """Apply MU_PKT_DELTA runs in place; False if the payload is malformed."""
+    i = 0
+    n = len(payload)
+    while i < n:
+        if i + 3 > n:
+            return False
+        start = payload[i] | (payload[i + 1] << 8)
+        count = payload[i + 2]
+        i += 3
+        if i + count * 3 > n or start + count > len(frame):
+            return False
+        for k in range(count):
+            frame[start + k] = (payload[i], payload[i + 1], payload[i + 2])
+            i += 3
+    return True
+
+
 def idx_xy_to_linear(x: int, y: int, w: int, serpentine: bool) -> int:
     if serpentine and (y % 2 == 1):
         return y * w + (w - 1 - x)
@@ -198,41 +318,93 @@ def auto_detect_port() -> Optional[str]:
     return None
 
 
-def read_lines_from_serial(port: str, baud: int) -> Iterable[str]:
-    if serial is None:
-        raise RuntimeError("pyserial not installed. Run: pip install pyserial")
-    ser = serial.Serial(port, baud, timeout=0.05)
-    time.sleep(0.2)  # settle
-    buf = ""
-    try:
-        while True:
-            n = ser.in_waiting or 0
-            if n:
-                data = ser.read(n)
-                try:
-                    buf += data.decode("utf-8", errors="ignore")
-                except Exception:
-                    continue
-                if "\n" in buf:
-                    parts = buf.split("\n")
-                    buf = parts[-1]
-                    for line in parts[:-1]:
-                        yield line.strip()
-            else:
-                time.sleep(0.01)
-    finally:
-        ser.close()
+class SerialSource:
+    """Serial port reader that can also send small requests back to the firmware."""
 
+    def __init__(self, port: str, baud: int) -> None:
+        if serial is None:
+            raise RuntimeError("pyserial not installed. Run: pip install pyserial")
+        self.ser = serial.Serial(port, baud, timeout=0.05)
+        time.sleep(0.2)  # settle
 
-def read_lines_from_file(path: str) -> Iterable[str]:
-    with open(path, "r", encoding="utf-8", errors="ignore") as f:
-        for line in f:
-            yield line.rstrip("\n")
+    def chunks(self) -> Iterable[bytes]:
+        try:
+            while True:
+                n = self.ser.in_waiting or 0
+                if n:
+                    yield self.ser.read(n)
+                else:
+                    time.sleep(0.002)
+        finally:
+            self.ser.close()
+
+    def send(self, data: bytes) -> None:
+        try:
+            self.ser.write(data)
+        except Exception:
+            pass
+
+
+def read_chunks_from_file(path: str) -> Iterable[bytes]:
+    with open(path, "rb") as f:
+        while True:
+            data = f.read(4096)
+            if not data:
+                return
+            yield data
 
 
-def read_lines_from_stdin() -> Iterable[str]:
-    for line in sys.stdin:
-        yield line.rstrip("\n")
+def recording_seq(path: str) -> Optional[int]:
+    """File sequence from a recording's leading META record, None if it is not one."""
+    with open(path, "rb") as f:
+        head = f.read(PKT_HEADER + 16)
+    if len(head) < PKT_HEADER + 16 or head[:2] != PKT_SYNC or head[2] != REC_META:
+        return None
+    if head[PKT_HEADER + 4 : PKT_HEADER + 8] != b"MUR1":
+        return None
+    return struct.unpack_from("<I", head, PKT_HEADER + 12)[0]
+
+
+def recording_files(paths: Sequence[str]) -> List[str]:
+    """Expand directories to their mu_rec*.bin files; recordings sorted oldest first."""
+    files: List[str] = []
+    for p in paths:
+        if os.path.isdir(p):
+            files += [os.path.join(p, n) for n in sorted(os.listdir(p)) if re.fullmatch(r"mu_rec\d+\.bin", n)]
+        else:
+            files.append(p)
+    keyed = []
+    for i, f in enumerate(files):
+        seq = recording_seq(f)
+        keyed.append((0 if seq is None else 1, seq or 0, i, f))  # plain dumps keep their order, first
+    return [f for *_, f in sorted(keyed)]
+
+
+def read_chunks_from_files(paths: Sequence[str]) -> Iterable[bytes]:
+    for path in paths:
+        yield from read_chunks_from_file(path)
+
+
+def format_input(payload: bytes) -> str:
+    kind = payload[0]
+    data = payload[1:]
+    if kind == REC_IN_IMU and len(data) >= 24:
+        ax, ay, az, gx, gy, gz = struct.unpack_from("<6f", data)
+        return f"imu a=({ax:+.2f},{ay:+.2f},{az:+.2f})g g=({gx:+.1f},{gy:+.1f},{gz:+.1f})dps"
+    if kind == REC_IN_RSSI and len(data) >= 8:
+        bssid = ":".join(f"{b:02X}" for b in data[:6])
+        rssi = struct.unpack_from("<b", data, 6)[0]
+        return f"rssi {bssid} {rssi}dBm ch{data[7]}"
+    return f"input kind={kind} {data.hex()}"
+
+
+def read_chunks_from_stdin() -> Iterable[bytes]:
+    fd = sys.stdin.fileno()
+    while True:
+        data = os.read(fd, 4096)
+        if not data:
+            return
+        yield data
 
 
 def build_arg_parser() -> argparse.ArgumentParser:
@@ -240,6 +412,14 @@ def build_arg_parser() -> argparse.ArgumentParser:
     src = p.add_argument_group("input source")
     src.add_argument("--stdin", action="store_true", help="Read frames from stdin")
     src.add_argument("--file", type=str, default=None, help="Read frames from a file path")
+    src.add_argument(
+        "--replay",
+        nargs="+",
+        default=None,
+        metavar="PATH",
+        help="Play MatrixRecord.h recordings (files or directories of mu_rec*.bin) at the recorded timing",
+    )
+    src.add_argument("--speed", type=float, default=1.0, help="Replay speed factor (with --replay/--file)")
     src.add_argument("-p", "--port", type=str, default=None, help="Serial port (auto-detect by default)")
     src.add_argument("-b", "--baud", type=int, default=115200, help="Serial baud rate")
 
@@ -269,9 +449,9 @@ def build_arg_parser() -> argparse.ArgumentParser:
     fmt = p.add_argument_group("format & render")
     fmt.add_argument(
         "--format",
-        choices=["csv-hex"],
-        default="csv-hex",
-        help="Frame format (CSV RRGGBB tokens per frame)",
+        choices=["auto", "csv-hex", "bin"],
+        default="auto",
+        help="Frame format: auto (binary packets and CSV lines, FMT= from META), csv-hex (text only), bin",
     )
     fmt.add_argument("--ascii", action="store_true", help="Use ASCII instead of ANSI colors")
     fmt.add_argument("--no-grid", action="store_true", help="Hide grid axes")
@@ -282,7 +462,23 @@ def build_arg_parser() -> argparse.ArgumentParser:
     misc = p.add_argument_group("misc")
     misc.add_argument("--demo", action="store_true", help="Run a small demo pattern (no input)")
     misc.add_argument("--fps", type=float, default=None, help="Limit render rate (frames per second)")
-    misc.add_argument("--stats", action="store_true", help="Display FPS stats header")
+    misc.add_argument("--stats", action="store_true", help="Display FPS stats header (plus the last STATS: line)")
+    misc.add_argument(
+        "--profile",
+        nargs="?",
+        type=int,
+        const=6,
+        default=None,
+        metavar="N",
+        help="Overlay the N busiest sections of the last PROFILE: line (default 6; --stats shows them too)",
+    )
+    misc.add_argument(
+        "--poll-stats",
+        type=float,
+        default=None,
+        metavar="SEC",
+        help="Send 'S' every SEC seconds so a MatrixSched sketch prints STATS: (serial only)",
+    )
     misc.add_argument("--verbose", action="store_true", help="Print non-frame lines / debug info to stderr")
     misc.add_argument("--list-ports", action="store_true", help="List available serial ports and exit")
     return p
@@ -333,7 +529,7 @@ def apply_flips(rgb: List[RGB], w: int, h: int, flip_x: bool, flip_y: bool) -> L
 
 
 def parse_meta(line: str) -> dict:
-    # Expected: META:W=8,H=8,ORDER=xy|led,WIRING=serpentine|progressive,ROT=0,FLIPX=0,FLIPY=0,COLOR=RGB
+    # Expected: META:W=8,H=8,ORDER=xy|led,WIRING=serpentine|progressive,ROT=0,FLIPX=0,FLIPY=0,COLOR=RGB,FMT=csv|bin
     meta = {}
     if not line.startswith("META:"):
         return meta
@@ -345,6 +541,75 @@ def parse_meta(line: str) -> dict:
     return meta
 
 
+def parse_stats(line: str) -> dict:
+    # Expected: STATS:ms=1000,upd=n/avg/p50/p99/max,upd_h=b0.b1...,ren=...,pre=...,late=...,miss_upd=0,miss_ren=0
+    stats = {}
+    if not line.startswith("STATS:"):
+        return stats
+    for part in line.split(":", 1)[1].split(","):
+        if "=" not in part:
+            continue
+        k, v = part.split("=", 1)
+        k, v = k.strip(), v.strip()
+        try:
+            if k.endswith("_h"):
+                stats[k] = [int(x) for x in v.split(".") if x]
+            elif "/" in v:
+                stats[k] = [int(x) for x in v.split("/")]
+            else:
+                stats[k] = int(v)
+        except ValueError:
+            continue
+    return stats
+
+
+def format_stats(stats: dict) -> str:
+    parts = []
+    for name in ("upd", "ren", "pre", "late"):
+        v = stats.get(name)
+        if isinstance(v, list) and len(v) == 5 and v[0]:
+            parts.append(f"{name} {v[1]}/{v[3]}/{v[4]}us")
+    parts.append(f"miss upd={stats.get('miss_upd', 0)} ren={stats.get('miss_ren', 0)}")
+    return "frame-time avg/p99/max: " + "  ".join(parts)
+
+
+def parse_profile(line: str) -> dict:
+    # Expected: PROFILE:ms=1000,mhz=240,name=calls/avg/min/max,... (cycles)
+    prof = {"ms": 0, "mhz": 0, "sections": {}}
+    if not line.startswith("PROFILE:"):
+        return prof
+    for part in line.split(":", 1)[1].split(","):
+        if "=" not in part:
+            continue
+        k, v = part.split("=", 1)
+        k, v = k.strip(), v.strip()
+        try:
+            if "/" in v:
+                vals = [int(x) for x in v.split("/")]
+                if len(vals) == 4:
+                    prof["sections"][k] = vals
+            elif k in ("ms", "mhz"):
+                prof[k] = int(v)
+        except ValueError:
+            continue
+    return prof
+
+
+def format_profile(prof: dict, top: int = 6) -> str:
+    mhz = prof.get("mhz") or 1
+    window_us = prof.get("ms", 0) * 1000
+    rows = []
+    for name, (calls, avg, _mn, mx) in prof.get("sections", {}).items():
+        if calls:
+            rows.append((calls * avg / mhz, name, calls, avg / mhz, mx / mhz))
+    rows.sort(reverse=True)
+    lines = [f"profile {prof.get('ms', 0)}ms @{prof.get('mhz', 0)}MHz  name calls avg/max us  %window"]
+    for total_us, name, calls, avg_us, max_us in rows[:top]:
+        pct = 100.0 * total_us / window_us if window_us else 0.0
+        lines.append(f"  {name:<10} {calls:>6} {avg_us:9.1f}/{max_us:<9.1f} {pct:5.1f}%")
+    return "\n".join(lines)
+
+
 def run_demo(args: argparse.Namespace) -> None:
     w, h = args.width, args.height
     t0 = time.time()
@@ -409,15 +674,24 @@ def main() -> int:
         return 0
 
     # Determine input source
-    line_iter: Iterable[str]
-    if args.stdin:
+    chunk_iter: Iterable[bytes]
+    serial_src: Optional[SerialSource] = None
+    paced = False
+    if args.replay:
+        files = recording_files(args.replay)
+        if not files:
+            print("Error: no recordings found.")
+            return 2
+        source_desc = f"replay:{len(files)} file(s)"
+        chunk_iter = read_chunks_from_files(files)
+        paced = True
+    elif args.stdin:
         source_desc = "stdin"
-        line_iter = read_lines_from_stdin()
-        print(f"LEDViz: reading {source_desc} … waiting for FRAME lines", file=sys.stderr)
+        chunk_iter = read_chunks_from_stdin()
     elif args.file:
         source_desc = f"file:{args.file}"
-        line_iter = read_lines_from_file(args.file)
-        print(f"LEDViz: reading {source_desc} … waiting for FRAME lines", file=sys.stderr)
+        chunk_iter = read_chunks_from_file(args.file)
+        paced = True
     else:
         port = args.port or os.environ.get("LEDVIZ_PORT") or auto_detect_port() or ""
         if not port:
@@ -425,100 +699,235 @@ def main() -> int:
             return 2
         source_desc = f"serial:{port}@{args.baud}"
         try:
-            line_iter = read_lines_from_serial(port, args.baud)
+            serial_src = SerialSource(port, args.baud)
+            chunk_iter = serial_src.chunks()
         except Exception as e:
             print(f"Error opening serial: {e}")
             return 2
-        print(f"LEDViz: reading {source_desc} … waiting for FRAME lines", file=sys.stderr)
+    print(f"LEDViz: reading {source_desc} … waiting for frames", file=sys.stderr)
+
+    decoder = StreamDecoder(binary=args.format != "csv-hex")
+    stream_fmt = "bin" if args.format == "bin" else "csv"
 
     # Render loop
     t_last = time.time()
     frames = 0
     fps = 0.0
     fps_limit = args.fps
-
-    try:
-        for line in line_iter:
-            if not line:
-                continue
-            # Handle runtime meta to auto-configure
-            if line.startswith("META:"):
-                m = parse_meta(line)
-                if m:
-                    ow, oh = w, h
-                    try:
-                        w = int(m.get("W", w))
-                        h = int(m.get("H", h))
-                    except Exception:
-                        pass
+    last_seq: Optional[int] = None
+    dropped = 0
+    frame_xy: Optional[List[RGB]] = None  # last keyframe + applied deltas (input order)
+    bytes_in = 0
+    rate_t0 = time.time()
+    kbps = 0.0
+    stats_line: Optional[str] = None
+    poll_t0 = time.time()
+    rec_us = 0  # recording timeline, advanced by each record's dt
+    rec_t0: Optional[float] = None
+    input_line: Optional[str] = None
+    profile_line: Optional[str] = None
+    profile_top = args.profile if args.profile is not None else 6
+
+    def request_keyframe() -> None:
+        if serial_src is not None:
+            serial_src.send(b"K")
+
+    def show(pixels_xy: List[RGB]) -> None:
+        nonlocal frames, fps, t_last
+        # Rotate if requested
+        pixels_xy, rw, rh = rotate_grid(pixels_xy, w, h, rotate)
+        pixels_xy = apply_flips(pixels_xy, rw, rh, flip_x, flip_y)
+
+        # FPS calc
+        frames += 1
+        now = time.time()
+        dt = now - t_last
+        if dt >= 0.5:
+            fps = frames / dt
+            frames = 0
+            t_last = now
+
+        # FPS limit (render throttling only)
+        if fps_limit is not None:
+            # naive throttle
+            time.sleep(max(0.0, (1.0 / max(fps_limit, 1e-6)) - 0.0005))
+
+        header = None
+        if args.stats or args.profile is not None:
+            header = f"LEDViz {rw}x{rh}  src={source_desc}  fmt={stream_fmt}  fps={fps:.1f}"
+            if stream_fmt in ("bin", "delta"):
+                header += f"  drop={dropped}  crc_err={decoder.crc_errors}"
+            header += f"  {kbps:.1f}kB/s"
+            if stats_line:
+                header += "\n" + stats_line
+            if input_line:
+                header += "\n" + input_line
+            if profile_line:
+                header += "\n" + profile_line
+
+        clear_screen()
+        out = render_frame(
+            pixels_xy,
+            rw,
+            rh,
+            colored=not args.ascii,
+            show_grid=not args.no_grid,
+            double_wide=not args.no_double_wide,
+            header=header,
+        )
+        print(out)
+
+    def handle_line(line: str) -> None:
+        nonlocal w, h, expected, input_order, wiring, rotate, flip_x, flip_y, stream_fmt, frame_xy, stats_line
+        nonlocal profile_line
+        if line.startswith("PROFILE:"):
+            profile_line = format_profile(parse_profile(line), profile_top)
+            if args.verbose:
+                print(f"LEDViz: {line}", file=sys.stderr)
+            return
+        if line.startswith("STATS:"):
+            stats_line = format_stats(parse_stats(line))
+            if args.verbose:
+                print(f"LEDViz: {line}", file=sys.stderr)
+            return
+        # Handle runtime meta to auto-configure
+        if line.startswith("META:"):
+            m = parse_meta(line)
+            if m:
+                try:
+                    w = int(m.get("W", w))
+                    h = int(m.get("H", h))
+                except Exception:
+                    pass
+                expected = w * h
+                frame_xy = None
+                if m.get("ORDER") in ("xy", "led"):
+                    input_order = m["ORDER"]
+                if m.get("WIRING") in ("serpentine", "progressive"):
+                    wiring = m["WIRING"]
+                try:
+                    rotate = int(m.get("ROT", rotate))
+                except Exception:
+                    pass
+                flip_x = m.get("FLIPX", str(int(flip_x))) in ("1", "true", "True")
+                flip_y = m.get("FLIPY", str(int(flip_y))) in ("1", "true", "True")
+                if args.format == "auto" and m.get("FMT") in ("csv", "bin", "delta"):
+                    stream_fmt = m["FMT"]
+                print(
+                    f"LEDViz: META updated config -> {w}x{h}, order={input_order}, wiring={wiring}, rot={rotate}, flipx={flip_x}, flipy={flip_y}, fmt={stream_fmt}",
+                    file=sys.stderr,
+                )
+            return
+
+        if args.format == "bin":
+            if args.verbose:
+                print(f"LEDViz: non-frame line: {line}", file=sys.stderr)
+            return
+
+        tokens = parse_csv_hex_line(line, expected)
+        if tokens is None:
+            if args.verbose:
+                if line.startswith("FRAME:"):
+                    # Count valid tokens to hint what's wrong
+                    tokens_tmp = [t for t in (tok.strip() for tok in line.split(",")) if re.fullmatch(r"[0-9A-Fa-f]{6}", t or "")]
+                    print(
+                        f"LEDViz: ignored frame (expected {expected} tokens, got {len(tokens_tmp)})",
+                        file=sys.stderr,
+                    )
+                else:
+                    print(f"LEDViz: non-frame line: {line}", file=sys.stderr)
+            return
+        show(map_input_to_xy(tokens, w, h, input_order, wiring))
+
+    def handle_record(ptype: int, gap: bool, payload: bytes) -> None:
+        nonlocal rec_us, rec_t0, w, h, expected, frame_xy, input_line
+        if len(payload) < 4:
+            return
+        dt = struct.unpack_from("<I", payload)[0]
+        body = payload[4:]
+        if rec_t0 is None:
+            rec_t0 = time.time()  # first record: its dt points before the recording
+        else:
+            rec_us += dt
+        if paced:
+            delay = rec_t0 + rec_us / 1e6 / max(args.speed, 1e-6) - time.time()
+            if delay > 0:
+                time.sleep(delay)
+        if ptype == REC_META:
+            if len(body) >= 12 and body[:4] == b"MUR1":
+                rw, rh = struct.unpack_from("<HH", body, 4)
+                if (rw, rh) != (w, h):
+                    w, h = rw, rh
                     expected = w * h
-                    if m.get("ORDER") in ("xy", "led"):
-                        input_order = m["ORDER"]
-                    if m.get("WIRING") in ("serpentine", "progressive"):
-                        wiring = m["WIRING"]
-                    try:
-                        rotate = int(m.get("ROT", rotate))
-                    except Exception:
-                        pass
-                    flip_x = m.get("FLIPX", str(int(flip_x))) in ("1", "true", "True")
-                    flip_y = m.get("FLIPY", str(int(flip_y))) in ("1", "true", "True")
+                    frame_xy = None
+            return
+        if ptype == REC_INPUT:
+            if body:
+                input_line = format_input(body)
+                if args.verbose:
+                    print(f"LEDViz: {input_line}", file=sys.stderr)
+            return
+        handle_frame(PKT_FULL if ptype == REC_KEY else PKT_DELTA, gap, body)
+
+    def handle_packet(ptype: int, seq: int, payload: bytes) -> None:
+        nonlocal last_seq, dropped, stream_fmt
+        if stream_fmt == "csv":
+            stream_fmt = "bin"
+        gap = last_seq is not None and ((seq - last_seq) & 0xFFFF) != 1
+        if gap and ptype != REC_META:  # a recording file or session may follow any seq
+            dropped += ((seq - last_seq - 1) & 0xFFFF)  # type: ignore[operator]
+        last_seq = seq
+        if REC_META <= ptype <= REC_INPUT:
+            handle_record(ptype, gap, payload)
+        else:
+            handle_frame(ptype, gap, payload)
+
+    def handle_frame(ptype: int, gap: bool, payload: bytes) -> None:
+        nonlocal frame_xy
+        if ptype == PKT_FULL:
+            pixels = pixels_from_rgb_bytes(payload, expected)
+            if pixels is None:
+                if args.verbose:
                     print(
-                        f"LEDViz: META updated config -> {w}x{h}, order={input_order}, wiring={wiring}, rot={rotate}, flipx={flip_x}, flipy={flip_y}",
+                        f"LEDViz: ignored packet (expected {expected * 3} bytes, got {len(payload)})",
                         file=sys.stderr,
                     )
-                continue
-
-            if args.format == "csv-hex":
-                tokens = parse_csv_hex_line(line, expected)
-                if tokens is None:
-                    if args.verbose:
-                        if line.startswith("FRAME:"):
-                            # Count valid tokens to hint what's wrong
-                            tokens_tmp = [t for t in (tok.strip() for tok in line.split(",")) if re.fullmatch(r"[0-9A-Fa-f]{6}", t or "")]
-                            print(
-                                f"LEDViz: ignored frame (expected {expected} tokens, got {len(tokens_tmp)})",
-                                file=sys.stderr,
-                            )
-                        else:
-                            print(f"LEDViz: non-frame line: {line}", file=sys.stderr)
-                    continue
-                pixels_xy = map_input_to_xy(tokens, w, h, input_order, wiring)
-            else:
-                continue
-
-            # Rotate if requested
-            pixels_xy, rw, rh = rotate_grid(pixels_xy, w, h, rotate)
-            pixels_xy = apply_flips(pixels_xy, rw, rh, flip_x, flip_y)
+                return
+            frame_xy = pixels
+        elif ptype == PKT_DELTA:
+            if gap or frame_xy is None or len(frame_xy) != expected:
+                # Lost a packet or no base frame yet: wait for a keyframe
+                frame_xy = None
+                request_keyframe()
+                return
+            if not apply_delta_runs(frame_xy, payload):
+                if args.verbose:
+                    print("LEDViz: malformed delta packet", file=sys.stderr)
+                frame_xy = None
+                request_keyframe()
+                return
+        else:
+            if args.verbose:
+                print(f"LEDViz: unknown packet type 0x{ptype:02X}", file=sys.stderr)
+            return
+        show(map_input_to_xy(list(frame_xy), w, h, input_order, wiring))
 
-            # FPS calc
-            frames += 1
+    try:
+        for chunk in chunk_iter:
+            bytes_in += len(chunk)
             now = time.time()
-            dt = now - t_last
-            if dt >= 0.5:
-                fps = frames / dt
-                frames = 0
-                t_last = now
-
-            # FPS limit (render throttling only)
-            if fps_limit is not None:
-                # naive throttle
-                time.sleep(max(0.0, (1.0 / max(fps_limit, 1e-6)) - 0.0005))
-
-            header = None
-            if args.stats:
-                header = f"LEDViz {rw}x{rh}  src={source_desc}  fps={fps:.1f}"
-
-            clear_screen()
-            out = render_frame(
-                pixels_xy,
-                rw,
-                rh,
-                colored=not args.ascii,
-                show_grid=not args.no_grid,
-                double_wide=not args.no_double_wide,
-                header=header,
-            )
-            print(out)
+            if now - rate_t0 >= 1.0:
+                kbps = bytes_in / 1024.0 / (now - rate_t0)
+                bytes_in = 0
+                rate_t0 = now
+            if args.poll_stats and serial_src is not None and now - poll_t0 >= args.poll_stats:
+                serial_src.send(b"S")
+                poll_t0 = now
+            for kind, item in decoder.feed(chunk):
+                if kind == "packet":
+                    handle_packet(*item)  # type: ignore[misc]
+                elif item:
+                    handle_line(item)  # type: ignore[arg-type]
     except KeyboardInterrupt:
         pass
     return 0